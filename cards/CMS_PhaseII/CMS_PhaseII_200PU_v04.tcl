@@ -59,25 +59,20 @@ set ExecutionPath {
   GenParticleFilter
   PhotonFilter
   PhotonCloner
+  ElectronCloner
+  MuonCloner
+
+  IsolationPuppi
+  IsolationCHS
 
-  PhotonIsolation
-  PhotonIsolationCHS
   PhotonEfficiencyCHS
 
   PhotonLooseID
   PhotonTightID
-  
-  ElectronCloner
-  ElectronIsolation
-  ElectronIsolationCHS
 
   ElectronEfficiency
   ElectronEfficiencyCHS
 
-  MuonCloner
-  MuonIsolation
-  MuonIsolationCHS
-
   MuonLooseIdEfficiency
   MuonTightIdEfficiency
 
@@ -833,6 +828,9 @@ module RunPUPPI RunPUPPIBase {
   set UseExp            false
   set UseNoLep          false
 
+  ## number of threads computing the particle metrics (0 = main thread only)
+  # set NumberOfThreads   4
+
   ## define puppi algorithm parameters (more than one for the same eta region is possible)
   add EtaMinBin           0.0   1.5   4.0
   add EtaMaxBin           1.5   4.0   10.0
@@ -1218,27 +1216,27 @@ module Cloner PhotonCloner {
 }
 
 
-####################
-# Photon isolation #
-####################
+#############
+# Isolation #
+#############
 
-module Isolation PhotonIsolation {
+# photons, electrons and muons are isolated in a single pass
+# over each isolation collection
 
-  # particle for which calculate the isolation
-  set CandidateInputArray PhotonFilter/photons
+module MultiIsolation IsolationPuppi {
 
   # isolation collection
   set IsolationInputArray EFlowFilterPuppi/eflow
 
-  # output array
-  set OutputArray photons
-
-  # veto isolation cand. based on proximity to input cand.
-  set DeltaRMin 0.01
-  set UseMiniCone true
+  # input array, output array, isolation cone, veto cone
+  # (mini cone if positive, otherwise only the candidate itself is vetoed)
+  add Candidates PhotonFilter/photons photons 0.3 0.01
+  add Candidates ElectronFilter/electrons electrons 0.3 0.0
+  add Candidates MuonMomentumSmearing/muons muons 0.3 0.0
 
-  # isolation cone
-  set DeltaRMax 0.3
+  # optional selection of a group, overriding the values below:
+  # output array, PTMin, PTRatioMax, PTSumMax, UsePTSum, UseRhoCorrection
+  # add Selection muons 0.0 0.25 5.0 false false
 
   # minimum pT
   set PTMin     0.0
@@ -1249,24 +1247,20 @@ module Isolation PhotonIsolation {
 }
 
 
-########################
-# Photon isolation CHS #
-########################
-
-module Isolation PhotonIsolationCHS {
+#################
+# Isolation CHS #
+#################
 
-  # particle for which calculate the isolation
-  set CandidateInputArray PhotonCloner/photons
+module MultiIsolation IsolationCHS {
 
   # isolation collection
   set IsolationInputArray EFlowFilterCHS/eflow
   set RhoInputArray Rho/rho
 
-  # output array
-  set OutputArray photons
-
-  # isolation cone
-  set DeltaRMax 0.3
+  # input array, output array, isolation cone, veto cone
+  add Candidates PhotonCloner/photons photons 0.3 0.0
+  add Candidates ElectronCloner/electrons electrons 0.3 0.01
+  add Candidates MuonCloner/muons muons 0.3 0.01
 
   # minimum pT
   set PTMin     0.0
@@ -1285,7 +1279,7 @@ module Isolation PhotonIsolationCHS {
 module Efficiency PhotonEfficiencyCHS {
 
   ## input particles
-  set InputArray PhotonIsolationCHS/photons
+  set InputArray IsolationCHS/photons
   ## output particles
   set OutputArray photons
   # set EfficiencyFormula {efficiency formula as a function of eta and pt}
@@ -1305,7 +1299,7 @@ module Efficiency PhotonEfficiencyCHS {
 module PhotonID PhotonLooseID {
 
   ## input particles
-  set InputPhotonArray PhotonIsolation/photons
+  set InputPhotonArray IsolationPuppi/photons
 
   ## gen particles
   set InputGenArray GenParticleFilter/filteredParticles
@@ -1676,7 +1670,7 @@ module PhotonID PhotonLooseID {
 module PhotonID PhotonTightID {
 
   ## input particles
-  set InputPhotonArray PhotonIsolation/photons
+  set InputPhotonArray IsolationPuppi/photons
 
   ## gen particles
   set InputGenArray GenParticleFilter/filteredParticles
@@ -2038,58 +2032,13 @@ module PhotonID PhotonTightID {
 
 
 
-######################
-# Electron isolation #
-######################
-
-module Isolation ElectronIsolation {
-
-  set CandidateInputArray ElectronFilter/electrons
-
-  # isolation collection
-  set IsolationInputArray EFlowFilterPuppi/eflow
-
-  set OutputArray electrons
-
-  set DeltaRMax 0.3
-  set PTMin 0.0
-  set PTRatioMax 9999.
-
-}
-
-
-##########################
-# Electron isolation CHS #
-##########################
-
-module Isolation ElectronIsolationCHS {
-
-  set CandidateInputArray ElectronCloner/electrons
-
-  # isolation collection
-  set IsolationInputArray EFlowFilterCHS/eflow
-  set RhoInputArray Rho/rho
-
-  set OutputArray electrons
-
-  # veto isolation cand. based on proximity to input cand.
-  set DeltaRMin 0.01
-  set UseMiniCone true
-
-  set DeltaRMax 0.3
-  set PTMin 0.0
-  set PTRatioMax 9999.
-
-}
-
-
 #######################
 # Electron efficiency #
 #######################
 
 module Efficiency ElectronEfficiency {
 
-  set InputArray ElectronIsolation/electrons
+  set InputArray IsolationPuppi/electrons
   set OutputArray electrons
 
   # set EfficiencyFormula {efficiency formula as a function of eta and pt}
@@ -2156,7 +2105,7 @@ module Efficiency ElectronEfficiency {
 
 module Efficiency ElectronEfficiencyCHS {
 
-  set InputArray ElectronIsolationCHS/electrons
+  set InputArray IsolationCHS/electrons
   set OutputArray electrons
 
   # set EfficiencyFormula {efficiency formula as a function of eta and pt}
@@ -2197,55 +2146,12 @@ module Efficiency ElectronEfficiencyCHS {
 
 
 
-##################
-# Muon isolation #
-##################
-
-module Isolation MuonIsolation {
-  set CandidateInputArray MuonMomentumSmearing/muons
-
-  # isolation collection
-  set IsolationInputArray EFlowFilterPuppi/eflow
-
-  set OutputArray muons
-
-  set DeltaRMax 0.3
-  set PTMin 0.0
-  set PTRatioMax 9999.
-
-}
-
-######################
-# Muon isolation CHS #
-######################
-
-module Isolation MuonIsolationCHS {
-  set CandidateInputArray MuonCloner/muons
-
-  # isolation collection
-  set IsolationInputArray EFlowFilterCHS/eflow
-  set RhoInputArray Rho/rho
-
-  set OutputArray muons
-
-
-  # veto isolation cand. based on proximity to input cand.
-  set DeltaRMin 0.01
-  set UseMiniCone true
-
-  set DeltaRMax 0.3
-  set PTMin 0.0
-  set PTRatioMax 9999.
-
-}
-
-
 #####################
 # Muon Loose Id     #
 #####################
 
 module Efficiency MuonLooseIdEfficiency {
-    set InputArray MuonIsolation/muons
+    set InputArray IsolationPuppi/muons
     set OutputArray muons
     # tracking + LooseID efficiency formula for muons
     source muonLooseId.tcl
@@ -2258,7 +2164,7 @@ module Efficiency MuonLooseIdEfficiency {
 ##################
 
 module Efficiency MuonTightIdEfficiency {
-    set InputArray MuonIsolation/muons
+    set InputArray IsolationPuppi/muons
     set OutputArray muons
     # tracking + TightID efficiency formula for muons
     #source muonTightId.tcl
@@ -2314,7 +2220,7 @@ module Efficiency MuonTightIdEfficiency {
 #####################
 
 module Efficiency MuonLooseIdEfficiencyCHS {
-    set InputArray MuonIsolationCHS/muons
+    set InputArray IsolationCHS/muons
     set OutputArray muons
     # tracking + LooseID efficiency formula for muons
     source muonLooseId.tcl
@@ -2327,7 +2233,7 @@ module Efficiency MuonLooseIdEfficiencyCHS {
 ######################
 
 module Efficiency MuonTightIdEfficiencyCHS {
-    set InputArray MuonIsolationCHS/muons
+    set InputArray IsolationCHS/muons
     set OutputArray muons
     # tracking + TightID efficiency formula for muons
     #source muonTightId.tcl
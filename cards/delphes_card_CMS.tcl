@@ -150,6 +150,12 @@ module MomentumSmearing ChargedHadronMomentumSmearing {
 
   # set ResolutionFormula {resolution formula as a function of eta and pt}
 
+  # optionally replace the formula by a lookup table {nPt ptMin ptMax nEta etaMin etaMax},
+  # the formula is still evaluated outside the table and in the cells containing
+  # one of its thresholds, the table can be cached in a file
+  # set ResolutionMap {1000 0.0 1000.0 100 -2.5 2.5}
+  # set ResolutionMapCache ChargedHadronMomentumSmearing.map
+
   # resolution formula for charged hadrons
   # based on arXiv:1405.6569
   set ResolutionFormula {                  (abs(eta) <= 0.5) * (pt > 0.1) * sqrt(0.06^2 + pt^2*1.3e-3^2) +
@@ -723,6 +729,12 @@ module BTagging BTagging {
   # PDG code = the highest PDG code of a quark or gluon inside DeltaR cone around jet axis
   # gluon's PDG code has the lowest priority
 
+  # set UseWeights true to store the efficiencies in Jet.BTagWeights instead of
+  # drawing random numbers, with the global set WeightVariations {Up} the
+  # efficiencies of EfficiencyFormulaUp are stored as well; the weights of
+  # bit i start at index i * (1 + number of variations), BTagAlgo and
+  # BTagPhys are still drawn from random numbers
+
   # based on arXiv:1211.4462
   
   # default efficiency formula (misidentification rate)
@@ -771,6 +783,20 @@ module UniqueObjectFinder UniqueObjectFinder {
   add InputArray JetEnergyScale/jets jets
 }
 
+####################
+# Event preselection
+####################
+
+# add EventPreselection to the ExecutionPath to stop processing
+# and writing events that fail the selection; cheap selections
+# should be placed as early as possible in the ExecutionPath
+
+module EventFilter EventPreselection {
+# add Selection InputArray MinimumMultiplicity MaximumMultiplicity SelectionFormula
+# a negative maximum multiplicity means no upper limit
+  add Selection UniqueObjectFinder/jets 2 -1 {pt > 30.0}
+}
+
 ##################
 # ROOT tree writer
 ##################
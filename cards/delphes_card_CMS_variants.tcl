@@ -0,0 +1,37 @@
+source delphes_card_CMS.tcl
+
+#######################################
+# Systematic variations of the CMS card
+#######################################
+
+# variant <name> <fork module> { ... }
+# modules of ExecutionPath up to the fork module are run once per event,
+# each variant runs its own copy of the remaining modules.
+# Parameters set inside a module of the variant replace the main ones,
+# other parameters are taken from the main card.
+# The variant tree is written to the main output file with the name of
+# the variant, or to its own OutputFile with the name TreeName.
+
+#######################
+# tighter b-tagging
+#######################
+
+variant BTagTight JetEnergyScale {
+  module BTagging BTagging {
+    add EfficiencyFormula {0} {0.005+0.000019*pt}
+    add EfficiencyFormula {4} {0.15*tanh(0.018*pt)*(1/(1+ 0.0013*pt))}
+    add EfficiencyFormula {5} {0.70*tanh(0.0025*pt)*(25.0/(1+0.063*pt))}
+  }
+}
+
+#######################
+# jet energy scale up
+#######################
+
+variant JetScaleUp FatJetFinder {
+  set OutputFile delphes_JetScaleUp.root
+
+  module EnergyScale JetEnergyScale {
+    set ScaleFormula {1.05*sqrt( (2.5 - 0.15*(abs(eta)))^2 / pt + 1.0 )}
+  }
+}
@@ -95,6 +95,9 @@ module TruthVertexFinder TruthVertexFinder {
   ## below this distance two vertices are assumed to be merged
   set Resolution 1E-06
 
+  ## compare the binned vertex lookup with a loop over all vertices (slow)
+  # set CheckLookup true
+
   set InputArray Delphes/stableParticles
   set VertexOutputArray vertices
 }
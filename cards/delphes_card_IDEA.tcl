@@ -202,6 +202,10 @@ module TrackCovariance TrackSmearing {
     ## magnetic field
     set Bz $B
 
+    ## optional file caching the covariance grid and acceptance between jobs,
+    ## recomputed when the field or geometry change
+    # set CacheFile TrackCovariance_IDEA.cache
+
     ## scale factors
     set ElectronScaleFactor  {1.25}
 
@@ -373,6 +377,38 @@ module TrackCovariance TrackSmearing {
 
 }
 
+#################
+# Vertex fitting
+#################
+
+# not in the default ExecutionPath, add VertexFitter after TrackSmearing
+# and uncomment its branches in the TreeWriter to use it
+
+module VertexFitter VertexFitter {
+  set InputArray TrackSmearing/tracks
+
+  set VertexOutputArray vertices
+  set SecondaryVertexOutputArray secondaryVertices
+
+  set MinPT 0.1
+
+  ## tracks compatible with the beam line are used for the primary vertex
+  set PrimaryMaxD0Significance 3.0
+  set PrimaryMaxTrackChi2 9.0
+  set PrimaryMinTracks 2
+
+  ## beam spot size in mm
+  set BeamSpotConstraint false
+  set BeamSpotSigmaX 0.0045
+  set BeamSpotSigmaY 0.00002
+  set BeamSpotSigmaZ 0.3
+
+  ## opposite charge pairs of displaced tracks
+  set SecondaryMinD0Significance 3.0
+  set SecondaryMaxChi2 10.0
+  set SecondaryMinDistanceSignificance 3.0
+}
+
 ###################
 # Cluster Counting
 ###################
@@ -984,6 +1020,8 @@ module TreeWriter TreeWriter {
 
     add Branch EFlowTrackMerger/eflowTracks EFlowTrack Track
     add Branch TrackSmearing/tracks Track Track
+    # add Branch VertexFitter/vertices Vertex Vertex
+    # add Branch VertexFitter/secondaryVertices SecondaryVertex Vertex
     add Branch Calorimeter/eflowPhotons EFlowPhoton Tower
     add Branch TimeOfFlightNeutralHadron/eflowNeutralHadrons EFlowNeutralHadron Tower
 
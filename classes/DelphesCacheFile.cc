@@ -0,0 +1,181 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class DelphesCacheFile
+ *
+ *  Binary file holding an array of doubles computed at initialization,
+ *  tagged with a key describing how it was computed.
+ *
+ *  Files are mapped read-only into memory, so that concurrent processes
+ *  using the data in place share its pages; data copied out of the
+ *  mapping is private to each process.  Files are written under
+ *  a temporary name and renamed, so that readers never see a partial file.
+ *
+ */
+
+#include "classes/DelphesCacheFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+// file layout: magic, key size, key padded to 8 bytes, number of values, values
+static const char kCacheMagic[8] = {'D', 'C', 'A', 'C', 'H', 'E', '0', '1'};
+
+static uint64_t PaddedKeySize(uint64_t keySize)
+{
+  return (keySize + 7) & ~uint64_t(7);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesCacheFile::DelphesCacheFile() :
+  fAddress(0), fLength(0), fData(0), fSize(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+DelphesCacheFile::~DelphesCacheFile()
+{
+  Close();
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesCacheFile::Open(const char *fileName, const char *key)
+{
+  int fd;
+  struct stat status;
+  const char *begin;
+  uint64_t keySize, offset, size;
+
+  Close();
+
+  fd = open(fileName, O_RDONLY);
+  if(fd < 0) return kFALSE;
+
+  if(fstat(fd, &status) != 0 || status.st_size < Long64_t(sizeof(kCacheMagic) + 2 * sizeof(uint64_t)))
+  {
+    close(fd);
+    return kFALSE;
+  }
+
+  fLength = status.st_size;
+  fAddress = mmap(0, fLength, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if(fAddress == MAP_FAILED)
+  {
+    fAddress = 0;
+    fLength = 0;
+    return kFALSE;
+  }
+
+  begin = static_cast<const char *>(fAddress);
+  keySize = strlen(key);
+
+  // check the header before trusting any size read from the file
+  offset = sizeof(kCacheMagic);
+  if(memcmp(begin, kCacheMagic, sizeof(kCacheMagic)) != 0
+    || memcmp(begin + offset, &keySize, sizeof(keySize)) != 0
+    || offset + sizeof(keySize) + PaddedKeySize(keySize) + sizeof(size) > uint64_t(fLength))
+  {
+    Close();
+    return kFALSE;
+  }
+
+  offset += sizeof(keySize);
+  if(memcmp(begin + offset, key, keySize) != 0)
+  {
+    Close();
+    return kFALSE;
+  }
+
+  offset += PaddedKeySize(keySize);
+  memcpy(&size, begin + offset, sizeof(size));
+  offset += sizeof(size);
+
+  if(offset + size * sizeof(Double_t) != uint64_t(fLength))
+  {
+    Close();
+    return kFALSE;
+  }
+
+  fData = reinterpret_cast<const Double_t *>(begin + offset);
+  fSize = size;
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCacheFile::Close()
+{
+  if(fAddress) munmap(fAddress, fLength);
+
+  fAddress = 0;
+  fLength = 0;
+  fData = 0;
+  fSize = 0;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesCacheFile::Write(const char *fileName, const char *key, const Double_t *data, Long64_t size)
+{
+  FILE *file;
+  uint64_t keySize, paddedSize, valueCount;
+  char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  Bool_t valid;
+  string tmpName;
+  char pid[32];
+
+  // write to a private file and rename it once complete
+  snprintf(pid, sizeof(pid), ".%d.tmp", int(getpid()));
+  tmpName = string(fileName) + pid;
+
+  file = fopen(tmpName.c_str(), "wb");
+  if(!file) return kFALSE;
+
+  keySize = strlen(key);
+  paddedSize = PaddedKeySize(keySize);
+  valueCount = size;
+
+  valid = fwrite(kCacheMagic, sizeof(kCacheMagic), 1, file) == 1
+    && fwrite(&keySize, sizeof(keySize), 1, file) == 1
+    && (keySize == 0 || fwrite(key, keySize, 1, file) == 1)
+    && (paddedSize == keySize || fwrite(padding, paddedSize - keySize, 1, file) == 1)
+    && fwrite(&valueCount, sizeof(valueCount), 1, file) == 1
+    && (size == 0 || fwrite(data, sizeof(Double_t), size, file) == size_t(size));
+
+  valid = (fclose(file) == 0) && valid;
+
+  if(valid) valid = (rename(tmpName.c_str(), fileName) == 0);
+  if(!valid) remove(tmpName.c_str());
+
+  return valid;
+}
@@ -0,0 +1,64 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesCacheFile_h
+#define DelphesCacheFile_h
+
+/** \class DelphesCacheFile
+ *
+ *  Binary file holding an array of doubles computed at initialization,
+ *  tagged with a key describing how it was computed.
+ *
+ *  Files are mapped read-only into memory, so that concurrent processes
+ *  using the data in place share its pages; data copied out of the
+ *  mapping is private to each process.  Files are written under
+ *  a temporary name and renamed, so that readers never see a partial file.
+ *
+ */
+
+#include "Rtypes.h"
+
+class DelphesCacheFile
+{
+public:
+  DelphesCacheFile();
+  ~DelphesCacheFile();
+
+  // return kFALSE if the file is missing or was written for another key
+  Bool_t Open(const char *fileName, const char *key);
+  void Close();
+
+  Bool_t IsOpen() const { return fData != 0; }
+
+  Long64_t GetSize() const { return fSize; }
+  const Double_t *GetData() const { return fData; }
+
+  static Bool_t Write(const char *fileName, const char *key, const Double_t *data, Long64_t size);
+
+private:
+  DelphesCacheFile(const DelphesCacheFile &);
+  DelphesCacheFile &operator=(const DelphesCacheFile &);
+
+  void *fAddress;
+  Long64_t fLength;
+
+  const Double_t *fData;
+  Long64_t fSize;
+};
+
+#endif /* DelphesCacheFile_h */
@@ -0,0 +1,105 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class DelphesCandidateBatch
+ *
+ *  Structure-of-arrays view of the kinematics of a list of candidates.
+ *  Used by the efficiency and smearing modules to evaluate formulas
+ *  and to draw random numbers for all candidates of an array at once.
+ *  The buffers are kept between events to avoid reallocations.
+ *
+ */
+
+#include "classes/DelphesCandidateBatch.h"
+
+#include "classes/DelphesClasses.h"
+#include "classes/DelphesFormula.h"
+
+#include "TRandom3.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+void DelphesCandidateBatch::Clear()
+{
+  Candidates.clear();
+  PT.clear();
+  Eta.clear();
+  Phi.clear();
+  E.clear();
+  fSize = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCandidateBatch::Add(Candidate *candidate, Double_t pt, Double_t eta, Double_t phi, Double_t energy)
+{
+  Candidates.push_back(candidate);
+  PT.push_back(pt);
+  Eta.push_back(eta);
+  Phi.push_back(phi);
+  E.push_back(energy);
+  ++fSize;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCandidateBatch::Evaluate(DelphesFormula *formula, Bool_t useCandidates)
+{
+  Evaluate(formula, Values, useCandidates);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCandidateBatch::Evaluate(DelphesFormula *formula, vector<Double_t> &values, Bool_t useCandidates)
+{
+  values.resize(fSize);
+  if(fSize == 0) return;
+
+  formula->EvalBatch(fSize, &PT[0], &Eta[0], &Phi[0], &E[0],
+    useCandidates ? &Candidates[0] : nullptr, &values[0]);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCandidateBatch::DrawUniform()
+{
+  Random.resize(fSize);
+  if(fSize == 0) return;
+
+  // same sequence as calling gRandom->Uniform() for each candidate
+  gRandom->RndmArray(fSize, &Random[0]);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesCandidateBatch::DrawGaus(Int_t size)
+{
+  Int_t i;
+
+  Random.resize(size);
+
+  // gRandom->Gaus(mean, sigma) returns mean + sigma * gRandom->Gaus(0, 1)
+  for(i = 0; i < size; ++i)
+  {
+    Random[i] = gRandom->Gaus(0.0, 1.0);
+  }
+}
+
+//------------------------------------------------------------------------------
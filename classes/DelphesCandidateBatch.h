@@ -0,0 +1,69 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesCandidateBatch_h
+#define DelphesCandidateBatch_h
+
+/** \class DelphesCandidateBatch
+ *
+ *  Structure-of-arrays view of the kinematics of a list of candidates.
+ *  Used by the efficiency and smearing modules to evaluate formulas
+ *  and to draw random numbers for all candidates of an array at once.
+ *  The buffers are kept between events to avoid reallocations.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class Candidate;
+class DelphesFormula;
+
+class DelphesCandidateBatch
+{
+public:
+  void Clear();
+
+  void Add(Candidate *candidate, Double_t pt, Double_t eta, Double_t phi, Double_t energy);
+
+  Int_t GetSize() const { return fSize; }
+
+  // evaluate formula for all candidates and store results in Values
+  void Evaluate(DelphesFormula *formula, Bool_t useCandidates = kTRUE);
+
+  // same as above, for modules evaluating several formulas per candidate
+  void Evaluate(DelphesFormula *formula, std::vector<Double_t> &values, Bool_t useCandidates = kTRUE);
+
+  // fill Random with uniformly distributed numbers in ]0, 1]
+  void DrawUniform();
+
+  // fill Random with size standard normal numbers
+  void DrawGaus(Int_t size);
+
+  std::vector<Candidate *> Candidates;
+  std::vector<Double_t> PT, Eta, Phi, E;
+
+  std::vector<Double_t> Values;
+  std::vector<Double_t> Random;
+
+private:
+  Int_t fSize = 0;
+};
+
+#endif /* DelphesCandidateBatch_h */
@@ -30,6 +30,11 @@
 #include "classes/DelphesFactory.h"
 #include "classes/SortableObject.h"
 
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
 CompBase *GenParticle::fgCompare = 0;
 CompBase *Photon::fgCompare = CompPT<Photon>::Instance();
 CompBase *Electron::fgCompare = CompPT<Electron>::Instance();
@@ -250,7 +255,7 @@ Candidate::Candidate() :
   SumPtChargedPU(-999),
   SumPt(-999),
   TrackCovariance(5),
-  ClusterIndex(-1), ClusterNDF(0), ClusterSigma(0), SumPT2(0), BTVSumPT2(0), GenDeltaZ(0), GenSumPT2(0),
+  ClusterIndex(-1), ClusterNDF(0), ClusterSigma(0), ClusterChi2(0), SumPT2(0), BTVSumPT2(0), GenDeltaZ(0), GenSumPT2(0),
   NSubJetsTrimmed(0),
   NSubJetsPruned(0),
   NSubJetsSoftDropped(0),
@@ -261,7 +266,8 @@ Candidate::Candidate() :
   ExclYmerge56(0),
   ParticleDensity(0),
   fFactory(0),
-  fArray(0)
+  fArray(0),
+  fLeafIDsReady(kFALSE)
 {
   int i;
   Edges[0] = 0.0;
@@ -295,41 +301,112 @@ Candidate::Candidate() :
 
 void Candidate::AddCandidate(Candidate *object)
 {
-  if(!fArray) fArray = fFactory->NewArray();
-  fArray->Add(object);
+  GetCandidates()->Add(object);
+  fLeafIDsReady = kFALSE;
 }
 
 //------------------------------------------------------------------------------
 
 TObjArray *Candidate::GetCandidates()
 {
-  if(!fArray) fArray = fFactory->NewArray();
-  return fArray;
+  TObjArray *array = __atomic_load_n(&fArray, __ATOMIC_ACQUIRE);
+  TObjArray *expected = 0;
+
+  if(array) return array;
+
+  // another thread may have created the array in the meantime,
+  // the unused array is released with the other objects of the event
+  array = fFactory->NewArray();
+  if(!__atomic_compare_exchange_n(&fArray, &expected, array, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+  {
+    array = expected;
+  }
+
+  return array;
 }
 
 //------------------------------------------------------------------------------
 
-Bool_t Candidate::Overlaps(const Candidate *object) const
+const std::vector<UInt_t> &Candidate::GetLeafIDs() const
 {
+  static std::mutex leafIDsMutex;
+  static thread_local std::vector<UInt_t> leafIDs;
+  const TObjArray *array;
   const Candidate *candidate;
+  Int_t i, size;
+  size_t middle;
 
-  if(object->GetUniqueID() == GetUniqueID()) return kTRUE;
+  if(__atomic_load_n(&fLeafIDsReady, __ATOMIC_ACQUIRE)) return fLeafIDs;
 
-  if(fArray)
+  array = __atomic_load_n(&fArray, __ATOMIC_ACQUIRE);
+  size = array ? array->GetEntriesFast() : 0;
+
+  // lists of the constituents first, the buffer is shared by all calls of this thread
+  for(i = 0; i < size; ++i)
+  {
+    static_cast<Candidate *>(array->UncheckedAt(i))->GetLeafIDs();
+  }
+
+  leafIDs.clear();
+
+  if(size == 0)
+  {
+    leafIDs.push_back(GetUniqueID());
+  }
+  else
   {
-    TIter it(fArray);
-    while((candidate = static_cast<Candidate *>(it.Next())))
+    // merge the sorted lists of all constituents
+    for(i = 0; i < size; ++i)
     {
-      if(candidate->Overlaps(object)) return kTRUE;
+      candidate = static_cast<Candidate *>(array->UncheckedAt(i));
+      const std::vector<UInt_t> &ids = candidate->fLeafIDs;
+      middle = leafIDs.size();
+      leafIDs.insert(leafIDs.end(), ids.begin(), ids.end());
+      std::inplace_merge(leafIDs.begin(), leafIDs.begin() + middle, leafIDs.end());
     }
+    leafIDs.erase(std::unique(leafIDs.begin(), leafIDs.end()), leafIDs.end());
+  }
+
+  // the same candidate can be reached by modules running concurrently
+  std::lock_guard<std::mutex> lock(leafIDsMutex);
+  if(!__atomic_load_n(&fLeafIDsReady, __ATOMIC_RELAXED))
+  {
+    fLeafIDs.assign(leafIDs.begin(), leafIDs.end());
+    __atomic_store_n(&fLeafIDsReady, kTRUE, __ATOMIC_RELEASE);
   }
 
-  if(object->fArray)
+  return fLeafIDs;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t Candidate::Overlaps(const Candidate *object) const
+{
+  std::vector<UInt_t>::const_iterator it1, it2, end1, end2;
+
+  if(object->GetUniqueID() == GetUniqueID()) return kTRUE;
+
+  // two candidates overlap if they share at least one generator particle
+  const std::vector<UInt_t> &ids1 = GetLeafIDs();
+  const std::vector<UInt_t> &ids2 = object->GetLeafIDs();
+
+  it1 = ids1.begin();
+  end1 = ids1.end();
+  it2 = ids2.begin();
+  end2 = ids2.end();
+  while(it1 != end1 && it2 != end2)
   {
-    TIter it(object->fArray);
-    while((candidate = static_cast<Candidate *>(it.Next())))
+    if(*it1 < *it2)
+    {
+      ++it1;
+    }
+    else if(*it2 < *it1)
+    {
+      ++it2;
+    }
+    else
     {
-      if(candidate->Overlaps(this)) return kTRUE;
+      return kTRUE;
     }
   }
 
@@ -338,11 +415,57 @@ Bool_t Candidate::Overlaps(const Candidate *object) const
 
 //------------------------------------------------------------------------------
 
+void Candidate::MultiplyEfficiencyWeights(const std::vector<Double_t> &weights)
+{
+  std::stringstream message;
+  size_t i, size = weights.size();
+
+  if(EfficiencyWeights.empty()) EfficiencyWeights.assign(size, 1.0);
+
+  if(EfficiencyWeights.size() != size)
+  {
+    message << "candidate has " << EfficiencyWeights.size() << " efficiency weights, ";
+    message << size << " expected from WeightVariations";
+    throw std::runtime_error(message.str());
+  }
+
+  for(i = 0; i < size; ++i)
+  {
+    EfficiencyWeights[i] *= weights[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+
+static void SetTagWeights(std::vector<Float_t> &tagWeights, Int_t bitNumber, const std::vector<Double_t> &weights)
+{
+  size_t size = weights.size();
+
+  // weights of bit number i start at i * size
+  if(tagWeights.size() < (bitNumber + 1) * size) tagWeights.resize((bitNumber + 1) * size, -1.0);
+
+  std::copy(weights.begin(), weights.end(), tagWeights.begin() + bitNumber * size);
+}
+
+//------------------------------------------------------------------------------
+
+void Candidate::SetBTagWeights(Int_t bitNumber, const std::vector<Double_t> &weights)
+{
+  SetTagWeights(BTagWeights, bitNumber, weights);
+}
+
+//------------------------------------------------------------------------------
+
+void Candidate::SetTauWeights(Int_t bitNumber, const std::vector<Double_t> &weights)
+{
+  SetTagWeights(TauWeights, bitNumber, weights);
+}
+
+//------------------------------------------------------------------------------
+
 TObject *Candidate::Clone(const char * /*newname*/) const
 {
-  Candidate *object = fFactory->NewCandidate();
-  Copy(*object);
-  return object;
+  return fFactory->NewCandidate(*this);
 }
 
 //------------------------------------------------------------------------------
@@ -367,6 +490,7 @@ void Candidate::Copy(TObject &obj) const
   object.ClusterIndex = ClusterIndex;
   object.ClusterNDF = ClusterNDF;
   object.ClusterSigma = ClusterSigma;
+  object.ClusterChi2 = ClusterChi2;
   object.SumPT2 = SumPT2;
   object.BTVSumPT2 = BTVSumPT2;
   object.GenDeltaZ = GenDeltaZ;
@@ -438,6 +562,7 @@ void Candidate::Copy(TObject &obj) const
   object.ClusterIndex = ClusterIndex;
   object.ClusterNDF = ClusterNDF;
   object.ClusterSigma = ClusterSigma;
+  object.ClusterChi2 = ClusterChi2;
   object.SumPT2 = SumPT2;
 
   object.FracPt[0] = FracPt[0];
@@ -482,13 +607,19 @@ void Candidate::Copy(TObject &obj) const
   object.TrackCovariance = TrackCovariance;
   object.fFactory = fFactory;
   object.fArray = 0;
+  object.fLeafIDsReady = kFALSE;
 
   // copy cluster timing info
   copy(ECalEnergyTimePairs.begin(), ECalEnergyTimePairs.end(), back_inserter(object.ECalEnergyTimePairs));
 
-  if(fArray && fArray->GetEntriesFast() > 0)
+  object.EfficiencyWeights = EfficiencyWeights;
+  object.BTagWeights = BTagWeights;
+  object.TauWeights = TauWeights;
+
+  TObjArray *constituents = __atomic_load_n(&fArray, __ATOMIC_ACQUIRE);
+  if(constituents && constituents->GetEntriesFast() > 0)
   {
-    TIter itArray(fArray);
+    TIter itArray(constituents);
     TObjArray *array = object.GetCandidates();
     while((candidate = static_cast<Candidate *>(itArray.Next())))
     {
@@ -575,6 +706,10 @@ void Candidate::Clear(Option_t * /*option*/)
   NTimeHits = 0;
   ECalEnergyTimePairs.clear();
 
+  EfficiencyWeights.clear();
+  BTagWeights.clear();
+  TauWeights.clear();
+
   IsolationVar = -999;
   IsolationVarRhoCorr = -999;
   SumPtCharged = -999;
@@ -585,6 +720,7 @@ void Candidate::Clear(Option_t * /*option*/)
   ClusterIndex = -1;
   ClusterNDF = -99;
   ClusterSigma = 0.0;
+  ClusterChi2 = 0.0;
   SumPT2 = 0.0;
   BTVSumPT2 = 0.0;
   GenDeltaZ = 0.0;
@@ -624,4 +760,6 @@ void Candidate::Clear(Option_t * /*option*/)
   NSubJetsSoftDropped = 0;
 
   fArray = 0;
+  fLeafIDs.clear();
+  fLeafIDsReady = kFALSE;
 }
@@ -118,7 +118,9 @@ public:
   Float_t PDF1; // PDF (id1, x1, Q) | pdf_info()->pdf1()
   Float_t PDF2; // PDF (id2, x2, Q) | pdf_info()->pdf2()
 
-  ClassDef(HepMCEvent, 3)
+  Int_t Stream; // index of the input file or stream the event was read from
+
+  ClassDef(HepMCEvent, 4)
 };
 
 //---------------------------------------------------------------------------
@@ -184,6 +186,7 @@ public:
   Int_t NDF; // number of degrees of freedom
 
   Double_t Sigma; // vertex position (z component) error
+  Double_t Chi2; // vertex fit chi2
   Double_t SumPT2; // sum pt^2 of tracks attached to the vertex
   Double_t GenSumPT2; // sum pt^2 of gen tracks attached to the vertex
 
@@ -195,7 +198,7 @@ public:
   static CompBase *fgCompare; //!
   const CompBase *GetCompare() const { return fgCompare; }
 
-  ClassDef(Vertex, 3)
+  ClassDef(Vertex, 4)
 };
 
 //---------------------------------------------------------------------------
@@ -269,12 +272,14 @@ public:
 
   Int_t Status; // 1: prompt, 2: non prompt, 3: fake
 
+  std::vector<Float_t> EfficiencyWeights; // efficiency weights for the nominal formulas and their variations
+
   static CompBase *fgCompare; //!
   const CompBase *GetCompare() const { return fgCompare; }
 
   TLorentzVector P4() const;
 
-  ClassDef(Photon, 4)
+  ClassDef(Photon, 5)
 };
 
 //---------------------------------------------------------------------------
@@ -306,12 +311,14 @@ public:
   Float_t ErrorD0; // track transverse impact parameter error
   Float_t ErrorDZ; // track longitudinal impact parameter error
 
+  std::vector<Float_t> EfficiencyWeights; // efficiency weights for the nominal formulas and their variations
+
   static CompBase *fgCompare; //!
   const CompBase *GetCompare() const { return fgCompare; }
 
   TLorentzVector P4() const;
 
-  ClassDef(Electron, 4)
+  ClassDef(Electron, 5)
 };
 
 //---------------------------------------------------------------------------
@@ -341,12 +348,14 @@ public:
   Float_t ErrorD0; // track transverse impact parameter error
   Float_t ErrorDZ; // track longitudinal impact parameter error
 
+  std::vector<Float_t> EfficiencyWeights; // efficiency weights for the nominal formulas and their variations
+
   static CompBase *fgCompare; //!
   const CompBase *GetCompare() const { return fgCompare; }
 
   TLorentzVector P4() const;
 
-  ClassDef(Muon, 4)
+  ClassDef(Muon, 5)
 };
 
 //---------------------------------------------------------------------------
@@ -377,6 +386,9 @@ public:
   UInt_t TauTag; // 0 or 1 for a jet that has been tagged as a tau
   Float_t TauWeight; // probability for jet to be identified as tau
 
+  std::vector<Float_t> BTagWeights; // b-tagging probabilities for the nominal formulas and their variations, for each bit number
+  std::vector<Float_t> TauWeights; // tau-tagging probabilities for the nominal formulas and their variations, for each bit number
+
   Int_t Charge; // tau charge
 
   Float_t EhadOverEem; // ratio of the hadronic versus electromagnetic energy deposited in the calorimeter
@@ -422,7 +434,7 @@ public:
   TLorentzVector P4() const;
   TLorentzVector Area;
 
-  ClassDef(Jet, 5)
+  ClassDef(Jet, 6)
 };
 
 //---------------------------------------------------------------------------
@@ -499,13 +511,15 @@ public:
 
   Int_t VertexIndex; // reference to vertex
 
+  std::vector<Float_t> EfficiencyWeights; // efficiency weights for the nominal formulas and their variations
+
   static CompBase *fgCompare; //!
   const CompBase *GetCompare() const { return fgCompare; }
 
   TLorentzVector P4() const;
   TMatrixDSym CovarianceMatrix() const;
 
-  ClassDef(Track, 4)
+  ClassDef(Track, 5)
 };
 
 //---------------------------------------------------------------------------
@@ -786,6 +800,15 @@ public:
   Int_t NTimeHits;
   std::vector<std::pair<Float_t, Float_t> > ECalEnergyTimePairs;
 
+  // Efficiency weights for the nominal formulas and the variations listed
+  // by the global parameter WeightVariations, empty unless set by modules
+  // running with UseWeights; tagging weights are stored for each bit
+  // number, weights of bits without weights are -1
+
+  std::vector<Float_t> EfficiencyWeights;
+  std::vector<Float_t> BTagWeights;
+  std::vector<Float_t> TauWeights;
+
   // Isolation variables
 
   Float_t IsolationVar;
@@ -804,6 +827,7 @@ public:
   Int_t ClusterIndex;
   Int_t ClusterNDF;
   Double_t ClusterSigma;
+  Double_t ClusterChi2;
   Double_t SumPT2;
   Double_t BTVSumPT2;
   Double_t GenDeltaZ;
@@ -845,17 +869,35 @@ public:
 
   Bool_t Overlaps(const Candidate *object) const;
 
+  // sorted unique IDs of the candidates without constituents
+  // (generator particles) this candidate is built from
+  const std::vector<UInt_t> &GetLeafIDs() const;
+
+  // multiply EfficiencyWeights by weights, both lists should hold
+  // the nominal weight followed by one weight per variation
+  void MultiplyEfficiencyWeights(const std::vector<Double_t> &weights);
+
+  // store weights as the tagging weights of the given bit number
+  void SetBTagWeights(Int_t bitNumber, const std::vector<Double_t> &weights);
+  void SetTauWeights(Int_t bitNumber, const std::vector<Double_t> &weights);
+
   virtual void Copy(TObject &object) const;
   virtual TObject *Clone(const char *newname = "") const;
   virtual void Clear(Option_t *option = "");
 
 private:
   DelphesFactory *fFactory; //!
+  // the array of constituents and the leaf IDs are created on first use,
+  // possibly by several modules running concurrently, fArray and
+  // fLeafIDsReady are only accessed atomically in DelphesClasses.cc
   TObjArray *fArray; //!
 
+  mutable std::vector<UInt_t> fLeafIDs; //!
+  mutable Bool_t fLeafIDsReady; //!
+
   void SetFactory(DelphesFactory *factory) { fFactory = factory; }
 
-  ClassDef(Candidate, 6)
+  ClassDef(Candidate, 8)
 };
 
 #endif // DelphesClasses_h
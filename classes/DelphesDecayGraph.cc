@@ -0,0 +1,128 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class DelphesDecayGraph
+ *
+ *  Mother and daughter lists of all generated particles of an event,
+ *  stored in compressed sparse row format.
+ *
+ *  The M1/M2 and D1/D2 indices of each particle are decoded once with
+ *  a single convention: a range if first <= second, two entries if
+ *  first > second and one entry if only one of them is valid.
+ *
+ *  Graphs are owned by DelphesFactory, see DelphesFactory::GetDecayGraph.
+ *
+ */
+
+#include "classes/DelphesDecayGraph.h"
+
+#include "classes/DelphesClasses.h"
+
+#include "TObjArray.h"
+
+#include <algorithm>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesDecayGraph::DelphesDecayGraph()
+{
+  Clear();
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesDecayGraph::Clear()
+{
+  fMotherOffsets.assign(1, 0);
+  fMothers.clear();
+  fDaughterOffsets.assign(1, 0);
+  fDaughters.clear();
+  fIndices.clear();
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesDecayGraph::GetIndex(const TObject *particle) const
+{
+  unordered_map<const TObject *, Int_t>::const_iterator it = fIndices.find(particle);
+  return it != fIndices.end() ? it->second : -1;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesDecayGraph::AddLinks(Int_t first, Int_t second, Int_t size, vector<Int_t> &links)
+{
+  Int_t i;
+
+  if(first >= size) first = -1;
+  if(second >= size) second = -1;
+
+  if(first < 0 && second < 0)
+  {
+    return;
+  }
+  else if(first < 0 || second < 0)
+  {
+    links.push_back(max(first, second));
+  }
+  else if(first > second)
+  {
+    links.push_back(first);
+    links.push_back(second);
+  }
+  else
+  {
+    for(i = first; i <= second; ++i)
+    {
+      links.push_back(i);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesDecayGraph::Build(const TObjArray *particles)
+{
+  Int_t i, size;
+  Candidate *candidate;
+
+  Clear();
+
+  size = particles->GetEntriesFast();
+
+  fMotherOffsets.reserve(size + 1);
+  fDaughterOffsets.reserve(size + 1);
+  fIndices.reserve(size);
+
+  for(i = 0; i < size; ++i)
+  {
+    candidate = static_cast<Candidate *>(particles->At(i));
+
+    fIndices[candidate] = i;
+
+    AddLinks(candidate->M1, candidate->M2, size, fMothers);
+    fMotherOffsets.push_back(fMothers.size());
+
+    AddLinks(candidate->D1, candidate->D2, size, fDaughters);
+    fDaughterOffsets.push_back(fDaughters.size());
+  }
+}
+
+//------------------------------------------------------------------------------
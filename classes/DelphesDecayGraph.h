@@ -0,0 +1,74 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesDecayGraph_h
+#define DelphesDecayGraph_h
+
+/** \class DelphesDecayGraph
+ *
+ *  Mother and daughter lists of all generated particles of an event,
+ *  stored in compressed sparse row format.
+ *
+ *  The M1/M2 and D1/D2 indices of each particle are decoded once with
+ *  a single convention: a range if first <= second, two entries if
+ *  first > second and one entry if only one of them is valid.
+ *
+ *  Graphs are owned by DelphesFactory, see DelphesFactory::GetDecayGraph.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <unordered_map>
+#include <vector>
+
+class TObject;
+class TObjArray;
+
+class DelphesDecayGraph
+{
+public:
+  DelphesDecayGraph();
+
+  void Clear();
+  void Build(const TObjArray *particles);
+
+  Int_t GetNParticles() const { return fMotherOffsets.size() - 1; }
+
+  // index of a particle in the input array, -1 if not found
+  Int_t GetIndex(const TObject *particle) const;
+
+  Int_t GetNMothers(Int_t i) const { return fMotherOffsets[i + 1] - fMotherOffsets[i]; }
+  const Int_t *GetMothers(Int_t i) const { return fMothers.data() + fMotherOffsets[i]; }
+
+  // first mother, -1 if none
+  Int_t GetMother(Int_t i) const { return GetNMothers(i) > 0 ? fMothers[fMotherOffsets[i]] : -1; }
+
+  Int_t GetNDaughters(Int_t i) const { return fDaughterOffsets[i + 1] - fDaughterOffsets[i]; }
+  const Int_t *GetDaughters(Int_t i) const { return fDaughters.data() + fDaughterOffsets[i]; }
+
+private:
+  static void AddLinks(Int_t first, Int_t second, Int_t size, std::vector<Int_t> &links);
+
+  std::vector<Int_t> fMotherOffsets, fMothers;
+  std::vector<Int_t> fDaughterOffsets, fDaughters;
+
+  std::unordered_map<const TObject *, Int_t> fIndices;
+};
+
+#endif /* DelphesDecayGraph_h */
@@ -0,0 +1,171 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class DelphesEventQueue
+ *
+ *  Reads text event records from several inputs concurrently,
+ *  one thread per input, and hands complete records to the main thread
+ *  in the order in which they become available.
+ *
+ *  A record starts with a line beginning with the record prefix
+ *  (e.g. "E " for HepMC2) and extends up to the next such line.
+ *  Lines preceding the first record of an input are skipped.
+ *
+ */
+
+#include "classes/DelphesEventQueue.h"
+
+#include <string.h>
+
+using namespace std;
+
+static const int kBufferSize = 16384;
+
+//---------------------------------------------------------------------------
+
+DelphesEventQueue::DelphesEventQueue(const char *recordPrefix, int capacity) :
+  fPrefix(recordPrefix), fCapacity(capacity > 0 ? capacity : 1),
+  fRunning(0), fStop(false)
+{
+}
+
+//---------------------------------------------------------------------------
+
+DelphesEventQueue::~DelphesEventQueue()
+{
+  vector<Input *>::iterator itInputs;
+
+  Stop();
+
+  for(itInputs = fInputs.begin(); itInputs != fInputs.end(); ++itInputs)
+  {
+    if((*itInputs)->thread.joinable()) (*itInputs)->thread.join();
+    if((*itInputs)->file != stdin) fclose((*itInputs)->file);
+    delete *itInputs;
+  }
+}
+
+//---------------------------------------------------------------------------
+
+int DelphesEventQueue::AddInput(FILE *inputFile, const char *name)
+{
+  Input *input = new Input;
+
+  input->file = inputFile;
+  input->name = name;
+  input->waiting = 0;
+
+  fInputs.push_back(input);
+
+  return fInputs.size() - 1;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesEventQueue::Start()
+{
+  int i;
+
+  fRunning = fInputs.size();
+
+  for(i = 0; i < int(fInputs.size()); ++i)
+  {
+    fInputs[i]->thread = thread(&DelphesEventQueue::Read, this, i);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesEventQueue::Stop()
+{
+  lock_guard<mutex> lock(fMutex);
+
+  fStop = true;
+  fSpaceCondition.notify_all();
+  fReadyCondition.notify_all();
+}
+
+//---------------------------------------------------------------------------
+
+bool DelphesEventQueue::Pop(int &input, string &record)
+{
+  unique_lock<mutex> lock(fMutex);
+
+  fReadyCondition.wait(lock, [this] { return !fRecords.empty() || fRunning == 0 || fStop; });
+
+  if(fRecords.empty()) return false;
+
+  input = fRecords.front().input;
+  record.swap(fRecords.front().text);
+  fRecords.pop_front();
+
+  --fInputs[input]->waiting;
+  fSpaceCondition.notify_all();
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool DelphesEventQueue::Push(int input, string &record)
+{
+  unique_lock<mutex> lock(fMutex);
+
+  fSpaceCondition.wait(lock, [this, input] { return fInputs[input]->waiting < fCapacity || fStop; });
+
+  if(fStop) return false;
+
+  fRecords.push_back(Record());
+  fRecords.back().input = input;
+  fRecords.back().text.swap(record);
+
+  ++fInputs[input]->waiting;
+  fReadyCondition.notify_one();
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+void DelphesEventQueue::Read(int input)
+{
+  FILE *file = fInputs[input]->file;
+  char *buffer = new char[kBufferSize];
+  string record;
+  bool started = false, stopped = false;
+
+  while(!stopped && fgets(buffer, kBufferSize, file))
+  {
+    if(strncmp(buffer, fPrefix.c_str(), fPrefix.size()) == 0)
+    {
+      if(started) stopped = !Push(input, record);
+      record.clear();
+      started = true;
+    }
+
+    if(started) record.append(buffer);
+  }
+
+  if(started && !stopped) Push(input, record);
+
+  delete[] buffer;
+
+  lock_guard<mutex> lock(fMutex);
+  --fRunning;
+  fReadyCondition.notify_all();
+}
@@ -0,0 +1,94 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesEventQueue_h
+#define DelphesEventQueue_h
+
+/** \class DelphesEventQueue
+ *
+ *  Reads text event records from several inputs concurrently,
+ *  one thread per input, and hands complete records to the main thread
+ *  in the order in which they become available.
+ *
+ *  A record starts with a line beginning with the record prefix
+ *  (e.g. "E " for HepMC2) and extends up to the next such line.
+ *  Lines preceding the first record of an input are skipped.
+ *
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+
+class DelphesEventQueue
+{
+public:
+  // capacity is the maximum number of records waiting per input
+  DelphesEventQueue(const char *recordPrefix, int capacity = 8);
+  ~DelphesEventQueue();
+
+  // the queue takes ownership of the file, return the input index
+  int AddInput(FILE *inputFile, const char *name);
+
+  int GetNumberOfInputs() const { return fInputs.size(); }
+  const char *GetInputName(int input) const { return fInputs[input]->name.c_str(); }
+
+  void Start();
+
+  // ask the reading threads to stop after their current line
+  void Stop();
+
+  // wait for the next record, return false when all inputs are exhausted
+  bool Pop(int &input, std::string &record);
+
+private:
+  struct Input
+  {
+    FILE *file;
+    std::string name;
+    int waiting;
+    std::thread thread;
+  };
+
+  struct Record
+  {
+    int input;
+    std::string text;
+  };
+
+  void Read(int input);
+  bool Push(int input, std::string &record);
+
+  std::string fPrefix;
+  int fCapacity;
+
+  std::vector<Input *> fInputs;
+
+  std::mutex fMutex;
+  std::condition_variable fReadyCondition, fSpaceCondition;
+  std::deque<Record> fRecords;
+  int fRunning;
+  bool fStop;
+};
+
+#endif // DelphesEventQueue_h
@@ -27,18 +27,27 @@
 
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesDecayGraph.h"
 
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 
 #include "TClass.h"
 #include "TObjArray.h"
 
+#include <mutex>
+#include <stdexcept>
+
 using namespace std;
 
 //------------------------------------------------------------------------------
 
+// lock of the object creation, shared by all factories
+static mutex gFactoryMutex;
+
+//------------------------------------------------------------------------------
+
 DelphesFactory::DelphesFactory(const char *name) :
-  TNamed(name, ""), fObjArrays(0)
+  TNamed(name, ""), fObjArrays(0), fCandidateCount(0), fThreadSafe(kFALSE)
 {
   fObjArrays = new ExRootTreeBranch("PermanentObjArrays", TObjArray::Class(), 0);
 }
@@ -54,6 +63,12 @@ DelphesFactory::~DelphesFactory()
   {
     delete(itBranches->second);
   }
+
+  map<const TObjArray *, DelphesDecayGraph *>::iterator itDecayGraphs;
+  for(itDecayGraphs = fDecayGraphs.begin(); itDecayGraphs != fDecayGraphs.end(); ++itDecayGraphs)
+  {
+    delete(itDecayGraphs->second);
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -66,19 +81,27 @@ void DelphesFactory::Clear(Option_t * /*option*/)
     (*itPool)->Clear();
   }
 
-  TProcessID::SetObjectCount(0);
+  fCandidateCount = 0;
 
   map<const TClass *, ExRootTreeBranch *>::iterator itBranches;
   for(itBranches = fBranches.begin(); itBranches != fBranches.end(); ++itBranches)
   {
     itBranches->second->Clear();
   }
+
+  map<const TObjArray *, DelphesDecayGraph *>::iterator itDecayGraphs;
+  for(itDecayGraphs = fDecayGraphs.begin(); itDecayGraphs != fDecayGraphs.end(); ++itDecayGraphs)
+  {
+    itDecayGraphs->second->Clear();
+  }
 }
 
 //------------------------------------------------------------------------------
 
 TObjArray *DelphesFactory::NewPermanentArray()
 {
+  unique_lock<mutex> lock(gFactoryMutex, defer_lock);
+  if(fThreadSafe) lock.lock();
   TObjArray *array = static_cast<TObjArray *>(fObjArrays->NewEntry());
   fPool.insert(array);
   return array;
@@ -88,17 +111,81 @@ TObjArray *DelphesFactory::NewPermanentArray()
 
 Candidate *DelphesFactory::NewCandidate()
 {
-  Candidate *object = New<Candidate>();
+  Candidate *object;
+  UInt_t id;
+
+  {
+    unique_lock<mutex> lock(gFactoryMutex, defer_lock);
+    if(fThreadSafe) lock.lock();
+    object = static_cast<Candidate *>(GetBranch(Candidate::Class())->NewEntry());
+    id = NextID();
+  }
+
+  object->Clear();
+  object->SetFactory(this);
+  object->SetUniqueID(id);
+  object->SetBit(kIsReferenced);
+  return object;
+}
+
+//------------------------------------------------------------------------------
+
+Candidate *DelphesFactory::NewCandidate(const Candidate &source)
+{
+  Candidate *object;
+  UInt_t id;
+
+  {
+    unique_lock<mutex> lock(gFactoryMutex, defer_lock);
+    if(fThreadSafe) lock.lock();
+    object = static_cast<Candidate *>(GetBranch(Candidate::Class())->NewEntry());
+    id = NextID();
+  }
+
+  // Copy sets every data member except these, which Clear would reset
+  object->ECalEnergyTimePairs.clear();
+  object->ParticleDensity = 0.0;
+  object->fLeafIDs.clear();
+
+  source.Copy(*object);
+
   object->SetFactory(this);
-  TProcessID::AssignID(object);
+  object->SetUniqueID(id);
+  object->SetBit(kIsReferenced);
   return object;
 }
 
 //------------------------------------------------------------------------------
 
+UInt_t DelphesFactory::NextID()
+{
+  // IDs are counted per event and never go through the global table
+  // of TProcessID, the referenced bit makes TRef and TRefArray keep
+  // this ID when the candidate is referenced at output time.
+  // The upper 8 bits of the ID select the process ID in ROOT.
+  if(fCandidateCount >= 0xffffff)
+  {
+    throw runtime_error("too many candidates in one event");
+  }
+
+  return ++fCandidateCount;
+}
+
+//------------------------------------------------------------------------------
+
 TObject *DelphesFactory::New(TClass *cl)
 {
-  TObject *object = 0;
+  unique_lock<mutex> lock(gFactoryMutex, defer_lock);
+  if(fThreadSafe) lock.lock();
+  TObject *object = GetBranch(cl)->NewEntry();
+  object->Clear();
+  return object;
+}
+
+//------------------------------------------------------------------------------
+
+ExRootTreeBranch *DelphesFactory::GetBranch(TClass *cl)
+{
   ExRootTreeBranch *branch = 0;
   map<const TClass *, ExRootTreeBranch *>::iterator it = fBranches.find(cl);
 
@@ -112,9 +199,34 @@ TObject *DelphesFactory::New(TClass *cl)
     fBranches.insert(make_pair(cl, branch));
   }
 
-  object = branch->NewEntry();
-  object->Clear();
-  return object;
+  return branch;
+}
+
+//------------------------------------------------------------------------------
+
+const DelphesDecayGraph *DelphesFactory::GetDecayGraph(const TObjArray *particles)
+{
+  unique_lock<mutex> lock(gFactoryMutex, defer_lock);
+  if(fThreadSafe) lock.lock();
+  DelphesDecayGraph *graph = 0;
+  map<const TObjArray *, DelphesDecayGraph *>::iterator it = fDecayGraphs.find(particles);
+
+  if(it != fDecayGraphs.end())
+  {
+    graph = it->second;
+  }
+  else
+  {
+    graph = new DelphesDecayGraph;
+    fDecayGraphs.insert(make_pair(particles, graph));
+  }
+
+  if(graph->GetNParticles() != particles->GetEntriesFast())
+  {
+    graph->Build(particles);
+  }
+
+  return graph;
 }
 
 //------------------------------------------------------------------------------
@@ -35,6 +35,7 @@
 
 class TObjArray;
 class Candidate;
+class DelphesDecayGraph;
 
 class ExRootTreeBranch;
 
@@ -46,22 +47,45 @@ public:
 
   virtual void Clear(Option_t *option = "");
 
+  // serialize the creation of objects, needed when modules run concurrently;
+  // the lock is kept out of the class, which is seen by the dictionary
+  void SetThreadSafe(Bool_t flag) { fThreadSafe = flag; }
+
   TObjArray *NewPermanentArray();
 
   TObjArray *NewArray() { return New<TObjArray>(); }
 
+  // candidates are identified by a per-event 32-bit ID, returned by
+  // GetUniqueID and used by TRef and TRefArray when the event is written
   Candidate *NewCandidate();
 
+  // new candidate filled by source.Copy, without clearing the recycled
+  // entry first; the result is the same as NewCandidate followed by Copy
+  Candidate *NewCandidate(const Candidate &source);
+
   TObject *New(TClass *cl);
 
   template <typename T>
   T *New() { return static_cast<T *>(New(T::Class())); }
 
+  // mother/daughter graph of an array of generated particles,
+  // built on first request and kept until the end of the event
+  const DelphesDecayGraph *GetDecayGraph(const TObjArray *particles);
+
 private:
+  ExRootTreeBranch *GetBranch(TClass *cl);
+
+  UInt_t NextID();
+
   ExRootTreeBranch *fObjArrays; //!
 
+  UInt_t fCandidateCount; //!
+
+  Bool_t fThreadSafe; //!
+
 #if !defined(__CINT__) && !defined(__CLING__)
   std::map<const TClass *, ExRootTreeBranch *> fBranches; //!
+  std::map<const TObjArray *, DelphesDecayGraph *> fDecayGraphs; //!
 #endif
 
   std::set<TObject *> fPool; //!
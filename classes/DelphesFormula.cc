@@ -18,15 +18,144 @@
 
 #include "classes/DelphesFormula.h"
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesResolutionMap.h"
 
 #include "TString.h"
 
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 
 using namespace std;
 
 //------------------------------------------------------------------------------
 
+static UInt_t FindVariable(const TString &name)
+{
+  // the TFormula names x, y, z and t can also be used directly
+  if(name == "pt" || name == "x") return DelphesFormula::kPT;
+  if(name == "eta" || name == "y") return DelphesFormula::kEta;
+  if(name == "phi" || name == "z") return DelphesFormula::kPhi;
+  if(name == "energy" || name == "t") return DelphesFormula::kEnergy;
+  if(name == "d0" || name == "dz" || name == "ctgTheta" || name == "radius" || name == "density") return DelphesFormula::kCandidate;
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+
+static Bool_t IsOperandChar(const char *begin, const char *it)
+{
+  if(isalnum(*it) || *it == '_' || *it == '.' || *it == ':') return kTRUE;
+
+  // sign of an exponent, as in 1.0e-3
+  return (*it == '+' || *it == '-') && it - begin >= 2 && (it[-1] == 'e' || it[-1] == 'E') && (isdigit(it[-2]) || it[-2] == '.');
+}
+
+//------------------------------------------------------------------------------
+
+// number, variable or abs(variable)
+static Bool_t ParseOperand(const TString &text, UInt_t &variable, Double_t &value, Bool_t &isAbs)
+{
+  static const char *functions[] = {"abs(", "fabs(", "TMath::Abs("};
+  TString name = text;
+  char *end;
+  UInt_t i;
+
+  variable = 0;
+  value = 0.0;
+  isAbs = kFALSE;
+
+  if(text.Length() == 0) return kFALSE;
+
+  value = strtod(text.Data(), &end);
+  if(*end == 0) return kTRUE;
+
+  for(i = 0; i < sizeof(functions) / sizeof(functions[0]); ++i)
+  {
+    Ssiz_t length = strlen(functions[i]);
+    if(text.BeginsWith(functions[i]) && text.EndsWith(")"))
+    {
+      name = text(length, text.Length() - length - 1);
+      isAbs = kTRUE;
+      break;
+    }
+  }
+
+  variable = FindVariable(name);
+  return variable != 0;
+}
+
+//------------------------------------------------------------------------------
+
+// comparison of a variable with a number, op points to the operator and next
+// to the first character after it
+static Bool_t ParseComparison(const char *begin, const char *op, const char *next, UInt_t &variable, Double_t &value, Bool_t &isAbs)
+{
+  const char *first, *last;
+  UInt_t leftVariable, rightVariable;
+  Double_t leftValue, rightValue;
+  Bool_t leftAbs, rightAbs;
+  Int_t depth;
+
+  // left operand, optionally followed by an argument list
+  first = op;
+  if(first > begin && first[-1] == ')')
+  {
+    depth = 0;
+    do
+    {
+      --first;
+      if(*first == ')') ++depth;
+      if(*first == '(') --depth;
+    } while(first > begin && depth > 0);
+  }
+  while(first > begin && IsOperandChar(begin, first - 1)) --first;
+  if(first > begin && first[-1] == '-' && (first - 1 == begin || strchr("(&|,!", first[-2]))) --first;
+
+  // right operand, optionally followed by an argument list
+  last = next;
+  if(*last == '-' || *last == '+') ++last;
+  while(*last && IsOperandChar(begin, last)) ++last;
+  if(*last == '(')
+  {
+    depth = 0;
+    do
+    {
+      if(*last == '(') ++depth;
+      if(*last == ')') --depth;
+      ++last;
+    } while(*last && depth > 0);
+  }
+
+  // the comparison must not be part of a larger arithmetic expression
+  if(first > begin && !strchr("(&|,!", first[-1])) return kFALSE;
+  if(*last && !strchr(")&|,?", *last)) return kFALSE;
+
+  if(!ParseOperand(TString(first, op - first), leftVariable, leftValue, leftAbs)) return kFALSE;
+  if(!ParseOperand(TString(next, last - next), rightVariable, rightValue, rightAbs)) return kFALSE;
+
+  if(leftVariable && !rightVariable)
+  {
+    variable = leftVariable;
+    value = rightValue;
+    isAbs = leftAbs;
+    return kTRUE;
+  }
+
+  if(!leftVariable && rightVariable)
+  {
+    variable = rightVariable;
+    value = leftValue;
+    isAbs = rightAbs;
+    return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
 DelphesFormula::DelphesFormula() :
   TFormula()
 {
@@ -43,6 +172,7 @@ DelphesFormula::DelphesFormula(const char * /*name*/, const char * /*expression*
 
 DelphesFormula::~DelphesFormula()
 {
+  delete fMap;
 }
 
 //------------------------------------------------------------------------------
@@ -56,6 +186,52 @@ Int_t DelphesFormula::Compile(const char *expression)
     if(*it == ' ' || *it == '\t' || *it == '\r' || *it == '\n' || *it == '\\') continue;
     buffer.Append(*it);
   }
+
+  // find variables by looking at complete identifiers before they are renamed
+  fExpression = buffer;
+  fVariables = 0;
+  for(it = fExpression.Data(); *it;)
+  {
+    if(isalpha(*it) || *it == '_')
+    {
+      TString name;
+      while(isalnum(*it) || *it == '_') name.Append(*it++);
+
+      fVariables |= FindVariable(name);
+    }
+    else
+    {
+      // parameters are filled from the candidate
+      if(*it == '[') fVariables |= kCandidate;
+      ++it;
+    }
+  }
+
+  // find thresholds, as in abs(eta) <= 0.5
+  fSteps.clear();
+  fHasOtherSteps = kFALSE;
+  for(it = fExpression.Data(); *it; ++it)
+  {
+    const char *op = it;
+    UInt_t variable;
+    Double_t value;
+    Bool_t isAbs;
+
+    if(*it != '<' && *it != '>' && !((*it == '=' || *it == '!') && it[1] == '=')) continue;
+    if(it[1] == '=') ++it;
+
+    if(!ParseComparison(fExpression.Data(), op, it + 1, variable, value, isAbs))
+    {
+      fHasOtherSteps = kTRUE;
+      continue;
+    }
+
+    fSteps.push_back(make_pair(variable, value));
+    if(isAbs) fSteps.push_back(make_pair(variable, -value));
+  }
+
+  delete fMap;
+  fMap = nullptr;
   buffer.ReplaceAll("pt", "x");
   buffer.ReplaceAll("eta", "y");
   buffer.ReplaceAll("phi", "z");
@@ -74,6 +250,26 @@ Int_t DelphesFormula::Compile(const char *expression)
   {
     throw runtime_error("Invalid formula.");
   }
+
+#ifdef R__HAS_VECCORE
+  // smooth formulas of the kinematic variables are compiled a second time
+  // for SIMD evaluation; comparisons and parameters filled from candidates
+  // are not supported by the vectorised TFormula backend
+  if(!IsConstant() && !(fVariables & kCandidate) && fSteps.empty() && !fHasOtherSteps)
+  {
+    SetVectorized(kTRUE);
+    if(!IsValid()) SetVectorized(kFALSE);
+  }
+#endif
+
+  // formulas without variables and parameters are evaluated only once
+  if(IsConstant())
+  {
+    Double_t x[4] = {0.0, 0.0, 0.0, 0.0};
+    Double_t params[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+    fConstant = EvalPar(x, params);
+  }
+
   return 0;
 }
 
@@ -81,6 +277,13 @@ Int_t DelphesFormula::Compile(const char *expression)
 
 Double_t DelphesFormula::Eval(Double_t pt, Double_t eta, Double_t phi, Double_t energy, Candidate *candidate)
 {
+  if(IsConstant()) return fConstant;
+
+  if(fMap)
+  {
+    Double_t value = fMapUsesEnergy ? energy : pt;
+    if(fMap->Contains(value, eta)) return fMap->GetValue(value, eta);
+  }
 
   Double_t d0 = 0., dz = 0., ctgTheta = 0., radius = 0., density = 0.;
   if(candidate)
@@ -98,3 +301,154 @@ Double_t DelphesFormula::Eval(Double_t pt, Double_t eta, Double_t phi, Double_t
 }
 
 //------------------------------------------------------------------------------
+
+void DelphesFormula::EvalBatch(Int_t size, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy,
+  Candidate *const *candidates, Double_t *result)
+{
+  Int_t i;
+  Double_t value;
+  Candidate *candidate;
+  Double_t x[4] = {0.0, 0.0, 0.0, 0.0};
+  Double_t params[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+
+  if(IsConstant())
+  {
+    for(i = 0; i < size; ++i) result[i] = fConstant;
+    return;
+  }
+
+  // elements outside the lookup table are collected in fPending
+  fPending.clear();
+  for(i = 0; i < size; ++i)
+  {
+    if(fMap)
+    {
+      value = fMapUsesEnergy ? energy[i] : pt[i];
+      if(fMap->Contains(value, eta[i]))
+      {
+        result[i] = fMap->GetValue(value, eta[i]);
+        continue;
+      }
+    }
+    fPending.push_back(i);
+  }
+
+#ifdef R__HAS_VECCORE
+  if(IsVectorized())
+  {
+    EvalVector(pt, eta, phi, energy, result);
+    return;
+  }
+#endif
+
+  for(i = 0; i < Int_t(fPending.size()); ++i)
+  {
+    Int_t j = fPending[i];
+
+    candidate = candidates ? candidates[j] : nullptr;
+    if(candidate)
+    {
+      params[0] = candidate->D0;
+      params[1] = candidate->DZ;
+      params[2] = candidate->CtgTheta;
+      params[3] = candidate->Position.Pt();
+      params[4] = candidate->ParticleDensity;
+    }
+
+    x[0] = pt[j];
+    x[1] = eta[j];
+    x[2] = phi[j];
+    x[3] = energy[j];
+    result[j] = EvalPar(x, params);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+#ifdef R__HAS_VECCORE
+
+void DelphesFormula::EvalVector(const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy,
+  Double_t *result)
+{
+  const Int_t lanes = vecCore::VectorSize<ROOT::Double_v>();
+  const Int_t size = fPending.size();
+  Double_t params[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+  ROOT::Double_v x[4], y;
+  Int_t i, j, k, last;
+
+  for(i = 0; i < size; i += lanes)
+  {
+    // a partial last block repeats its last element
+    for(j = 0; j < lanes; ++j)
+    {
+      k = fPending[i + j < size ? i + j : size - 1];
+      vecCore::Set(x[0], j, pt[k]);
+      vecCore::Set(x[1], j, eta[k]);
+      vecCore::Set(x[2], j, phi[k]);
+      vecCore::Set(x[3], j, energy[k]);
+    }
+
+    y = EvalParVec(x, params);
+
+    last = i + lanes < size ? lanes : size - i;
+    for(j = 0; j < last; ++j)
+    {
+      result[fPending[i + j]] = vecCore::Get(y, j);
+    }
+  }
+}
+
+#endif
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesFormula::Tabulate(Int_t nx, Double_t xmin, Double_t xmax, Int_t nEta, Double_t etaMin, Double_t etaMax,
+  Bool_t useEnergy, const char *cacheFile)
+{
+  Int_t ix, iy;
+  UInt_t i, allowed = kEta | (useEnergy ? kEnergy : kPT);
+  Double_t x[4] = {0.0, 0.0, 0.0, 0.0};
+  Double_t params[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+  TString key;
+
+  delete fMap;
+  fMap = nullptr;
+
+  if(IsConstant()) return kTRUE;
+  if(fVariables & ~allowed) return kFALSE;
+  if(fHasOtherSteps) return kFALSE;
+
+  fMap = new DelphesResolutionMap;
+  fMap->SetGrid(nx, xmin, xmax, nEta, etaMin, etaMax);
+  fMapUsesEnergy = useEnergy;
+
+  key = (useEnergy ? "energy,eta:" : "pt,eta:") + fExpression;
+
+  if(!cacheFile || !cacheFile[0] || !fMap->Read(cacheFile, key))
+  {
+    for(ix = 0; ix < fMap->GetNodesX(); ++ix)
+    {
+      x[useEnergy ? 3 : 0] = fMap->GetNodeX(ix);
+      for(iy = 0; iy < fMap->GetNodesY(); ++iy)
+      {
+        x[1] = fMap->GetNodeY(iy);
+        fMap->SetNode(ix, iy, EvalPar(x, params));
+      }
+    }
+
+    if(cacheFile && cacheFile[0]) fMap->Write(cacheFile, key);
+  }
+
+  // never interpolate across a threshold
+  for(i = 0; i < fSteps.size(); ++i)
+  {
+    if(fSteps[i].first == kEta)
+      fMap->ExcludeY(fSteps[i].second);
+    else
+      fMap->ExcludeX(fSteps[i].second);
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
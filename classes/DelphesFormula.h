@@ -21,7 +21,15 @@
 
 #include "TFormula.h"
 
+#ifdef R__HAS_VECCORE
+#include "Math/Types.h"
+#endif
+
+#include <utility>
+#include <vector>
+
 class Candidate;
+class DelphesResolutionMap;
 
 class DelphesFormula: public TFormula
 {
@@ -35,6 +43,55 @@ public:
   Int_t Compile(const char *expression);
 
   Double_t Eval(Double_t pt, Double_t eta = 0, Double_t phi = 0, Double_t energy = 0, Candidate *candidate = nullptr);
+
+  // evaluate the formula for arrays of size elements, candidates can be null;
+  // with VecCore support, formulas of the kinematic variables only are
+  // evaluated on SIMD vectors, otherwise element by element
+  void EvalBatch(Int_t size, const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy,
+    Candidate *const *candidates, Double_t *result);
+
+  enum EVariables
+  {
+    kPT = 1,
+    kEta = 2,
+    kPhi = 4,
+    kEnergy = 8,
+    kCandidate = 16
+  };
+
+  // bit mask of the variables used by the formula
+  UInt_t GetVariables() const { return fVariables; }
+
+  Bool_t IsConstant() const { return fVariables == 0; }
+
+  // replace evaluation inside the given range by interpolation in a lookup table
+  // in (pt, eta), or in (energy, eta) if useEnergy is set; the table is read from
+  // cacheFile if it matches, otherwise it is computed and written there;
+  // cells containing a threshold of the formula, as in abs(eta) <= 0.5, are
+  // still evaluated exactly; returns kFALSE if the formula depends on other
+  // variables or compares anything else than a variable with a number
+  Bool_t Tabulate(Int_t nx, Double_t xmin, Double_t xmax, Int_t nEta, Double_t etaMin, Double_t etaMax,
+    Bool_t useEnergy = kFALSE, const char *cacheFile = nullptr);
+
+private:
+#ifdef R__HAS_VECCORE
+  void EvalVector(const Double_t *pt, const Double_t *eta, const Double_t *phi, const Double_t *energy, Double_t *result);
+#endif
+
+  TString fExpression;
+
+  UInt_t fVariables = kPT | kEta | kPhi | kEnergy | kCandidate;
+  Double_t fConstant = 0.0;
+
+  // thresholds found in comparisons of a variable with a number
+  std::vector<std::pair<UInt_t, Double_t> > fSteps;
+  Bool_t fHasOtherSteps = kFALSE;
+
+  DelphesResolutionMap *fMap = nullptr;
+  Bool_t fMapUsesEnergy = kFALSE;
+
+  // indices of the batch elements not found in the lookup table
+  std::vector<Int_t> fPending;
 };
 
 #endif /* DelphesFormula_h */
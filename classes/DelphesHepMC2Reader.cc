@@ -54,7 +54,7 @@ static const int kBufferSize = 16384;
 //---------------------------------------------------------------------------
 
 DelphesHepMC2Reader::DelphesHepMC2Reader() :
-  fInputFile(0), fBuffer(0), fPDG(0),
+  fInputFile(0), fStream(0), fBuffer(0), fPDG(0),
   fVertexCounter(-1), fInCounter(-1), fOutCounter(-1),
   fParticleCounter(0)
 {
@@ -328,6 +328,7 @@ void DelphesHepMC2Reader::AnalyzeEvent(ExRootTreeBranch *branch, long long /*eve
 
   element = static_cast<HepMCEvent *>(branch->NewEntry());
   element->Number = fEventNumber;
+  element->Stream = fStream;
 
   element->ProcessID = fProcessID;
   element->MPI = fMPI;
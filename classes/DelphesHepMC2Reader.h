@@ -46,6 +46,9 @@ public:
 
   void SetInputFile(FILE *inputFile);
 
+  // index of the input stored in the Event branch
+  void SetStream(int stream) { fStream = stream; }
+
   void Clear();
   bool EventReady();
 
@@ -69,6 +72,8 @@ private:
 
   FILE *fInputFile;
 
+  int fStream;
+
   char *fBuffer;
 
   TDatabasePDG *fPDG;
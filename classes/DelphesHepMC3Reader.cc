@@ -345,6 +345,7 @@ void DelphesHepMC3Reader::AnalyzeEvent(ExRootTreeBranch *branch, long long /*eve
 
   element = static_cast<HepMCEvent *>(branch->NewEntry());
   element->Number = fEventNumber;
+  element->Stream = 0;
 
   element->ProcessID = fProcessID;
   element->MPI = fMPI;
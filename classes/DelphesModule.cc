@@ -27,6 +27,7 @@
 #include "classes/DelphesModule.h"
 
 #include "classes/DelphesFactory.h"
+#include "classes/DelphesFormula.h"
 
 #include "ExRootAnalysis/ExRootResult.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
@@ -46,7 +47,7 @@ using namespace std;
 
 DelphesModule::DelphesModule() :
   fTreeWriter(0), fFactory(0), fPlots(0),
-  fPlotFolder(0), fExportFolder(0)
+  fEventAccepted(kTRUE), fEventFilter(kFALSE), fInputReadOnly(kFALSE), fSerialized(kFALSE), fPlotFolder(0), fExportFolder(0)
 {
 }
 
@@ -89,6 +90,8 @@ TObjArray *DelphesModule::ImportArray(const char *name)
     throw runtime_error(message.str());
   }
 
+  fImportedArrays.push_back(object);
+
   return object;
 }
 
@@ -107,6 +110,8 @@ TObjArray *DelphesModule::ExportArray(const char *name)
   array->SetName(name);
   fExportFolder->Add(array);
 
+  fExportedArrays.push_back(array);
+
   return array;
 }
 
@@ -172,3 +177,54 @@ DelphesFactory *DelphesModule::GetFactory()
   }
   return fFactory;
 }
+
+//------------------------------------------------------------------------------
+
+ExRootConfParam DelphesModule::GetWeightVariations()
+{
+  stringstream message;
+
+  // weights of all modules are indexed by the same list of variations
+  if(GetParam("WeightVariations").GetSize() > 0)
+  {
+    message << "WeightVariations should be set as a global parameter, not in module '" << GetName() << "'";
+    throw runtime_error(message.str());
+  }
+
+  return GetConfReader()->GetParam("::WeightVariations");
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesModule::TabulateFormula(DelphesFormula *formula, const char *name, Bool_t useEnergy)
+{
+  stringstream message;
+  ExRootConfParam param = GetParam(name);
+
+  if(param.GetSize() == 0) return;
+
+  if(param.GetSize() != 6)
+  {
+    message << "lookup table '" << name << "' in module '" << GetName() << "'";
+    message << " should be defined as {nx xmin xmax nEta etaMin etaMax}";
+    throw runtime_error(message.str());
+  }
+
+  if(param[0].GetInt() <= 0 || param[3].GetInt() <= 0
+    || !(param[2].GetDouble() > param[1].GetDouble()) || !(param[5].GetDouble() > param[4].GetDouble()))
+  {
+    message << "lookup table '" << name << "' in module '" << GetName() << "'";
+    message << " should have nx, nEta > 0, xmax > xmin and etaMax > etaMin";
+    throw runtime_error(message.str());
+  }
+
+  if(!formula->Tabulate(param[0].GetInt(), param[1].GetDouble(), param[2].GetDouble(),
+       param[3].GetInt(), param[4].GetDouble(), param[5].GetDouble(),
+       useEnergy, GetString(Form("%sCache", name), "")))
+  {
+    message << "formula for lookup table '" << name << "' in module '" << GetName() << "'";
+    message << " should only depend on " << (useEnergy ? "energy" : "pt") << " and eta";
+    message << " and only compare them with numbers";
+    throw runtime_error(message.str());
+  }
+}
@@ -29,6 +29,8 @@
 
 #include "ExRootAnalysis/ExRootTask.h"
 
+#include <vector>
+
 class TClass;
 class TObject;
 class TFolder;
@@ -39,6 +41,7 @@ class ExRootTreeBranch;
 class ExRootTreeWriter;
 
 class DelphesFactory;
+class DelphesFormula;
 
 class DelphesModule: public ExRootTask
 {
@@ -59,13 +62,59 @@ public:
   ExRootResult *GetPlots();
   DelphesFactory *GetFactory();
 
+  Bool_t IsEventAccepted() const { return fEventAccepted; }
+
+  // modules that can reject events, all modules following them
+  // in the execution path wait for them when run concurrently
+  Bool_t IsEventFilter() const { return fEventFilter; }
+
+  // modules that never modify the candidates of their input arrays,
+  // or candidates reached from them, in place; other modules run alone
+  // among the modules working on the same candidates
+  Bool_t IsInputReadOnly() const { return fInputReadOnly; }
+
+  // modules using a library that is not thread safe, such as the bundled
+  // FastJet built without FASTJET_HAVE_LIMITED_THREAD_SAFETY; they never
+  // run concurrently with each other
+  Bool_t IsSerialized() const { return fSerialized; }
+
+  // arrays passed to ImportArray and returned by ExportArray
+  const std::vector<const TObjArray *> &GetImportedArrays() const { return fImportedArrays; }
+  const std::vector<const TObjArray *> &GetExportedArrays() const { return fExportedArrays; }
+
+  // modules that have created branches or added info to the output tree
+  Bool_t HasTreeWriter() const { return fTreeWriter != 0; }
+
 protected:
+  void SetEventAccepted(Bool_t accepted) { fEventAccepted = accepted; }
+  void SetEventFilter(Bool_t filter) { fEventFilter = filter; }
+  void SetInputReadOnly(Bool_t readOnly) { fInputReadOnly = readOnly; }
+  void SetSerialized(Bool_t serialized) { fSerialized = serialized; }
+
+  // names of the efficiency variations set by the global parameter
+  // WeightVariations, modules running with UseWeights store the weights
+  // of the variations after the nominal one in this order
+  ExRootConfParam GetWeightVariations();
+
+  // replace formula evaluation by a lookup table if the parameter called name
+  // is set to {nx xmin xmax nEta etaMin etaMax}, x is pt or energy;
+  // the table is cached in the file given by the parameter name + "Cache"
+  void TabulateFormula(DelphesFormula *formula, const char *name, Bool_t useEnergy = kFALSE);
+
   ExRootTreeWriter *fTreeWriter;
   DelphesFactory *fFactory;
 
 private:
   ExRootResult *fPlots;
 
+  Bool_t fEventAccepted;
+  Bool_t fEventFilter;
+  Bool_t fInputReadOnly;
+  Bool_t fSerialized;
+
+  std::vector<const TObjArray *> fImportedArrays; //!
+  std::vector<const TObjArray *> fExportedArrays; //!
+
   TFolder *fPlotFolder, *fExportFolder;
 
   ClassDef(DelphesModule, 1)
@@ -0,0 +1,268 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class DelphesResolutionMap
+ *
+ *  Dense two-dimensional lookup table for resolutions and efficiencies.
+ *
+ */
+
+#include "classes/DelphesResolutionMap.h"
+#include "classes/DelphesCacheFile.h"
+
+#include "TAxis.h"
+#include "TH2.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+DelphesResolutionMap::DelphesResolutionMap() :
+  fInterpolate(kTRUE),
+  fNX(0), fNY(0),
+  fXMin(0.0), fXMax(0.0), fDX(0.0),
+  fYMin(0.0), fYMax(0.0), fDY(0.0),
+  fUniformX(kTRUE), fUniformY(kTRUE)
+{
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesResolutionMap::SetGrid(Int_t nx, Double_t xmin, Double_t xmax, Int_t ny, Double_t ymin, Double_t ymax)
+{
+  stringstream message;
+
+  if(nx <= 0 || ny <= 0 || !(xmax > xmin) || !(ymax > ymin))
+  {
+    message << "invalid lookup table grid {" << nx << " " << xmin << " " << xmax;
+    message << " " << ny << " " << ymin << " " << ymax << "}";
+    throw runtime_error(message.str());
+  }
+
+  fInterpolate = kTRUE;
+
+  fNX = nx;
+  fNY = ny;
+
+  fXMin = xmin;
+  fXMax = xmax;
+  fDX = (xmax - xmin) / fNX;
+
+  fYMin = ymin;
+  fYMax = ymax;
+  fDY = (ymax - ymin) / fNY;
+
+  fEdgesX.clear();
+  fEdgesY.clear();
+
+  fValues.assign((fNX + 1) * (fNY + 1), 0.0);
+  fExcluded.assign(fNX * fNY, kFALSE);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesResolutionMap::SetHistogram(const TH2 *hist)
+{
+  const TAxis *xAxis = hist->GetXaxis();
+  const TAxis *yAxis = hist->GetYaxis();
+  stringstream message;
+  Int_t ix, iy;
+
+  if(!(xAxis->GetXmax() > xAxis->GetXmin()) || !(yAxis->GetXmax() > yAxis->GetXmin()))
+  {
+    message << "histogram '" << hist->GetName() << "' has an empty axis range";
+    throw runtime_error(message.str());
+  }
+
+  fInterpolate = kFALSE;
+
+  fNX = xAxis->GetNbins();
+  fNY = yAxis->GetNbins();
+
+  fXMin = xAxis->GetXmin();
+  fXMax = xAxis->GetXmax();
+  fDX = (fXMax - fXMin) / fNX;
+
+  fYMin = yAxis->GetXmin();
+  fYMax = yAxis->GetXmax();
+  fDY = (fYMax - fYMin) / fNY;
+
+  fUniformX = !xAxis->IsVariableBinSize();
+  fUniformY = !yAxis->IsVariableBinSize();
+
+  fEdgesX.resize(fNX + 1);
+  for(ix = 0; ix <= fNX; ++ix) fEdgesX[ix] = xAxis->GetBinLowEdge(ix + 1);
+
+  fEdgesY.resize(fNY + 1);
+  for(iy = 0; iy <= fNY; ++iy) fEdgesY[iy] = yAxis->GetBinLowEdge(iy + 1);
+
+  fExcluded.clear();
+
+  fValues.resize((fNX + 2) * (fNY + 2));
+  for(ix = 0; ix < fNX + 2; ++ix)
+  {
+    for(iy = 0; iy < fNY + 2; ++iy)
+    {
+      fValues[ix * (fNY + 2) + iy] = hist->GetBinContent(ix, iy);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesResolutionMap::ExcludeX(Double_t x)
+{
+  Int_t ix, iy;
+
+  if(!fInterpolate) return;
+
+  // a value on a node excludes the cells on both sides
+  for(ix = 0; ix < fNX; ++ix)
+  {
+    if(x < GetNodeX(ix) || x > GetNodeX(ix + 1)) continue;
+    for(iy = 0; iy < fNY; ++iy) fExcluded[ix * fNY + iy] = kTRUE;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesResolutionMap::ExcludeY(Double_t y)
+{
+  Int_t ix, iy;
+
+  if(!fInterpolate) return;
+
+  for(iy = 0; iy < fNY; ++iy)
+  {
+    if(y < GetNodeY(iy) || y > GetNodeY(iy + 1)) continue;
+    for(ix = 0; ix < fNX; ++ix) fExcluded[ix * fNY + iy] = kTRUE;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesResolutionMap::Contains(Double_t x, Double_t y) const
+{
+  Int_t ix, iy;
+
+  if(!fInterpolate) return kTRUE;
+
+  if(x < fXMin || x > fXMax || y < fYMin || y > fYMax) return kFALSE;
+
+  // same cell as in GetValue
+  ix = Int_t((x - fXMin) / fDX);
+  iy = Int_t((y - fYMin) / fDY);
+
+  if(ix >= fNX) ix = fNX - 1;
+  if(iy >= fNY) iy = fNY - 1;
+
+  return !fExcluded[ix * fNY + iy];
+}
+
+//------------------------------------------------------------------------------
+
+Int_t DelphesResolutionMap::FindBin(const vector<Double_t> &edges, Bool_t uniform, Double_t value) const
+{
+  Int_t n = edges.size() - 1;
+
+  if(value < edges.front()) return 0;
+  if(value >= edges.back()) return n + 1;
+
+  // same arithmetic as TAxis::FindBin
+  if(uniform) return 1 + Int_t(n * (value - edges.front()) / (edges.back() - edges.front()));
+
+  return upper_bound(edges.begin(), edges.end(), value) - edges.begin();
+}
+
+//------------------------------------------------------------------------------
+
+Double_t DelphesResolutionMap::GetValue(Double_t x, Double_t y) const
+{
+  Int_t ix, iy;
+  Double_t u, v;
+  const Double_t *node;
+
+  if(!fInterpolate)
+  {
+    ix = x < fXMax ? FindBin(fEdgesX, fUniformX, x) : fNX;
+    iy = FindBin(fEdgesY, fUniformY, y);
+    return fValues[ix * (fNY + 2) + iy];
+  }
+
+  u = (x - fXMin) / fDX;
+  v = (y - fYMin) / fDY;
+
+  ix = Int_t(u);
+  iy = Int_t(v);
+
+  if(ix >= fNX) ix = fNX - 1;
+  if(iy >= fNY) iy = fNY - 1;
+
+  u -= ix;
+  v -= iy;
+
+  node = &fValues[ix * (fNY + 1) + iy];
+
+  return (1.0 - u) * ((1.0 - v) * node[0] + v * node[1])
+    + u * ((1.0 - v) * node[fNY + 1] + v * node[fNY + 2]);
+}
+
+//------------------------------------------------------------------------------
+
+string DelphesResolutionMap::GetCacheKey(const char *key) const
+{
+  stringstream buffer;
+
+  // binning is part of the key, written exactly
+  buffer.precision(17);
+  buffer << key << "|" << fNX << " " << fXMin << " " << fXMax << " " << fNY << " " << fYMin << " " << fYMax;
+
+  return buffer.str();
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesResolutionMap::Read(const char *fileName, const char *key)
+{
+  DelphesCacheFile file;
+
+  if(!fInterpolate || fValues.empty()) return kFALSE;
+
+  if(!file.Open(fileName, GetCacheKey(key).c_str())) return kFALSE;
+  if(file.GetSize() != Long64_t(fValues.size())) return kFALSE;
+
+  fValues.assign(file.GetData(), file.GetData() + file.GetSize());
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesResolutionMap::Write(const char *fileName, const char *key) const
+{
+  // only sampled grids are cached, histograms are read from their own files
+  if(!fInterpolate || fValues.empty()) return kFALSE;
+
+  return DelphesCacheFile::Write(fileName, GetCacheKey(key).c_str(), &fValues[0], fValues.size());
+}
+
+//------------------------------------------------------------------------------
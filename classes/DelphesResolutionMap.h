@@ -0,0 +1,101 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesResolutionMap_h
+#define DelphesResolutionMap_h
+
+/** \class DelphesResolutionMap
+ *
+ *  Dense two-dimensional lookup table for resolutions and efficiencies.
+ *
+ *  The table is either sampled on the nodes of a regular grid and
+ *  interpolated bilinearly, or copied from the bins of a TH2 and read
+ *  back bin by bin.  Sampled tables can be saved to and restored from
+ *  a DelphesCacheFile, tagged with a key describing their source and
+ *  binning.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <string>
+#include <vector>
+
+class TH2;
+
+class DelphesResolutionMap
+{
+public:
+  DelphesResolutionMap();
+
+  // regular grid with (nx + 1) x (ny + 1) nodes, values are interpolated between nodes;
+  // throws runtime_error unless nx, ny > 0, xmax > xmin and ymax > ymin
+  void SetGrid(Int_t nx, Double_t xmin, Double_t xmax, Int_t ny, Double_t ymin, Double_t ymax);
+
+  // copy bin contents, including under- and overflows;
+  // x above the axis range reads the last bin
+  void SetHistogram(const TH2 *hist);
+
+  Int_t GetNodesX() const { return fNX + 1; }
+  Int_t GetNodesY() const { return fNY + 1; }
+
+  Double_t GetNodeX(Int_t ix) const { return fXMin + ix * fDX; }
+  Double_t GetNodeY(Int_t iy) const { return fYMin + iy * fDY; }
+
+  void SetNode(Int_t ix, Int_t iy, Double_t value) { fValues[ix * (fNY + 1) + iy] = value; }
+
+  Bool_t IsEmpty() const { return fValues.empty(); }
+
+  // remove the grid cells containing x or y from the table, for example
+  // because the tabulated function has a step there
+  void ExcludeX(Double_t x);
+  void ExcludeY(Double_t y);
+
+  // kTRUE if (x, y) is covered by the grid and not excluded,
+  // histograms cover everything
+  Bool_t Contains(Double_t x, Double_t y) const;
+
+  Double_t GetValue(Double_t x, Double_t y) const;
+
+  // return kFALSE if the file is missing or was written for another key or binning
+  Bool_t Read(const char *fileName, const char *key);
+
+  Bool_t Write(const char *fileName, const char *key) const;
+
+private:
+  std::string GetCacheKey(const char *key) const;
+
+  Int_t FindBin(const std::vector<Double_t> &edges, Bool_t uniform, Double_t value) const;
+
+  Bool_t fInterpolate;
+
+  Int_t fNX, fNY;
+  Double_t fXMin, fXMax, fDX;
+  Double_t fYMin, fYMax, fDY;
+
+  // bin edges for histograms, searched only for variable bin sizes
+  std::vector<Double_t> fEdgesX, fEdgesY;
+  Bool_t fUniformX, fUniformY;
+
+  std::vector<Double_t> fValues;
+
+  // grid cells where the table must not be used
+  std::vector<Bool_t> fExcluded;
+};
+
+#endif /* DelphesResolutionMap_h */
@@ -0,0 +1,413 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class DelphesTaskGraph
+ *
+ *  Runs the modules of one event concurrently on a pool of threads,
+ *  following the dependencies derived from ImportArray and ExportArray.
+ *
+ *  Two modules sharing an array, either as input or as output, run in
+ *  the order of the execution path, since modules may update the
+ *  candidates of their input arrays.  The same candidates can be reached
+ *  from several arrays (stableParticles and allParticles, arrays passed
+ *  through filters, constituents), so modules connected by their arrays
+ *  form a group, all arrays of the reader belonging to the same group,
+ *  and a module that is not declared input read-only runs in the order
+ *  of the execution path with all modules of its group.  Modules
+ *  following an event filter in the execution path wait for it and are
+ *  skipped if it rejects the event.  Serialized modules run in the order
+ *  of the execution path with each other.  Tasks that are not Delphes
+ *  modules run alone, unless the arrays they read are given.
+ *
+ *  Each module draws random numbers from its own generator, seeded from
+ *  the seed of the graph and the position of the module in the execution
+ *  path, so that results do not depend on the order of execution.
+ *
+ */
+
+#include "classes/DelphesTaskGraph.h"
+#include "classes/DelphesModule.h"
+
+#include "TRandom3.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+// generator of the module running on the current thread
+static thread_local TRandom *gTaskRandom = 0;
+
+/** \class DelphesTaskRandom
+ *
+ *  Installed as gRandom while the graph is running, forwards the whole
+ *  TRandom interface to the generator of the module running on the
+ *  calling thread, or to the previous gRandom outside of the modules.
+ *
+ */
+
+class DelphesTaskRandom: public TRandom
+{
+public:
+  DelphesTaskRandom(TRandom *random) :
+    fRandom(random) {}
+
+  virtual Int_t Binomial(Int_t ntot, Double_t prob) { return Current()->Binomial(ntot, prob); }
+  virtual Double_t BreitWigner(Double_t mean = 0, Double_t gamma = 1) { return Current()->BreitWigner(mean, gamma); }
+  virtual void Circle(Double_t &x, Double_t &y, Double_t r) { Current()->Circle(x, y, r); }
+  virtual Double_t Exp(Double_t tau) { return Current()->Exp(tau); }
+  virtual Double_t Gaus(Double_t mean = 0, Double_t sigma = 1) { return Current()->Gaus(mean, sigma); }
+  virtual UInt_t GetSeed() const { return Current()->GetSeed(); }
+  virtual UInt_t Integer(UInt_t imax) { return Current()->Integer(imax); }
+  virtual Double_t Landau(Double_t mean = 0, Double_t sigma = 1) { return Current()->Landau(mean, sigma); }
+  virtual Int_t Poisson(Double_t mean) { return Current()->Poisson(mean); }
+  virtual Double_t PoissonD(Double_t mean) { return Current()->PoissonD(mean); }
+  virtual void Rannor(Float_t &a, Float_t &b) { Current()->Rannor(a, b); }
+  virtual void Rannor(Double_t &a, Double_t &b) { Current()->Rannor(a, b); }
+  virtual void ReadRandom(const char *filename) { Current()->ReadRandom(filename); }
+  virtual void SetSeed(ULong_t seed = 0) { Current()->SetSeed(seed); }
+  virtual Double_t Rndm() { return Current()->Rndm(); }
+  virtual void RndmArray(Int_t n, Float_t *array) { Current()->RndmArray(n, array); }
+  virtual void RndmArray(Int_t n, Double_t *array) { Current()->RndmArray(n, array); }
+  virtual void Sphere(Double_t &x, Double_t &y, Double_t &z, Double_t r) { Current()->Sphere(x, y, z, r); }
+  virtual Double_t Uniform(Double_t x1 = 1) { return Current()->Uniform(x1); }
+  virtual Double_t Uniform(Double_t x1, Double_t x2) { return Current()->Uniform(x1, x2); }
+  virtual void WriteRandom(const char *filename) const { Current()->WriteRandom(filename); }
+
+private:
+  TRandom *Current() const { return gTaskRandom ? gTaskRandom : fRandom; }
+
+  TRandom *fRandom;
+};
+
+//------------------------------------------------------------------------------
+
+DelphesTaskGraph::DelphesTaskGraph() :
+  fRandom(0), fSavedRandom(0), fDone(0), fRejected(-1), fStop(kFALSE)
+{
+}
+
+//------------------------------------------------------------------------------
+
+DelphesTaskGraph::~DelphesTaskGraph()
+{
+  vector<Task>::iterator itTasks;
+  vector<thread>::iterator itThreads;
+
+  {
+    lock_guard<mutex> lock(fMutex);
+    fStop = kTRUE;
+  }
+  fCondition.notify_all();
+
+  for(itThreads = fThreads.begin(); itThreads != fThreads.end(); ++itThreads)
+  {
+    itThreads->join();
+  }
+
+  if(fRandom)
+  {
+    if(gRandom == fRandom) gRandom = fSavedRandom;
+    delete fRandom;
+  }
+
+  for(itTasks = fTasks.begin(); itTasks != fTasks.end(); ++itTasks)
+  {
+    delete itTasks->random;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesTaskGraph::AddTask(ExRootTask *task)
+{
+  Task entry;
+
+  entry.task = task;
+  entry.module = dynamic_cast<DelphesModule *>(task);
+  entry.random = 0;
+  entry.known = entry.module != 0;
+  entry.readOnly = kFALSE;
+  entry.serialized = kFALSE;
+  entry.filter = kFALSE;
+  entry.nPrevious = 0;
+  entry.waiting = 0;
+
+  if(entry.module)
+  {
+    entry.readOnly = entry.module->IsInputReadOnly();
+    entry.serialized = entry.module->IsSerialized();
+    entry.filter = entry.module->IsEventFilter();
+    entry.imported = entry.module->GetImportedArrays();
+    entry.exported = entry.module->GetExportedArrays();
+  }
+
+  fTasks.push_back(entry);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesTaskGraph::AddTask(ExRootTask *task, const vector<const TObjArray *> &imported)
+{
+  AddTask(task);
+
+  fTasks.back().known = kTRUE;
+  fTasks.back().readOnly = kTRUE;
+  fTasks.back().imported = imported;
+}
+
+//------------------------------------------------------------------------------
+
+static Int_t FindGroup(vector<Int_t> &groups, Int_t i)
+{
+  while(groups[i] != i)
+  {
+    groups[i] = groups[groups[i]];
+    i = groups[i];
+  }
+  return i;
+}
+
+//------------------------------------------------------------------------------
+
+static Bool_t ShareArrays(const vector<const TObjArray *> &a, const vector<const TObjArray *> &b)
+{
+  vector<const TObjArray *>::const_iterator itArray;
+
+  for(itArray = a.begin(); itArray != a.end(); ++itArray)
+  {
+    if(find(b.begin(), b.end(), *itArray) != b.end()) return kTRUE;
+  }
+
+  return kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesTaskGraph::Start(Int_t numberOfThreads, UInt_t seed)
+{
+  Int_t i, j, size;
+  Bool_t depends;
+  set<const TObjArray *> exported;
+  map<const TObjArray *, Int_t> users;
+  map<const TObjArray *, Int_t>::iterator itUsers;
+  vector<const TObjArray *> arrays;
+  vector<const TObjArray *>::iterator itArrays;
+  vector<Int_t> groups;
+  const TObjArray *array;
+
+  size = fTasks.size();
+
+  // group the modules connected by their arrays, the arrays that are not
+  // exported by any module come from the reader and count as one array
+
+  for(i = 0; i < size; ++i)
+  {
+    exported.insert(fTasks[i].exported.begin(), fTasks[i].exported.end());
+  }
+
+  for(i = 0; i < size; ++i)
+  {
+    groups.push_back(i);
+
+    arrays = fTasks[i].imported;
+    arrays.insert(arrays.end(), fTasks[i].exported.begin(), fTasks[i].exported.end());
+
+    for(itArrays = arrays.begin(); itArrays != arrays.end(); ++itArrays)
+    {
+      array = exported.count(*itArrays) ? *itArrays : 0;
+      itUsers = users.find(array);
+      if(itUsers == users.end())
+      {
+        users.insert(make_pair(array, i));
+      }
+      else
+      {
+        groups[FindGroup(groups, i)] = FindGroup(groups, itUsers->second);
+      }
+    }
+  }
+
+  // dependencies between tasks i < j of the execution path
+
+  for(i = 0; i < size; ++i)
+  {
+    Task &first = fTasks[i];
+    for(j = i + 1; j < size; ++j)
+    {
+      Task &second = fTasks[j];
+
+      if(!first.known || !second.known || first.filter)
+      {
+        depends = kTRUE;
+      }
+      else
+      {
+        depends = ShareArrays(first.exported, second.imported)
+          || ShareArrays(first.imported, second.imported)
+          || ShareArrays(first.imported, second.exported);
+
+        // candidates modified in place can be reached from other arrays
+        if(!first.readOnly || !second.readOnly)
+        {
+          depends = depends || FindGroup(groups, i) == FindGroup(groups, j);
+        }
+
+        // modules sharing a library that is not thread safe
+        depends = depends || (first.serialized && second.serialized);
+      }
+
+      if(depends)
+      {
+        fTasks[i].next.push_back(j);
+        ++fTasks[j].nPrevious;
+      }
+    }
+
+    // a random seed of 0 gives a different seed to every generator
+    fTasks[i].random = new TRandom3(seed > 0 ? seed + i + 1 : 0);
+  }
+
+  fSavedRandom = gRandom;
+  fRandom = new DelphesTaskRandom(fSavedRandom);
+  gRandom = fRandom;
+
+  for(i = 1; i < numberOfThreads; ++i)
+  {
+    fThreads.push_back(thread(&DelphesTaskGraph::Run, this));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesTaskGraph::Process()
+{
+  Int_t i, size;
+  exception_ptr error;
+
+  unique_lock<mutex> lock(fMutex);
+
+  size = fTasks.size();
+  for(i = 0; i < size; ++i)
+  {
+    fTasks[i].waiting = fTasks[i].nPrevious;
+    if(fTasks[i].waiting == 0) fReady.push(i);
+  }
+
+  fDone = 0;
+  fRejected = -1;
+  fError = nullptr;
+
+  fCondition.notify_all();
+
+  while(fDone < size)
+  {
+    RunTasks(lock);
+    if(fDone < size) fCondition.wait(lock);
+  }
+
+  error = fError;
+  fError = nullptr;
+
+  lock.unlock();
+
+  if(error) rethrow_exception(error);
+
+  return fRejected < 0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesTaskGraph::Run()
+{
+  unique_lock<mutex> lock(fMutex);
+
+  while(!fStop)
+  {
+    RunTasks(lock);
+    fCondition.wait(lock);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesTaskGraph::RunTasks(unique_lock<mutex> &lock)
+{
+  Int_t index;
+  Bool_t skip;
+  vector<Int_t>::iterator itNext;
+
+  while(!fReady.empty())
+  {
+    index = fReady.top();
+    fReady.pop();
+
+    Task &task = fTasks[index];
+
+    // tasks following a rejecting filter are skipped, as in the
+    // sequential mode, and so are all tasks after an error
+    skip = (fRejected >= 0 && index > fRejected) || fError || !task.task->IsActive();
+
+    lock.unlock();
+
+    if(!skip)
+    {
+      try
+      {
+        if(task.module)
+        {
+          gTaskRandom = task.random;
+          task.module->Process();
+          gTaskRandom = 0;
+        }
+        else
+        {
+          task.task->ProcessTask();
+        }
+      }
+      catch(...)
+      {
+        gTaskRandom = 0;
+        lock.lock();
+        if(!fError) fError = current_exception();
+        lock.unlock();
+      }
+    }
+
+    lock.lock();
+
+    if(!skip && task.module && !task.module->IsEventAccepted())
+    {
+      if(fRejected < 0 || index < fRejected) fRejected = index;
+    }
+
+    for(itNext = task.next.begin(); itNext != task.next.end(); ++itNext)
+    {
+      if(--fTasks[*itNext].waiting == 0) fReady.push(*itNext);
+    }
+
+    ++fDone;
+
+    fCondition.notify_all();
+  }
+}
+
+//------------------------------------------------------------------------------
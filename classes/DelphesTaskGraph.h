@@ -0,0 +1,114 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesTaskGraph_h
+#define DelphesTaskGraph_h
+
+/** \class DelphesTaskGraph
+ *
+ *  Runs the modules of one event concurrently on a pool of threads,
+ *  following the dependencies derived from ImportArray and ExportArray.
+ *
+ *  Two modules sharing an array, either as input or as output, run in
+ *  the order of the execution path, since modules may update the
+ *  candidates of their input arrays.  The same candidates can be reached
+ *  from several arrays (stableParticles and allParticles, arrays passed
+ *  through filters, constituents), so modules connected by their arrays
+ *  form a group, all arrays of the reader belonging to the same group,
+ *  and a module that is not declared input read-only runs in the order
+ *  of the execution path with all modules of its group.  Modules
+ *  following an event filter in the execution path wait for it and are
+ *  skipped if it rejects the event.  Serialized modules run in the order
+ *  of the execution path with each other.  Tasks that are not Delphes
+ *  modules run alone, unless the arrays they read are given.
+ *
+ *  Each module draws random numbers from its own generator, seeded from
+ *  the seed of the graph and the position of the module in the execution
+ *  path, so that results do not depend on the order of execution.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+class TObjArray;
+class TRandom;
+
+class ExRootTask;
+class DelphesModule;
+
+class DelphesTaskGraph
+{
+public:
+  DelphesTaskGraph();
+  ~DelphesTaskGraph();
+
+  // tasks are added in the order of the execution path
+  void AddTask(ExRootTask *task);
+
+  // task that is not a module and only reads the candidates of arrays
+  void AddTask(ExRootTask *task, const std::vector<const TObjArray *> &imported);
+
+  // build the dependencies and start numberOfThreads - 1 threads,
+  // the thread calling Process also runs modules
+  void Start(Int_t numberOfThreads, UInt_t seed);
+
+  // run all tasks for the current event, return false if the event is rejected
+  Bool_t Process();
+
+private:
+  struct Task
+  {
+    ExRootTask *task;
+    DelphesModule *module;
+    TRandom *random;
+    // tasks with unknown arrays run alone
+    Bool_t known, readOnly, serialized, filter;
+    std::vector<const TObjArray *> imported, exported;
+    std::vector<Int_t> next;
+    Int_t nPrevious, waiting;
+  };
+
+  void Run();
+  void RunTasks(std::unique_lock<std::mutex> &lock);
+
+  std::vector<Task> fTasks;
+
+  TRandom *fRandom, *fSavedRandom;
+
+  std::vector<std::thread> fThreads;
+
+  std::mutex fMutex;
+  std::condition_variable fCondition;
+
+  // ready tasks, the first one in the execution path first
+  std::priority_queue<Int_t, std::vector<Int_t>, std::greater<Int_t> > fReady;
+
+  Int_t fDone, fRejected;
+  Bool_t fStop;
+
+  std::exception_ptr fError;
+};
+
+#endif /* DelphesTaskGraph_h */
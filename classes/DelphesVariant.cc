@@ -0,0 +1,318 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class DelphesVariant
+ *
+ *  Alternative tail of the execution path, sharing the modules of the
+ *  main execution path up to its fork module.
+ *
+ *  When the shared modules accept the event, the arrays they export and
+ *  the variant imports are copied, so that modules updating candidates
+ *  of their input arrays do not affect the main execution path or other
+ *  variants.  Copies get unique IDs of their own, each original is copied
+ *  once and constituents that are copied as well are replaced by their
+ *  copies, so that references written to the variant tree are resolved.
+ *
+ *  The variant tree is filled and cleared with the main tree and also
+ *  holds the branches written by the reader (Event, Weight).  Modules of
+ *  the variant draw random numbers from the generator of the variant.
+ *
+ */
+
+#include "classes/DelphesVariant.h"
+#include "classes/DelphesClasses.h"
+#include "classes/DelphesFactory.h"
+#include "classes/DelphesModule.h"
+
+#include "ExRootAnalysis/ExRootTask.h"
+#include "ExRootAnalysis/ExRootTreeWriter.h"
+
+#include "TFile.h"
+#include "TFolder.h"
+#include "TObjArray.h"
+#include "TRandom3.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+/** \class DelphesVariantFork
+ *
+ *  Copies the shared arrays of a variant, added to DelphesTaskGraph
+ *  right after the fork module.
+ *
+ */
+
+class DelphesVariantFork: public ExRootTask
+{
+public:
+  DelphesVariantFork(DelphesVariant *variant) :
+    fVariant(variant) {}
+
+  virtual void ProcessTask() { fVariant->Fork(); }
+
+private:
+  DelphesVariant *fVariant;
+};
+
+//------------------------------------------------------------------------------
+
+DelphesVariant::DelphesVariant(const char *name, Int_t fork, DelphesFactory *factory) :
+  fName(name), fFork(fork), fFactory(factory), fFolder(0), fExportFolder(0),
+  fTreeWriter(0), fFile(0), fRandom(0), fForkTask(0), fForked(kFALSE)
+{
+  fFolder = new TFolder(name, "");
+  fExportFolder = fFolder->AddFolder("Export", "");
+
+  fFolder->Add(fFactory);
+}
+
+//------------------------------------------------------------------------------
+
+DelphesVariant::~DelphesVariant()
+{
+  vector<ExRootTask *>::iterator itTasks;
+
+  for(itTasks = fTasks.begin(); itTasks != fTasks.end(); ++itTasks)
+  {
+    delete *itTasks;
+  }
+
+  delete fForkTask;
+  delete fRandom;
+
+  if(fTreeWriter) delete fTreeWriter;
+
+  if(fFile)
+  {
+    fFile->Close();
+    delete fFile;
+  }
+
+  fFolder->Clear();
+  delete fFolder;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVariant::SetTreeWriter(ExRootTreeWriter *treeWriter, TFile *file)
+{
+  fTreeWriter = treeWriter;
+  fTreeWriter->SetName("TreeWriter");
+  fFolder->Add(fTreeWriter);
+  fFile = file;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVariant::SetRandomSeed(UInt_t seed)
+{
+  delete fRandom;
+  fRandom = new TRandom3(seed);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVariant::AddArray(const char *moduleName, const TObjArray *source)
+{
+  TFolder *folder;
+  TObjArray *array;
+
+  folder = static_cast<TFolder *>(fExportFolder->FindObject(moduleName));
+  if(!folder) folder = fExportFolder->AddFolder(moduleName, "");
+
+  array = fFactory->NewPermanentArray();
+  array->SetName(source->GetName());
+  folder->Add(array);
+
+  fArrays.push_back(make_pair(array, source));
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVariant::AddTask(ExRootTask *task)
+{
+  task->SetFolder(fFolder);
+  task->SetConfPrefix(fName + "::");
+  fTasks.push_back(task);
+}
+
+//------------------------------------------------------------------------------
+
+ExRootTask *DelphesVariant::GetForkTask()
+{
+  if(!fForkTask) fForkTask = new DelphesVariantFork(this);
+  return fForkTask;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVariant::Init()
+{
+  vector<ExRootTask *>::iterator itTasks;
+  vector<pair<TObjArray *, const TObjArray *> >::iterator itArrays;
+  vector<const TObjArray *> imported;
+  DelphesModule *module;
+  Bool_t all = kFALSE;
+
+  for(itTasks = fTasks.begin(); itTasks != fTasks.end(); ++itTasks)
+  {
+    (*itTasks)->InitTask();
+
+    // arrays used by other tasks are not known
+    module = dynamic_cast<DelphesModule *>(*itTasks);
+    if(module)
+    {
+      imported.insert(imported.end(), module->GetImportedArrays().begin(), module->GetImportedArrays().end());
+    }
+    else
+    {
+      all = kTRUE;
+    }
+  }
+
+  // only arrays imported by the variant are copied
+
+  for(itArrays = fArrays.begin(); itArrays != fArrays.end(); ++itArrays)
+  {
+    if(all || find(imported.begin(), imported.end(), itArrays->first) != imported.end())
+    {
+      fCopiedArrays.push_back(*itArrays);
+      fSharedArrays.push_back(itArrays->second);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVariant::Fork()
+{
+  vector<pair<TObjArray *, const TObjArray *> >::iterator itArrays;
+  map<const TObject *, TObject *>::iterator itClones, itConstituent;
+  TObject *object, *clone;
+  Candidate *candidate;
+  TObjArray *constituents;
+  Int_t i;
+
+  // each original is copied once, also if several arrays hold it
+  fClones.clear();
+  for(itArrays = fCopiedArrays.begin(); itArrays != fCopiedArrays.end(); ++itArrays)
+  {
+    TIter itObjects(itArrays->second);
+    itArrays->first->Clear();
+    while((object = itObjects.Next()))
+    {
+      itClones = fClones.find(object);
+      if(itClones == fClones.end())
+      {
+        clone = object->Clone();
+        fClones[object] = clone;
+      }
+      else
+      {
+        clone = itClones->second;
+      }
+      itArrays->first->Add(clone);
+    }
+  }
+
+  // constituents that are copied as well are replaced by their copies
+  for(itClones = fClones.begin(); itClones != fClones.end(); ++itClones)
+  {
+    candidate = static_cast<Candidate *>(itClones->second);
+    constituents = candidate->GetCandidates();
+    for(i = 0; i < constituents->GetEntriesFast(); ++i)
+    {
+      itConstituent = fClones.find(constituents->At(i));
+      if(itConstituent != fClones.end()) constituents->AddAt(itConstituent->second, i);
+    }
+  }
+
+  fForked = kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesVariant::Process()
+{
+  vector<ExRootTask *>::iterator itTasks;
+  DelphesModule *module;
+  TRandom *random;
+  Bool_t accepted = kTRUE;
+
+  // the shared modules have rejected the event
+  if(!fForked)
+  {
+    fTreeWriter->SetAccepted(kFALSE);
+    return kFALSE;
+  }
+
+  // the main execution path does not depend on the random numbers
+  // drawn by the variant
+  random = gRandom;
+  if(fRandom) gRandom = fRandom;
+
+  for(itTasks = fTasks.begin(); itTasks != fTasks.end(); ++itTasks)
+  {
+    (*itTasks)->ProcessTask();
+
+    // skip remaining modules if the event has been rejected
+    module = dynamic_cast<DelphesModule *>(*itTasks);
+    if(module && !module->IsEventAccepted())
+    {
+      accepted = kFALSE;
+      break;
+    }
+  }
+
+  gRandom = random;
+
+  fTreeWriter->SetAccepted(accepted);
+
+  return accepted;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVariant::Clear()
+{
+  fForked = kFALSE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVariant::Finish()
+{
+  vector<ExRootTask *>::iterator itTasks;
+
+  for(itTasks = fTasks.begin(); itTasks != fTasks.end(); ++itTasks)
+  {
+    (*itTasks)->FinishTask();
+  }
+
+  // trees sharing the main output file are written with it, the tree
+  // writer is filled by the main one until the variant is deleted
+  if(fFile) fTreeWriter->Write();
+}
+
+//------------------------------------------------------------------------------
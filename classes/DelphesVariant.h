@@ -0,0 +1,122 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesVariant_h
+#define DelphesVariant_h
+
+/** \class DelphesVariant
+ *
+ *  Alternative tail of the execution path, sharing the modules of the
+ *  main execution path up to its fork module.
+ *
+ *  When the shared modules accept the event, the arrays they export and
+ *  the variant imports are copied, so that modules updating candidates
+ *  of their input arrays do not affect the main execution path or other
+ *  variants.  Copies get unique IDs of their own, each original is copied
+ *  once and constituents that are copied as well are replaced by their
+ *  copies, so that references written to the variant tree are resolved.
+ *
+ *  The variant tree is filled and cleared with the main tree and also
+ *  holds the branches written by the reader (Event, Weight).  Modules of
+ *  the variant draw random numbers from the generator of the variant.
+ *
+ */
+
+#include "TString.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+class TFile;
+class TFolder;
+class TObject;
+class TObjArray;
+class TRandom;
+
+class ExRootTask;
+class ExRootTreeWriter;
+
+class DelphesFactory;
+
+class DelphesVariant
+{
+public:
+  DelphesVariant(const char *name, Int_t fork, DelphesFactory *factory);
+  ~DelphesVariant();
+
+  const char *GetName() const { return fName; }
+
+  // index of the last shared module in the main execution path
+  Int_t GetFork() const { return fFork; }
+
+  TFolder *GetFolder() const { return fFolder; }
+
+  // the file is owned, written and closed by the variant if not null
+  void SetTreeWriter(ExRootTreeWriter *treeWriter, TFile *file);
+
+  // a seed of 0 gives a different seed to every run
+  void SetRandomSeed(UInt_t seed);
+
+  // make an array of the shared modules available to the variant
+  void AddArray(const char *moduleName, const TObjArray *source);
+
+  // tasks are added in the order of the execution path
+  void AddTask(ExRootTask *task);
+
+  // arrays of the shared modules imported by the variant
+  const std::vector<const TObjArray *> &GetSharedArrays() const { return fSharedArrays; }
+
+  // task copying the shared arrays, run by DelphesTaskGraph after the fork
+  ExRootTask *GetForkTask();
+
+  void Init();
+  void Fork();
+  // run the modules of the variant, return false if the event is rejected
+  Bool_t Process();
+  void Finish();
+
+  void Clear();
+
+private:
+  TString fName;
+  Int_t fFork;
+
+  DelphesFactory *fFactory;
+
+  TFolder *fFolder, *fExportFolder;
+
+  ExRootTreeWriter *fTreeWriter;
+  TFile *fFile;
+
+  TRandom *fRandom;
+
+  // variant arrays and the arrays they are copied from
+  std::vector<std::pair<TObjArray *, const TObjArray *> > fArrays, fCopiedArrays;
+  std::vector<const TObjArray *> fSharedArrays;
+
+  // copies of the candidates of the copied arrays
+  std::map<const TObject *, TObject *> fClones;
+
+  std::vector<ExRootTask *> fTasks;
+  ExRootTask *fForkTask;
+
+  Bool_t fForked;
+};
+
+#endif /* DelphesVariant_h */
@@ -0,0 +1,586 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class DelphesVertexFit
+ *
+ *  Iterative vertex fit of helical tracks, following the algorithm of
+ *  external/TrackCovariance/VertexFit by F. Bedeschi.
+ *
+ *  Track parameters (D0, phi0, C, DZ, ctg(theta)) and their covariance are
+ *  expressed in mm.  All work arrays have fixed sizes and are kept between
+ *  fits, so that a single object can fit any number of vertices per event
+ *  without allocating memory.
+ *
+ */
+
+#include "classes/DelphesVertexFit.h"
+
+#include "classes/DelphesClasses.h"
+
+#include "TMath.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+namespace
+{
+// inverse of a symmetric 3x3 matrix, normalized to unit diagonal first
+// as in TrkUtil::RegInv; returns a null matrix if M is singular
+
+Bool_t Invert(const Double_t M[3][3], Double_t Minv[3][3])
+{
+  Double_t n[3], R[3][3], det;
+  Int_t i, j;
+
+  for(i = 0; i < 3; ++i)
+  {
+    n[i] = (M[i][i] != 0.0) ? 1.0 / TMath::Sqrt(TMath::Abs(M[i][i])) : 1.0;
+  }
+
+  for(i = 0; i < 3; ++i)
+  {
+    for(j = 0; j < 3; ++j)
+    {
+      R[i][j] = n[i] * M[i][j] * n[j];
+    }
+  }
+
+  Minv[0][0] = R[1][1] * R[2][2] - R[1][2] * R[2][1];
+  Minv[0][1] = R[0][2] * R[2][1] - R[0][1] * R[2][2];
+  Minv[0][2] = R[0][1] * R[1][2] - R[0][2] * R[1][1];
+  Minv[1][1] = R[0][0] * R[2][2] - R[0][2] * R[2][0];
+  Minv[1][2] = R[0][2] * R[1][0] - R[0][0] * R[1][2];
+  Minv[2][2] = R[0][0] * R[1][1] - R[0][1] * R[1][0];
+
+  det = R[0][0] * Minv[0][0] + R[0][1] * (R[1][2] * R[2][0] - R[1][0] * R[2][2]) + R[0][2] * (R[1][0] * R[2][1] - R[1][1] * R[2][0]);
+
+  if(det == 0.0)
+  {
+    for(i = 0; i < 3; ++i)
+    {
+      for(j = 0; j < 3; ++j) Minv[i][j] = 0.0;
+    }
+    return kFALSE;
+  }
+
+  for(i = 0; i < 3; ++i)
+  {
+    for(j = i; j < 3; ++j)
+    {
+      Minv[i][j] *= n[i] * n[j] / det;
+      Minv[j][i] = Minv[i][j];
+    }
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+// track position at phase s, see TrkUtil::Xtrack
+
+void Helix(const Double_t *par, Double_t s, Double_t *x)
+{
+  Double_t sp = TMath::Sin(par[1]), cp = TMath::Cos(par[1]);
+  Double_t sps = TMath::Sin(s + par[1]), cps = TMath::Cos(s + par[1]);
+  Double_t r = 0.5 / par[2];
+
+  x[0] = -par[0] * sp + (sps - sp) * r;
+  x[1] = par[0] * cp - (cps - cp) * r;
+  x[2] = par[3] + par[4] * s * r;
+}
+
+//------------------------------------------------------------------------------
+
+// derivatives of the track position wrt parameters and phase,
+// see TrkUtil::derXdPar and TrkUtil::derXds
+
+void Derivatives(const Double_t *par, Double_t s, Double_t A[3][5], Double_t *a)
+{
+  Double_t sp = TMath::Sin(par[1]), cp = TMath::Cos(par[1]);
+  Double_t sps = TMath::Sin(s + par[1]), cps = TMath::Cos(s + par[1]);
+  Double_t r = 0.5 / par[2];
+  Double_t r2 = r / par[2];
+
+  A[0][0] = -sp;
+  A[1][0] = cp;
+  A[2][0] = 0.0;
+
+  A[0][1] = -par[0] * cp + (cps - cp) * r;
+  A[1][1] = -par[0] * sp + (sps - sp) * r;
+  A[2][1] = 0.0;
+
+  A[0][2] = -(sps - sp) * r2;
+  A[1][2] = (cps - cp) * r2;
+  A[2][2] = -par[4] * s * r2;
+
+  A[0][3] = 0.0;
+  A[1][3] = 0.0;
+  A[2][3] = 1.0;
+
+  A[0][4] = 0.0;
+  A[1][4] = 0.0;
+  A[2][4] = s * r;
+
+  a[0] = cps * r;
+  a[1] = sps * r;
+  a[2] = par[4] * r;
+}
+} // namespace
+
+//------------------------------------------------------------------------------
+
+DelphesVertexFit::DelphesVertexFit() :
+  fConstraint(kFALSE), fStartRadius(-1.0), fNTracks(0), fNIterations(0), fChi2(0.0)
+{
+  Int_t i, j;
+  for(i = 0; i < 3; ++i)
+  {
+    fX[i] = 0.0;
+    fXCst[i] = 0.0;
+    for(j = 0; j < 3; ++j)
+    {
+      fCovX[i][j] = 0.0;
+      fCovCst[i][j] = 0.0;
+      fCovCstInv[i][j] = 0.0;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVertexFit::Clear()
+{
+  fNTracks = 0;
+  fNIterations = 0;
+  fChi2 = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVertexFit::AddTrack(const Double_t *par, const Double_t *cov)
+{
+  Int_t i, j;
+
+  if(fNTracks == Int_t(fTracks.size())) fTracks.resize(fNTracks + 1);
+
+  Track &track = fTracks[fNTracks++];
+
+  for(i = 0; i < 5; ++i)
+  {
+    track.par[i] = par[i];
+    for(j = 0; j < 5; ++j)
+    {
+      track.cov[i][j] = cov[i * 5 + j];
+    }
+  }
+  track.chi2 = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVertexFit::AddTrack(const Candidate *track)
+{
+  Double_t par[5], cov[25];
+
+  par[0] = track->D0;
+  par[1] = track->Phi;
+  par[2] = track->C;
+  par[3] = track->DZ;
+  par[4] = track->CtgTheta;
+
+  ConvertCovariance(track, cov);
+
+  AddTrack(par, cov);
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVertexFit::RemoveTrack(Int_t i)
+{
+  // keep the order of the remaining tracks
+  for(--fNTracks; i < fNTracks; ++i)
+  {
+    fTracks[i] = fTracks[i + 1];
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVertexFit::ConvertCovariance(const Candidate *track, Double_t *cov)
+{
+  // TrackCovariance stores the covariance matrix in m
+  static const Double_t scale[5] = {1.0e3, 1.0, 1.0e-3, 1.0e3, 1.0};
+  Int_t i, j;
+
+  for(i = 0; i < 5; ++i)
+  {
+    for(j = 0; j < 5; ++j)
+    {
+      cov[i * 5 + j] = track->TrackCovariance(i, j) * scale[i] * scale[j];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVertexFit::SetConstraint(const Double_t *x, const Double_t *cov)
+{
+  Int_t i, j;
+
+  for(i = 0; i < 3; ++i)
+  {
+    fXCst[i] = x[i];
+    for(j = 0; j < 3; ++j)
+    {
+      fCovCst[i][j] = cov[i * 3 + j];
+    }
+  }
+
+  Invert(fCovCst, fCovCstInv);
+  fConstraint = kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVertexFit::FirstPass()
+{
+  // fast vertex estimate at fixed phases, see VertexFit::VtxFitNoSteer;
+  // a, a2 and x0 temporarily hold C^-1*n, n'*C^-1*n and the start position
+
+  Double_t A[3][5], n[3], C[3][3], Cinv[3][3], D[3][3], Dx[3], Dinv[3][3];
+  Double_t Dd, r2, diff[3], sum;
+  Int_t i, j, k, l, m;
+
+  for(i = 0; i < 3; ++i)
+  {
+    Dx[i] = 0.0;
+    for(j = 0; j < 3; ++j) D[i][j] = 0.0;
+  }
+
+  for(m = 0; m < fNTracks; ++m)
+  {
+    Track &track = fTracks[m];
+    const Double_t *par = track.par;
+
+    track.s = 0.0;
+    if(fStartRadius > TMath::Abs(par[0]))
+    {
+      r2 = (fStartRadius * fStartRadius - par[0] * par[0]) / (1.0 + 2.0 * par[2] * par[0]);
+      track.s = 2.0 * TMath::ASin(par[2] * TMath::Sqrt(r2));
+    }
+
+    Helix(par, track.s, track.x0);
+    Derivatives(par, track.s, A, n);
+
+    // C = A*Cov*A'
+    for(i = 0; i < 3; ++i)
+    {
+      for(j = i; j < 3; ++j)
+      {
+        sum = 0.0;
+        for(k = 0; k < 5; ++k)
+        {
+          if(A[i][k] == 0.0) continue;
+          for(l = 0; l < 5; ++l) sum += A[i][k] * track.cov[k][l] * A[j][l];
+        }
+        C[i][j] = C[j][i] = sum;
+      }
+    }
+
+    Invert(C, Cinv);
+
+    for(i = 0; i < 3; ++i)
+    {
+      track.a[i] = Cinv[i][0] * n[0] + Cinv[i][1] * n[1] + Cinv[i][2] * n[2];
+    }
+    track.a2 = track.a[0] * n[0] + track.a[1] * n[1] + track.a[2] * n[2];
+
+    for(i = 0; i < 3; ++i)
+    {
+      for(j = 0; j < 3; ++j)
+      {
+        Dd = Cinv[i][j] - track.a[i] * track.a[j] / track.a2;
+        D[i][j] += Dd;
+        Dx[i] += Dd * track.x0[j];
+      }
+    }
+  }
+
+  if(fConstraint)
+  {
+    for(i = 0; i < 3; ++i)
+    {
+      for(j = 0; j < 3; ++j)
+      {
+        D[i][j] += fCovCstInv[i][j];
+        Dx[i] += fCovCstInv[i][j] * fXCst[j];
+      }
+    }
+  }
+
+  Invert(D, Dinv);
+  for(i = 0; i < 3; ++i)
+  {
+    fX[i] = Dinv[i][0] * Dx[0] + Dinv[i][1] * Dx[1] + Dinv[i][2] * Dx[2];
+  }
+
+  // phases closest to the fast vertex
+  for(m = 0; m < fNTracks; ++m)
+  {
+    Track &track = fTracks[m];
+    for(i = 0; i < 3; ++i) diff[i] = fX[i] - track.x0[i];
+    track.s += (track.a[0] * diff[0] + track.a[1] * diff[1] + track.a[2] * diff[2]) / track.a2;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void DelphesVertexFit::UpdateTrack(Track &track)
+{
+  // see VertexFit::UpdateTrkArrays
+
+  Double_t A[3][5], Wa[3], dpar[5], sum;
+  Int_t i, j, k;
+
+  Derivatives(track.parNew, track.s, A, track.a);
+  Helix(track.parNew, track.s, track.x0);
+
+  // Cov*A'
+  for(i = 0; i < 5; ++i)
+  {
+    for(j = 0; j < 3; ++j)
+    {
+      sum = 0.0;
+      for(k = 0; k < 5; ++k) sum += track.cov[i][k] * A[j][k];
+      track.CAt[i][j] = sum;
+    }
+  }
+
+  // W^-1 = A*Cov*A'
+  for(i = 0; i < 3; ++i)
+  {
+    for(j = i; j < 3; ++j)
+    {
+      sum = 0.0;
+      for(k = 0; k < 5; ++k) sum += A[i][k] * track.CAt[k][j];
+      track.Winv[i][j] = track.Winv[j][i] = sum;
+    }
+  }
+
+  Invert(track.Winv, track.W);
+
+  // shift of the position from the change of parameters
+  for(k = 0; k < 5; ++k) dpar[k] = track.parNew[k] - track.par[k];
+  for(i = 0; i < 3; ++i)
+  {
+    sum = 0.0;
+    for(k = 0; k < 5; ++k) sum += A[i][k] * dpar[k];
+    track.d[i] = sum;
+  }
+
+  for(i = 0; i < 3; ++i)
+  {
+    Wa[i] = track.W[i][0] * track.a[0] + track.W[i][1] * track.a[1] + track.W[i][2] * track.a[2];
+  }
+  track.a2 = track.a[0] * Wa[0] + track.a[1] * Wa[1] + track.a[2] * Wa[2];
+
+  // D = W - W*a*a'*W/a2
+  for(i = 0; i < 3; ++i)
+  {
+    for(j = 0; j < 3; ++j)
+    {
+      track.D[i][j] = track.W[i][j] - Wa[i] * Wa[j] / track.a2;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t DelphesVertexFit::Fit()
+{
+  // see VertexFit::VertexFitter, the updated track covariance is not computed
+
+  const Int_t maxIterations = 100;
+  const Double_t eps = 1.0e-12;
+
+  Double_t H[3][3], Hinv[3][3], DW1D[3][3], DWinv[3][3], cterm[3], xs[3];
+  Double_t x[3], xOld[3], dx[3], r[3], lambda[3], hess[3][3];
+  Double_t epsi, chi2, sum;
+  Int_t i, j, k, m;
+
+  fNIterations = 0;
+  fChi2 = 0.0;
+
+  if(fNTracks < 2 && !fConstraint) return kFALSE;
+
+  for(m = 0; m < fNTracks; ++m)
+  {
+    Track &track = fTracks[m];
+    for(k = 0; k < 5; ++k) track.parNew[k] = track.par[k];
+  }
+
+  FirstPass();
+
+  for(i = 0; i < 3; ++i) xOld[i] = fX[i];
+
+  epsi = 1000.0;
+  while(epsi > eps && fNIterations < maxIterations)
+  {
+    for(i = 0; i < 3; ++i)
+    {
+      cterm[i] = 0.0;
+      for(j = 0; j < 3; ++j)
+      {
+        H[i][j] = 0.0;
+        DW1D[i][j] = 0.0;
+      }
+    }
+
+    for(m = 0; m < fNTracks; ++m)
+    {
+      Track &track = fTracks[m];
+
+      UpdateTrack(track);
+
+      // D*W^-1*D
+      for(i = 0; i < 3; ++i)
+      {
+        for(j = 0; j < 3; ++j)
+        {
+          DWinv[i][j] = track.D[i][0] * track.Winv[0][j] + track.D[i][1] * track.Winv[1][j] + track.D[i][2] * track.Winv[2][j];
+        }
+      }
+      for(i = 0; i < 3; ++i)
+      {
+        for(j = 0; j < 3; ++j)
+        {
+          DW1D[i][j] += DWinv[i][0] * track.D[0][j] + DWinv[i][1] * track.D[1][j] + DWinv[i][2] * track.D[2][j];
+          H[i][j] += track.D[i][j];
+        }
+      }
+
+      for(i = 0; i < 3; ++i) xs[i] = track.x0[i] - track.d[i];
+      for(i = 0; i < 3; ++i)
+      {
+        cterm[i] += track.D[i][0] * xs[0] + track.D[i][1] * xs[1] + track.D[i][2] * xs[2];
+      }
+    }
+
+    if(fConstraint)
+    {
+      for(i = 0; i < 3; ++i)
+      {
+        for(j = 0; j < 3; ++j)
+        {
+          H[i][j] += fCovCstInv[i][j];
+          DW1D[i][j] += fCovCstInv[i][j];
+          cterm[i] += fCovCstInv[i][j] * fXCst[j];
+        }
+      }
+    }
+
+    if(!Invert(H, Hinv)) return kFALSE;
+
+    for(i = 0; i < 3; ++i)
+    {
+      x[i] = Hinv[i][0] * cterm[0] + Hinv[i][1] * cterm[1] + Hinv[i][2] * cterm[2];
+    }
+
+    // covX = H^-1*DW1D*H^-1
+    for(i = 0; i < 3; ++i)
+    {
+      for(j = 0; j < 3; ++j)
+      {
+        DWinv[i][j] = Hinv[i][0] * DW1D[0][j] + Hinv[i][1] * DW1D[1][j] + Hinv[i][2] * DW1D[2][j];
+      }
+    }
+    for(i = 0; i < 3; ++i)
+    {
+      for(j = i; j < 3; ++j)
+      {
+        fCovX[i][j] = fCovX[j][i] = DWinv[i][0] * Hinv[0][j] + DWinv[i][1] * Hinv[1][j] + DWinv[i][2] * Hinv[2][j];
+      }
+    }
+
+    // update phases, parameters and chi2
+    chi2 = 0.0;
+    for(m = 0; m < fNTracks; ++m)
+    {
+      Track &track = fTracks[m];
+
+      for(i = 0; i < 3; ++i) r[i] = track.x0[i] - x[i] - track.d[i];
+      for(i = 0; i < 3; ++i)
+      {
+        lambda[i] = track.D[i][0] * r[0] + track.D[i][1] * r[1] + track.D[i][2] * r[2];
+      }
+
+      sum = 0.0;
+      for(i = 0; i < 3; ++i)
+      {
+        for(j = 0; j < 3; ++j) sum += lambda[i] * track.Winv[i][j] * lambda[j];
+      }
+      track.chi2 = sum;
+      chi2 += sum;
+
+      // a'*W*(x - x0 + d) = -(W*a)'*r
+      sum = 0.0;
+      for(i = 0; i < 3; ++i)
+      {
+        for(j = 0; j < 3; ++j) sum -= track.a[i] * track.W[i][j] * r[j];
+      }
+      track.s += sum / track.a2;
+
+      for(k = 0; k < 5; ++k)
+      {
+        track.parNew[k] = track.par[k] - (track.CAt[k][0] * lambda[0] + track.CAt[k][1] * lambda[1] + track.CAt[k][2] * lambda[2]);
+      }
+    }
+
+    if(fConstraint)
+    {
+      for(i = 0; i < 3; ++i) dx[i] = x[i] - fXCst[i];
+      for(i = 0; i < 3; ++i)
+      {
+        for(j = 0; j < 3; ++j) chi2 += dx[i] * fCovCstInv[i][j] * dx[j];
+      }
+    }
+
+    // vertex stability
+    for(i = 0; i < 3; ++i)
+    {
+      dx[i] = x[i] - xOld[i];
+      xOld[i] = x[i];
+      fX[i] = x[i];
+    }
+
+    Invert(fCovX, hess);
+    epsi = 0.0;
+    for(i = 0; i < 3; ++i)
+    {
+      for(j = 0; j < 3; ++j) epsi += dx[i] * hess[i][j] * dx[j];
+    }
+
+    fChi2 = chi2;
+    ++fNIterations;
+  }
+
+  // the vertex is not usable if the position did not converge
+  return epsi <= eps;
+}
@@ -0,0 +1,105 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DelphesVertexFit_h
+#define DelphesVertexFit_h
+
+/** \class DelphesVertexFit
+ *
+ *  Iterative vertex fit of helical tracks, following the algorithm of
+ *  external/TrackCovariance/VertexFit by F. Bedeschi.
+ *
+ *  Track parameters (D0, phi0, C, DZ, ctg(theta)) and their covariance are
+ *  expressed in mm.  All work arrays have fixed sizes and are kept between
+ *  fits, so that a single object can fit any number of vertices per event
+ *  without allocating memory.
+ *
+ */
+
+#include "Rtypes.h"
+
+#include <vector>
+
+class Candidate;
+
+class DelphesVertexFit
+{
+public:
+  DelphesVertexFit();
+
+  void Clear();
+
+  // par[5] and row-major cov[25] in mm
+  void AddTrack(const Double_t *par, const Double_t *cov);
+
+  // track parameters and covariance as filled by TrackCovariance
+  void AddTrack(const Candidate *track);
+
+  void RemoveTrack(Int_t i);
+
+  // gaussian constraint on the vertex position, row-major cov[9] in mm
+  void SetConstraint(const Double_t *x, const Double_t *cov);
+  void EnableConstraint(Bool_t flag) { fConstraint = flag; }
+
+  // starting radius of the first pass, negative to start at the point of
+  // closest approach to the z axis
+  void SetStartRadius(Double_t radius) { fStartRadius = radius; }
+
+  // return kFALSE if the fit fails or does not converge within 100 iterations
+  Bool_t Fit();
+
+  Int_t GetNTracks() const { return fNTracks; }
+  Int_t GetNDF() const { return 2 * fNTracks - 3 + (fConstraint ? 3 : 0); }
+  Int_t GetNIterations() const { return fNIterations; }
+
+  Double_t GetX(Int_t i) const { return fX[i]; }
+  Double_t GetCov(Int_t i, Int_t j) const { return fCovX[i][j]; }
+  Double_t GetChi2() const { return fChi2; }
+
+  Double_t GetTrackChi2(Int_t i) const { return fTracks[i].chi2; }
+
+  // helix phase of the track at the fitted vertex
+  Double_t GetTrackPhase(Int_t i) const { return fTracks[i].s; }
+
+  static void ConvertCovariance(const Candidate *track, Double_t *cov);
+
+private:
+  struct Track
+  {
+    Double_t par[5], cov[5][5];
+    Double_t parNew[5], s, chi2;
+    Double_t x0[3], d[3], a[3], a2;
+    Double_t W[3][3], Winv[3][3], D[3][3];
+    Double_t CAt[5][3];
+  };
+
+  void FirstPass();
+  void UpdateTrack(Track &track);
+
+  Bool_t fConstraint;
+  Double_t fXCst[3], fCovCst[3][3], fCovCstInv[3][3];
+
+  Double_t fStartRadius;
+
+  Int_t fNTracks, fNIterations;
+  std::vector<Track> fTracks;
+
+  Double_t fX[3], fCovX[3][3], fChi2;
+};
+
+#endif /* DelphesVertexFit_h */
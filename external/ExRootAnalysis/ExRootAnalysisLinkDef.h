@@ -8,6 +8,7 @@
  */
 
 #include "ExRootAnalysis/ExRootTreeReader.h"
+#include "ExRootAnalysis/ExRootTreeColumnReader.h"
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 #include "ExRootAnalysis/ExRootTreeBranch.h"
 #include "ExRootAnalysis/ExRootResult.h"
@@ -26,6 +27,12 @@
 #pragma link off all functions;
 
 #pragma link C++ class ExRootTreeReader+;
+#pragma link C++ class ExRootTreeColumnReader+;
+#pragma link C++ class ExRootTreeColumnBase+;
+#pragma link C++ class ExRootTreeColumn<Float_t>+;
+#pragma link C++ class ExRootTreeColumn<Double_t>+;
+#pragma link C++ class ExRootTreeColumn<Int_t>+;
+#pragma link C++ class ExRootTreeColumn<UInt_t>+;
 #pragma link C++ class ExRootTreeBranch+;
 #pragma link C++ class ExRootTreeWriter+;
 #pragma link C++ class ExRootResult+;
@@ -20,10 +20,13 @@
 #include <stdexcept>
 #include <string>
 
+#include <string.h>
+
 using namespace std;
 
 static Tcl_ObjCmdProc ModuleObjCmdProc;
 static Tcl_ObjCmdProc SourceObjCmdProc;
+static Tcl_ObjCmdProc VariantObjCmdProc;
 
 //------------------------------------------------------------------------------
 
@@ -34,6 +37,7 @@ ExRootConfReader::ExRootConfReader() :
 
   Tcl_CreateObjCommand(fTclInterp, "module", ModuleObjCmdProc, this, 0);
   Tcl_CreateObjCommand(fTclInterp, "source", SourceObjCmdProc, this, 0);
+  Tcl_CreateObjCommand(fTclInterp, "variant", VariantObjCmdProc, this, 0);
 }
 
 //------------------------------------------------------------------------------
@@ -100,6 +104,16 @@ ExRootConfParam ExRootConfReader::GetParam(const char *name)
 
 //------------------------------------------------------------------------------
 
+bool ExRootConfReader::HasParam(const char *name)
+{
+  Tcl_Obj *object;
+  Tcl_Obj *variableName = Tcl_NewStringObj(const_cast<char *>(name), -1);
+  object = Tcl_ObjGetVar2(fTclInterp, variableName, 0, TCL_GLOBAL_ONLY);
+  return object != 0;
+}
+
+//------------------------------------------------------------------------------
+
 int ExRootConfReader::GetInt(const char *name, int defaultValue, int index)
 {
   ExRootConfParam object = GetParam(name);
@@ -186,6 +200,32 @@ void ExRootConfReader::AddModule(const char *className, const char *moduleName)
 
 //------------------------------------------------------------------------------
 
+void ExRootConfReader::AddVariant(const char *variantName, const char *forkName)
+{
+  ExRootVariantList::iterator itVariants;
+
+  for(itVariants = fVariants.begin(); itVariants != fVariants.end(); ++itVariants)
+  {
+    if(itVariants->first == variantName) break;
+  }
+
+  if(itVariants != fVariants.end())
+  {
+    cout << "** WARNING: variant '" << variantName << "' is already configured.";
+    cout << " Only first entry will be used." << endl;
+  }
+  else
+  {
+    fVariants.push_back(make_pair(TString(variantName), TString(forkName)));
+    cout << left;
+    cout << setw(30) << "** INFO: adding variant";
+    cout << setw(25) << variantName;
+    cout << setw(25) << forkName << endl;
+  }
+}
+
+//------------------------------------------------------------------------------
+
 int ModuleObjCmdProc(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
 {
   ExRootConfReader *reader = static_cast<ExRootConfReader *>(clientData);
@@ -196,16 +236,24 @@ int ModuleObjCmdProc(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Ob
     return TCL_ERROR;
   }
 
-  // add module to a list of modules to be created
+  // add module to a list of modules to be created,
+  // modules configured inside a variant are prefixed with its name
+
+  TString moduleName = Tcl_GetStringFromObj(objv[2], 0);
+  if(strlen(reader->GetCurrentVariant()) > 0)
+  {
+    moduleName = TString(reader->GetCurrentVariant()) + "::" + moduleName;
+  }
 
-  reader->AddModule(Tcl_GetStringFromObj(objv[1], 0), Tcl_GetStringFromObj(objv[2], 0));
+  reader->AddModule(Tcl_GetStringFromObj(objv[1], 0), moduleName);
 
   if(objc > 3)
   {
     Tcl_Obj *object = Tcl_NewListObj(0, 0);
     Tcl_ListObjAppendElement(interp, object, Tcl_NewStringObj("namespace", -1));
     Tcl_ListObjAppendElement(interp, object, Tcl_NewStringObj("eval", -1));
-    Tcl_ListObjAppendList(interp, object, Tcl_NewListObj(objc - 2, objv + 2));
+    Tcl_ListObjAppendElement(interp, object, Tcl_NewStringObj(const_cast<char *>(moduleName.Data()), -1));
+    Tcl_ListObjAppendList(interp, object, Tcl_NewListObj(objc - 3, objv + 3));
 
     return Tcl_GlobalEvalObj(interp, object);
   }
@@ -234,6 +282,56 @@ int SourceObjCmdProc(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Ob
 
 //------------------------------------------------------------------------------
 
+int VariantObjCmdProc(ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+  ExRootConfReader *reader = static_cast<ExRootConfReader *>(clientData);
+  int result = TCL_OK;
+
+  if(objc < 3 || objc > 4)
+  {
+    Tcl_WrongNumArgs(interp, 1, objv, "variantName forkName ?body?");
+    return TCL_ERROR;
+  }
+
+  if(strlen(reader->GetCurrentVariant()) > 0)
+  {
+    Tcl_SetResult(interp, const_cast<char *>("variants can't be nested"), TCL_STATIC);
+    return TCL_ERROR;
+  }
+
+  // add variant to a list of variants to be created
+
+  reader->AddVariant(Tcl_GetStringFromObj(objv[1], 0), Tcl_GetStringFromObj(objv[2], 0));
+
+  // declare variant parameters in its namespace,
+  // otherwise set would update global variables with the same name
+
+  Tcl_Obj *object = Tcl_NewListObj(0, 0);
+  Tcl_ListObjAppendElement(interp, object, Tcl_NewStringObj("namespace", -1));
+  Tcl_ListObjAppendElement(interp, object, Tcl_NewStringObj("eval", -1));
+  Tcl_ListObjAppendElement(interp, object, objv[1]);
+  Tcl_ListObjAppendElement(interp, object, Tcl_NewStringObj("variable ExecutionPath; variable OutputFile; variable TreeName", -1));
+
+  result = Tcl_GlobalEvalObj(interp, object);
+
+  if(result == TCL_OK && objc > 3)
+  {
+    object = Tcl_NewListObj(0, 0);
+    Tcl_ListObjAppendElement(interp, object, Tcl_NewStringObj("namespace", -1));
+    Tcl_ListObjAppendElement(interp, object, Tcl_NewStringObj("eval", -1));
+    Tcl_ListObjAppendElement(interp, object, objv[1]);
+    Tcl_ListObjAppendElement(interp, object, objv[3]);
+
+    reader->SetCurrentVariant(Tcl_GetStringFromObj(objv[1], 0));
+    result = Tcl_GlobalEvalObj(interp, object);
+    reader->SetCurrentVariant("");
+  }
+
+  return result;
+}
+
+//------------------------------------------------------------------------------
+
 ExRootConfParam::ExRootConfParam(const char *name, Tcl_Obj *object, Tcl_Interp *interp) :
   fName(name), fObject(object), fTclInterp(interp)
 {
@@ -13,6 +13,7 @@
 
 #include <map>
 #include <utility>
+#include <vector>
 
 struct Tcl_Obj;
 struct Tcl_Interp;
@@ -43,6 +44,7 @@ class ExRootConfReader: public TNamed
 {
 public:
   typedef std::map<TString, TString> ExRootTaskMap;
+  typedef std::vector<std::pair<TString, TString> > ExRootVariantList;
 
   ExRootConfReader();
   ~ExRootConfReader();
@@ -55,11 +57,20 @@ public:
   bool GetBool(const char *name, bool defaultValue, int index = -1);
   const char *GetString(const char *name, const char *defaultValue, int index = -1);
   ExRootConfParam GetParam(const char *name);
+  bool HasParam(const char *name);
 
   const ExRootTaskMap *GetModules() const { return &fModules; }
 
   void AddModule(const char *className, const char *moduleName);
 
+  // variants are listed as pairs of variant and fork module names
+  const ExRootVariantList *GetVariants() const { return &fVariants; }
+
+  void AddVariant(const char *variantName, const char *forkName);
+
+  const char *GetCurrentVariant() const { return fCurrentVariant; }
+  void SetCurrentVariant(const char *variantName) { fCurrentVariant = variantName; }
+
   const char *GetTopDir() const { return fTopDir; }
 
 private:
@@ -68,6 +79,9 @@ private:
   Tcl_Interp *fTclInterp; //!
 
   ExRootTaskMap fModules; //!
+  ExRootVariantList fVariants; //!
+
+  TString fCurrentVariant; //!
 
   ClassDef(ExRootConfReader, 1)
 };
@@ -190,15 +190,27 @@ const ExRootConfReader::ExRootTaskMap *ExRootTask::GetModules()
 
 //------------------------------------------------------------------------------
 
+TString ExRootTask::GetParamName(const char *name)
+{
+  TString paramName = fConfPrefix + GetName() + "::" + name;
+  if(fConfPrefix.Length() > 0 && fConfReader && !fConfReader->HasParam(paramName))
+  {
+    paramName = TString(GetName()) + "::" + name;
+  }
+  return paramName;
+}
+
+//------------------------------------------------------------------------------
+
 ExRootConfParam ExRootTask::GetParam(const char *name)
 {
   if(fConfReader)
   {
-    return fConfReader->GetParam(TString(GetName()) + "::" + name);
+    return fConfReader->GetParam(GetParamName(name));
   }
   else
   {
-    return ExRootConfParam(TString(GetName()) + "::" + name, 0, 0);
+    return ExRootConfParam(GetParamName(name), 0, 0);
   }
 }
 
@@ -208,7 +220,7 @@ int ExRootTask::GetInt(const char *name, int defaultValue, int index)
 {
   if(fConfReader)
   {
-    return fConfReader->GetInt(TString(GetName()) + "::" + name, defaultValue, index);
+    return fConfReader->GetInt(GetParamName(name), defaultValue, index);
   }
   else
   {
@@ -222,7 +234,7 @@ long ExRootTask::GetLong(const char *name, long defaultValue, int index)
 {
   if(fConfReader)
   {
-    return fConfReader->GetLong(TString(GetName()) + "::" + name, defaultValue, index);
+    return fConfReader->GetLong(GetParamName(name), defaultValue, index);
   }
   else
   {
@@ -236,7 +248,7 @@ double ExRootTask::GetDouble(const char *name, double defaultValue, int index)
 {
   if(fConfReader)
   {
-    return fConfReader->GetDouble(TString(GetName()) + "::" + name, defaultValue, index);
+    return fConfReader->GetDouble(GetParamName(name), defaultValue, index);
   }
   else
   {
@@ -250,7 +262,7 @@ bool ExRootTask::GetBool(const char *name, bool defaultValue, int index)
 {
   if(fConfReader)
   {
-    return fConfReader->GetBool(TString(GetName()) + "::" + name, defaultValue, index);
+    return fConfReader->GetBool(GetParamName(name), defaultValue, index);
   }
   else
   {
@@ -264,7 +276,7 @@ const char *ExRootTask::GetString(const char *name, const char *defaultValue, in
 {
   if(fConfReader)
   {
-    return fConfReader->GetString(TString(GetName()) + "::" + name, defaultValue, index);
+    return fConfReader->GetString(GetParamName(name), defaultValue, index);
   }
   else
   {
@@ -52,6 +52,9 @@ public:
   void SetFolder(TFolder *folder) { fFolder = folder; }
   void SetConfReader(ExRootConfReader *conf) { fConfReader = conf; }
 
+  // parameters are first looked up as <prefix><name>::<parameter>
+  void SetConfPrefix(const char *prefix) { fConfPrefix = prefix; }
+
 protected:
   TFolder *GetFolder() const { return fFolder; }
   ExRootConfReader *GetConfReader() const { return fConfReader; }
@@ -60,9 +63,13 @@ protected:
   TObject *GetObject(const char *name, TClass *cl);
 
 private:
+  TString GetParamName(const char *name);
+
   TFolder *fFolder; //!
   ExRootConfReader *fConfReader; //!
 
+  TString fConfPrefix; //!
+
   ClassDef(ExRootTask, 1)
 };
 
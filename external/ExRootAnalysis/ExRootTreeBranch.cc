@@ -36,11 +36,7 @@ ExRootTreeBranch::ExRootTreeBranch(const char *name, TClass *cl, TTree *tree) :
     fData->SetName(name);
     fData->ExpandCreateFast(fCapacity);
     fData->Clear();
-    if(tree)
-    {
-      tree->Branch(name, &fData, 64000);
-      tree->Branch(TString(name) + "_size", &fSize, TString(name) + "_size/I");
-    }
+    if(tree) AddToTree(tree);
   }
   else
   {
@@ -86,6 +82,15 @@ TObject *ExRootTreeBranch::NewEntry()
 
 //------------------------------------------------------------------------------
 
+void ExRootTreeBranch::AddToTree(TTree *tree)
+{
+  const char *name = fData->GetName();
+  tree->Branch(name, &fData, 64000);
+  tree->Branch(TString(name) + "_size", &fSize, TString(name) + "_size/I");
+}
+
+//------------------------------------------------------------------------------
+
 void ExRootTreeBranch::Clear()
 {
   fSize = 0;
@@ -24,6 +24,9 @@ public:
   TObject *NewEntry();
   void Clear();
 
+  // write the entries of the branch to another tree
+  void AddToTree(TTree *tree);
+
 private:
   Int_t fSize, fCapacity; //!
   TClonesArray *fData; //!
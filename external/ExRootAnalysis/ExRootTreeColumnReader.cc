@@ -0,0 +1,301 @@
+
+/** \class ExRootTreeColumnReader
+ *
+ *  Class giving access to individual leaves of ROOT tree branches
+ *  (e.g. Jet.PT) as contiguous arrays, for one event or for a batch
+ *  of events.  Only the requested leaves are read from the file.
+ *
+ */
+
+#include "ExRootAnalysis/ExRootTreeColumnReader.h"
+
+#include "TBranchElement.h"
+#include "TChain.h"
+#include "TLeaf.h"
+#include "TObjArray.h"
+#include "TTree.h"
+
+#include <iostream>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+ExRootTreeColumnReader::ExRootTreeColumnReader(TTree *tree) :
+  fChain(0), fCurrentTree(-1)
+{
+  SetTree(tree);
+}
+
+//------------------------------------------------------------------------------
+
+ExRootTreeColumnReader::~ExRootTreeColumnReader()
+{
+  TBranchMap::iterator itBranchMap;
+  TColumnMap::iterator itColumnMap;
+
+  for(itColumnMap = fColumnMap.begin(); itColumnMap != fColumnMap.end(); ++itColumnMap)
+  {
+    delete itColumnMap->second.second;
+  }
+
+  for(itBranchMap = fBranchMap.begin(); itBranchMap != fBranchMap.end(); ++itBranchMap)
+  {
+    delete itBranchMap->second;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeColumnReader::SetTree(TTree *tree)
+{
+  fChain = tree;
+  fCurrentTree = -1;
+  if(!fChain) return;
+
+  // read split branches into plain arrays, starting with all branches disabled
+  fChain->SetMakeClass(1);
+  fChain->SetBranchStatus("*", 0);
+}
+
+//------------------------------------------------------------------------------
+
+Long64_t ExRootTreeColumnReader::GetEntries() const
+{
+  return fChain ? static_cast<Long64_t>(fChain->GetEntries()) : 0;
+}
+
+//------------------------------------------------------------------------------
+
+const Int_t *ExRootTreeColumnReader::UseSize(const char *branchName)
+{
+  TBranchInfo *info = UseBranch(branchName);
+
+  if(!info)
+  {
+    cout << "** WARNING: cannot access branch '" << branchName << "', return NULL pointer" << endl;
+    return 0;
+  }
+
+  Notify();
+
+  return &info->size;
+}
+
+//------------------------------------------------------------------------------
+
+ExRootTreeColumnReader::TBranchInfo *ExRootTreeColumnReader::UseBranch(const TString &branchName)
+{
+  TBranchMap::iterator itBranchMap = fBranchMap.find(branchName);
+  TBranchInfo *info;
+
+  if(itBranchMap != fBranchMap.end()) return itBranchMap->second;
+
+  if(!fChain || !fChain->GetBranch(branchName) || fChain->GetBranch(branchName)->IsA() != TBranchElement::Class())
+  {
+    return 0;
+  }
+
+  // the top level branch holds the number of objects
+  fChain->SetBranchStatus(branchName, 1);
+
+  info = new TBranchInfo;
+  info->branch = 0;
+  info->size = 0;
+  fBranchMap.insert(make_pair(branchName, info));
+
+  return info;
+}
+
+//------------------------------------------------------------------------------
+
+ExRootTreeColumnReader::TBranchInfo *ExRootTreeColumnReader::AddColumn(const char *leafName, EDataType type)
+{
+  TString name(leafName);
+  TBranch *branch;
+  TLeaf *leaf;
+  TBranchInfo *info;
+  Ssiz_t dot;
+
+  if(fColumnMap.find(name) != fColumnMap.end())
+  {
+    cout << "** WARNING: leaf '" << leafName << "' is already in use, return NULL pointer" << endl;
+    return 0;
+  }
+
+  dot = name.First('.');
+  branch = fChain ? fChain->GetBranch(name) : 0;
+  leaf = branch ? static_cast<TLeaf *>(branch->GetListOfLeaves()->At(0)) : 0;
+
+  if(dot <= 0 || !leaf)
+  {
+    cout << "** WARNING: cannot access leaf '" << leafName << "', return NULL pointer" << endl;
+    return 0;
+  }
+
+  if(leaf->GetLenStatic() != 1 || TString(leaf->GetTypeName()) != TDataType::GetTypeName(type))
+  {
+    cout << "** WARNING: leaf '" << leafName << "' of type '" << leaf->GetTypeName();
+    cout << "' cannot be read as '" << TDataType::GetTypeName(type) << "', return NULL pointer" << endl;
+    return 0;
+  }
+
+  info = UseBranch(name(0, dot));
+  if(!info)
+  {
+    cout << "** WARNING: cannot access branch '" << name(0, dot) << "', return NULL pointer" << endl;
+    return 0;
+  }
+
+  fChain->SetBranchStatus(name, 1);
+
+  return info;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootTreeColumnReader::LoadEntry(Long64_t entry, Long64_t &treeEntry)
+{
+  if(!fChain) return kFALSE;
+
+  treeEntry = fChain->LoadTree(entry);
+  if(treeEntry < 0) return kFALSE;
+
+  if(fChain->IsA() == TChain::Class())
+  {
+    TChain *chain = static_cast<TChain *>(fChain);
+    if(chain->GetTreeNumber() != fCurrentTree)
+    {
+      fCurrentTree = chain->GetTreeNumber();
+      Notify();
+    }
+  }
+  else if(fCurrentTree < 0)
+  {
+    fCurrentTree = 0;
+    Notify();
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootTreeColumnReader::ReadEntry(Long64_t entry)
+{
+  // Read contents of entry.
+  Long64_t treeEntry;
+  TBranchMap::iterator itBranchMap;
+  TBranchInfo *info;
+
+  if(!LoadEntry(entry, treeEntry)) return kFALSE;
+
+  // top level branches also read their active leaves
+  for(itBranchMap = fBranchMap.begin(); itBranchMap != fBranchMap.end(); ++itBranchMap)
+  {
+    info = itBranchMap->second;
+    if(info->branch) info->branch->GetEntry(treeEntry);
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
+
+Long64_t ExRootTreeColumnReader::ReadBatch(Long64_t first, Long64_t maxSize)
+{
+  Long64_t treeEntry, last, entry;
+  TBranchMap::iterator itBranchMap;
+  TColumnMap::iterator itColumnMap;
+  TBranchInfo *info;
+
+  for(itBranchMap = fBranchMap.begin(); itBranchMap != fBranchMap.end(); ++itBranchMap)
+  {
+    info = itBranchMap->second;
+    info->offsets.clear();
+    info->offsets.push_back(0);
+  }
+
+  for(itColumnMap = fColumnMap.begin(); itColumnMap != fColumnMap.end(); ++itColumnMap)
+  {
+    itColumnMap->second.second->ClearBatch();
+  }
+
+  if(!LoadEntry(first, treeEntry)) return 0;
+
+  // stop at the end of the cluster, which is also the end of the current tree
+  TTree::TClusterIterator itCluster = fChain->GetTree()->GetClusterIterator(treeEntry);
+  itCluster.Next();
+  last = first - treeEntry + itCluster.GetNextEntry();
+  if(maxSize > 0 && last > first + maxSize) last = first + maxSize;
+
+  for(entry = first; entry < last; ++entry)
+  {
+    if(!ReadEntry(entry)) break;
+
+    for(itColumnMap = fColumnMap.begin(); itColumnMap != fColumnMap.end(); ++itColumnMap)
+    {
+      itColumnMap->second.second->FillBatch(itColumnMap->second.first->size);
+    }
+
+    for(itBranchMap = fBranchMap.begin(); itBranchMap != fBranchMap.end(); ++itBranchMap)
+    {
+      info = itBranchMap->second;
+      info->offsets.push_back(info->offsets.back() + info->size);
+    }
+  }
+
+  return entry - first;
+}
+
+//------------------------------------------------------------------------------
+
+Bool_t ExRootTreeColumnReader::Notify()
+{
+  // Called when loading a new file.
+  // Get branch pointers and resize the buffers to the largest event of the file.
+  if(!fChain || !fChain->GetTree()) return kFALSE;
+
+  TTree *tree = fChain->GetTree();
+  TBranchMap::iterator itBranchMap;
+  TColumnMap::iterator itColumnMap;
+  TBranch *branch;
+  TBranchInfo *info;
+  Int_t maximum;
+
+  tree->SetMakeClass(1);
+
+  for(itBranchMap = fBranchMap.begin(); itBranchMap != fBranchMap.end(); ++itBranchMap)
+  {
+    info = itBranchMap->second;
+    branch = tree->GetBranch(itBranchMap->first);
+    info->branch = branch;
+    if(branch)
+    {
+      branch->SetAddress(&info->size);
+    }
+    else
+    {
+      cout << "** WARNING: cannot get branch '" << itBranchMap->first << "'" << endl;
+    }
+  }
+
+  for(itColumnMap = fColumnMap.begin(); itColumnMap != fColumnMap.end(); ++itColumnMap)
+  {
+    info = itColumnMap->second.first;
+    branch = tree->GetBranch(itColumnMap->first);
+    if(branch && info->branch)
+    {
+      maximum = static_cast<TBranchElement *>(info->branch)->GetMaximum();
+      branch->SetAddress(itColumnMap->second.second->Reserve(maximum > 0 ? maximum : 1));
+    }
+    else
+    {
+      cout << "** WARNING: cannot get leaf '" << itColumnMap->first << "'" << endl;
+    }
+  }
+
+  return kTRUE;
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,146 @@
+#ifndef ExRootTreeColumnReader_h
+#define ExRootTreeColumnReader_h
+
+/** \class ExRootTreeColumnReader
+ *
+ *  Class giving access to individual leaves of ROOT tree branches
+ *  (e.g. Jet.PT) as contiguous arrays, for one event or for a batch
+ *  of events.  Only the requested leaves are read from the file.
+ *
+ */
+
+#include "TDataType.h"
+#include "TNamed.h"
+#include "TString.h"
+
+#include <map>
+#include <typeinfo>
+#include <vector>
+
+class TBranch;
+class TTree;
+
+//------------------------------------------------------------------------------
+
+class ExRootTreeColumnBase
+{
+public:
+  virtual ~ExRootTreeColumnBase() {}
+
+  // capacity of the per-event buffer, return its address
+  virtual void *Reserve(Int_t size) = 0;
+
+  virtual void ClearBatch() = 0;
+  virtual void FillBatch(Int_t size) = 0;
+};
+
+//------------------------------------------------------------------------------
+
+template <typename T>
+class ExRootTreeColumn: public ExRootTreeColumnBase
+{
+public:
+  ExRootTreeColumn(const Int_t *size, const std::vector<Long64_t> *offsets) :
+    fSize(size), fOffsets(offsets) {}
+
+  // values of the last event read with ReadEntry
+
+  Int_t GetSize() const { return *fSize; }
+  const T *GetData() const { return fBuffer.data(); }
+  T At(Int_t i) const { return fBuffer[i]; }
+  T operator[](Int_t i) const { return fBuffer[i]; }
+
+  const T *begin() const { return fBuffer.data(); }
+  const T *end() const { return fBuffer.data() + *fSize; }
+
+  // values of all events read with ReadBatch,
+  // event i owns the values from GetBatchOffset(i) to GetBatchOffset(i + 1)
+
+  Long64_t GetBatchSize() const { return fBatch.size(); }
+  const T *GetBatchData() const { return fBatch.data(); }
+  Long64_t GetBatchOffset(Long64_t i) const { return (*fOffsets)[i]; }
+  const Long64_t *GetBatchOffsets() const { return fOffsets->data(); }
+
+  void *Reserve(Int_t size)
+  {
+    if(Int_t(fBuffer.size()) < size) fBuffer.resize(size);
+    return fBuffer.data();
+  }
+
+  void ClearBatch() { fBatch.clear(); }
+  void FillBatch(Int_t size) { fBatch.insert(fBatch.end(), fBuffer.begin(), fBuffer.begin() + size); }
+
+private:
+  const Int_t *fSize; //!
+  const std::vector<Long64_t> *fOffsets; //!
+
+  std::vector<T> fBuffer; //!
+  std::vector<T> fBatch; //!
+};
+
+//------------------------------------------------------------------------------
+
+class ExRootTreeColumnReader: public TNamed
+{
+public:
+  ExRootTreeColumnReader(TTree *tree = 0);
+  ~ExRootTreeColumnReader();
+
+  void SetTree(TTree *tree);
+
+  Long64_t GetEntries() const;
+
+  Bool_t ReadEntry(Long64_t entry);
+
+  // read events from first up to the end of its cluster of entries,
+  // at most maxSize events if maxSize > 0; return the number of events read
+  Long64_t ReadBatch(Long64_t first, Long64_t maxSize = 0);
+
+  // number of objects in a branch, e.g. "Jet", for the last event read with ReadEntry
+  const Int_t *UseSize(const char *branchName);
+
+  // leaf name is the branch name followed by the member name, e.g. "Jet.PT"
+  template <typename T>
+  const ExRootTreeColumn<T> *UseColumn(const char *leafName)
+  {
+    TBranchInfo *info;
+    ExRootTreeColumn<T> *column = 0;
+
+    info = AddColumn(leafName, TDataType::GetType(typeid(T)));
+    if(info)
+    {
+      column = new ExRootTreeColumn<T>(&info->size, &info->offsets);
+      fColumnMap[leafName] = std::make_pair(info, static_cast<ExRootTreeColumnBase *>(column));
+      Notify();
+    }
+
+    return column;
+  }
+
+private:
+  struct TBranchInfo
+  {
+    TBranch *branch;
+    Int_t size;
+    std::vector<Long64_t> offsets;
+  };
+
+  TBranchInfo *UseBranch(const TString &branchName);
+  TBranchInfo *AddColumn(const char *leafName, EDataType type);
+
+  Bool_t LoadEntry(Long64_t entry, Long64_t &treeEntry);
+  Bool_t Notify();
+
+  TTree *fChain; //! pointer to the analyzed TTree or TChain
+  Int_t fCurrentTree; //! current Tree number in a TChain
+
+  typedef std::map<TString, TBranchInfo *> TBranchMap;
+  typedef std::map<TString, std::pair<TBranchInfo *, ExRootTreeColumnBase *> > TColumnMap;
+
+  TBranchMap fBranchMap; //!
+  TColumnMap fColumnMap; //!
+
+  ClassDef(ExRootTreeColumnReader, 1)
+};
+
+#endif // ExRootTreeColumnReader_h
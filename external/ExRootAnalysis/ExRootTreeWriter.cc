@@ -23,7 +23,7 @@
 using namespace std;
 
 ExRootTreeWriter::ExRootTreeWriter(TFile *file, const char *treeName) :
-  fFile(file), fTree(0), fTreeName(treeName)
+  fFile(file), fTree(0), fTreeName(treeName), fAccepted(kTRUE)
 {
 }
 
@@ -52,6 +52,21 @@ ExRootTreeBranch *ExRootTreeWriter::NewBranch(const char *name, TClass *cl)
 
 //------------------------------------------------------------------------------
 
+void ExRootTreeWriter::AddBranch(ExRootTreeBranch *branch)
+{
+  if(!fTree) fTree = NewTree();
+  if(fTree) branch->AddToTree(fTree);
+}
+
+//------------------------------------------------------------------------------
+
+void ExRootTreeWriter::AddWriter(ExRootTreeWriter *writer)
+{
+  fWriters.push_back(writer);
+}
+
+//------------------------------------------------------------------------------
+
 void ExRootTreeWriter::AddInfo(const char *name, Double_t value)
 {
   if(!fTree) fTree = NewTree();
@@ -62,7 +77,14 @@ void ExRootTreeWriter::AddInfo(const char *name, Double_t value)
 
 void ExRootTreeWriter::Fill()
 {
-  if(fTree) fTree->Fill();
+  vector<ExRootTreeWriter *>::iterator itWriters;
+
+  if(fTree && fAccepted) fTree->Fill();
+
+  for(itWriters = fWriters.begin(); itWriters != fWriters.end(); ++itWriters)
+  {
+    (*itWriters)->Fill();
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -82,6 +104,12 @@ void ExRootTreeWriter::Clear()
   {
     (*itBranches)->Clear();
   }
+
+  vector<ExRootTreeWriter *>::iterator itWriters;
+  for(itWriters = fWriters.begin(); itWriters != fWriters.end(); ++itWriters)
+  {
+    (*itWriters)->Clear();
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -12,6 +12,7 @@
 #include "TNamed.h"
 
 #include <set>
+#include <vector>
 
 class TFile;
 class TTree;
@@ -24,6 +25,7 @@ public:
   ExRootTreeWriter(TFile *file = 0, const char *treeName = "Analysis");
   ~ExRootTreeWriter();
 
+  TFile *GetTreeFile() const { return fFile; }
   void SetTreeFile(TFile *file) { fFile = file; }
   void SetTreeName(const char *name) { fTreeName = name; }
 
@@ -33,6 +35,21 @@ public:
   ExRootTreeBranch *NewBranch(const char *name, TClass *cl);
   void AddInfo(const char *name, Double_t value);
 
+  // branches created by NewBranch
+  const std::set<ExRootTreeBranch *> &GetBranches() const { return fBranches; }
+
+  // write a branch of another writer to this tree,
+  // the branch is filled and cleared by its own writer
+  void AddBranch(ExRootTreeBranch *branch);
+
+  // writers filled and cleared together with this one
+  void AddWriter(ExRootTreeWriter *writer);
+
+  // the tree is only filled if the event is accepted for this writer,
+  // writers added with AddWriter decide for themselves
+  void SetAccepted(Bool_t accepted) { fAccepted = accepted; }
+  Bool_t IsAccepted() const { return fAccepted; }
+
   void Clear();
   void Fill();
   void Write();
@@ -45,8 +62,12 @@ private:
 
   TString fTreeName; //!
 
+  Bool_t fAccepted; //!
+
   std::set<ExRootTreeBranch *> fBranches; //!
 
+  std::vector<ExRootTreeWriter *> fWriters; //!
+
   ClassDef(ExRootTreeWriter, 1)
 };
 
@@ -1,14 +1,17 @@
 #include "PuppiContainer.hh"
-#include "fastjet/Selector.hh"
 #include "Math/ProbFunc.h"
 #include "TMath.h"
+#include <algorithm>
 #include <iostream>
 #include <math.h>
+#include <thread>
 
 PuppiContainer::PuppiContainer(bool iApplyCHS, bool iUseExp,double iPuppiWeightCut,std::vector<AlgoObj> &iAlgos) { 
   fApplyCHS        = iApplyCHS;
   fUseExp          = iUseExp;
   fPuppiWeightCut  = iPuppiWeightCut;
+  fNNeighbours     = 0;
+  fNThreads        = 0;
   fNAlgos = iAlgos.size();
   for(unsigned int i0 = 0; i0 < iAlgos.size(); i0++) { 
     PuppiAlgo pPuppiConfig(iAlgos[i0]);
@@ -24,6 +27,13 @@ void PuppiContainer::initialize(const std::vector<RecoObj> &iRecoObjects) {
   fPupParticles .resize(0);
   fWeights      .resize(0);
   fVals.resize(0);
+  fPartRap      .resize(0);
+  fPartPhi      .resize(0);
+  fPartEta      .resize(0);
+  fPartPt       .resize(0);
+  fPartChargedPV.resize(0);
+  fPartPupId    .resize(0);
+  fNNeighbours = 0;
   //fChargedNoPV.resize(0);
   //Link to the RecoObjects
   fPVFrac = 0.; 
@@ -36,7 +46,13 @@ void PuppiContainer::initialize(const std::vector<RecoObj> &iRecoObjects) {
     if(fRecoParticles[i].id == 1 and fRecoParticles[i].charge != 0) curPseudoJet.set_user_index(fRecoParticles[i].charge); // from PV use the                             
     if(fRecoParticles[i].id == 2 and fRecoParticles[i].charge != 0) curPseudoJet.set_user_index(fRecoParticles[i].charge+5); // from NPV use the charge as key +5 as key           // fill vector of pseudojets for internal references
     fPFParticles.push_back(curPseudoJet);
+    fPartRap.push_back(curPseudoJet.rap());
+    fPartPhi.push_back(curPseudoJet.phi());
+    fPartEta.push_back(curPseudoJet.eta());
+    fPartPt .push_back(curPseudoJet.pt());
+    fPartPupId.push_back(getPuppiId(curPseudoJet.pt(),curPseudoJet.eta()));
     //Take Charged particles associated to PV
+    fPartChargedPV.push_back(fabs(fRecoParticles[i].id) == 1);
     if(fabs(fRecoParticles[i].id) == 1) fChargedPV.push_back(curPseudoJet);
     if(fabs(fRecoParticles[i].id) >= 1 ) fPVFrac+=1.;
     if(fNPV < fRecoParticles[i].vtxId) fNPV = fRecoParticles[i].vtxId;
@@ -47,69 +63,125 @@ void PuppiContainer::initialize(const std::vector<RecoObj> &iRecoObjects) {
 }
 PuppiContainer::~PuppiContainer(){}
 
-double PuppiContainer::goodVar(fastjet::PseudoJet &iPart,std::vector<fastjet::PseudoJet> &iParts, int iOpt,double iRCone) {
-  double lPup = 0;
-  lPup = var_within_R(iOpt,iParts,iPart,iRCone);
-  return lPup;
+// Neighbours are found on a grid of phi bins at least as wide as the cone,
+// with the particles of each bin sorted in rapidity. Selection and ordering
+// match filtering the full collection with fastjet::SelectorCircle.
+const PuppiContainer::NeighbourList &PuppiContainer::getNeighbours(double iRCone,bool iCharged) {
+  for(int i0 = 0; i0 < fNNeighbours; i0++) {
+    if(fNeighbours[i0].cone == iRCone && fNeighbours[i0].charged == iCharged) return fNeighbours[i0];
+  }
+  if(int(fNeighbours.size()) <= fNNeighbours) fNeighbours.resize(fNNeighbours + 1);
+  NeighbourList &lList = fNeighbours[fNNeighbours++];
+  lList.cone    = iRCone;
+  lList.charged = iCharged;
+  lList.offsets.resize(0);
+  lList.indices.resize(0);
+
+  int lNParticles = fPFParticles.size();
+  double lR2 = iRCone*iRCone;
+  int lNPhi = int(fastjet::twopi/(1.0001*iRCone));
+  if(lNPhi < 3) lNPhi = 1;
+  double lPhiWidth = fastjet::twopi/lNPhi;
+
+  // bin the neighbour candidates, sorted by rapidity within each bin
+  std::vector<std::vector<std::pair<double,int> > > lBins(lNPhi);
+  for(int i0 = 0; i0 < lNParticles; i0++) {
+    if(iCharged && !fPartChargedPV[i0]) continue;
+    int lBin = std::min(int(fPartPhi[i0]/lPhiWidth), lNPhi - 1);
+    lBins[lBin].push_back(std::make_pair(fPartRap[i0],i0));
+  }
+  for(int i0 = 0; i0 < lNPhi; i0++) std::sort(lBins[i0].begin(),lBins[i0].end());
+
+  lList.offsets.push_back(0);
+  for(int i0 = 0; i0 < lNParticles; i0++) {
+    int lBin = std::min(int(fPartPhi[i0]/lPhiWidth), lNPhi - 1);
+    int lNScan = lNPhi == 1 ? 1 : 3;
+    for(int i1 = 0; i1 < lNScan; i1++) {
+      const std::vector<std::pair<double,int> > &lBinParts = lBins[lNPhi == 1 ? 0 : (lBin + lNPhi - 1 + i1) % lNPhi];
+      std::vector<std::pair<double,int> >::const_iterator lIt = std::lower_bound(lBinParts.begin(),lBinParts.end(),std::make_pair(fPartRap[i0] - 1.0001*iRCone,-1));
+      for(; lIt != lBinParts.end() && lIt->first <= fPartRap[i0] + 1.0001*iRCone; ++lIt) {
+        int j0 = lIt->second;
+        // same arithmetic as PseudoJet::squared_distance
+        double pDPhi = std::abs(fPartPhi[j0] - fPartPhi[i0]);
+        if(pDPhi > fastjet::pi) pDPhi = fastjet::twopi - pDPhi;
+        double pDRap = fPartRap[j0] - fPartRap[i0];
+        if(pDPhi*pDPhi + pDRap*pDRap <= lR2) lList.indices.push_back(j0);
+      }
+    }
+    std::sort(lList.indices.begin() + lList.offsets.back(),lList.indices.end());
+    lList.offsets.push_back(lList.indices.size());
+  }
+  return lList;
 }
-double PuppiContainer::var_within_R(int iId, const vector<fastjet::PseudoJet> & particles, const fastjet::PseudoJet& centre, double R){
+double PuppiContainer::var_within_R(int iId, const NeighbourList &iNeighbours, int iCentre){
   if(iId == -1) return 1;
-  fastjet::Selector sel = fastjet::SelectorCircle(R);
-  sel.set_reference(centre);
-  vector<fastjet::PseudoJet> near_particles = sel(particles);
   double var = 0;
   //double lSumPt = 0;
   //if(iId == 1) for(unsigned int i=0; i<near_particles.size(); i++) lSumPt += near_particles[i].pt();
-  for(unsigned int i=0; i<near_particles.size(); i++){
-    double pDEta = near_particles[i].eta()-centre.eta();
-    double pDPhi = fabs(near_particles[i].phi()-centre.phi());
+  for(int i = iNeighbours.offsets[iCentre]; i < iNeighbours.offsets[iCentre+1]; i++){
+    int j = iNeighbours.indices[i];
+    double pDEta = fPartEta[j]-fPartEta[iCentre];
+    double pDPhi = fabs(fPartPhi[j]-fPartPhi[iCentre]);
     if(pDPhi > 2.*3.14159265-pDPhi) pDPhi =  2.*3.14159265-pDPhi;
     double pDR2 = pDEta*pDEta+pDPhi*pDPhi;
     if(std::abs(pDR2)  <  0.0001) continue;
-    if(iId == 0) var += (near_particles[i].pt()/pDR2);
-    if(iId == 1) var += near_particles[i].pt();
+    if(iId == 0) var += (fPartPt[j]/pDR2);
+    if(iId == 1) var += fPartPt[j];
     if(iId == 2) var += (1./pDR2);
     if(iId == 3) var += (1./pDR2);
-    if(iId == 4) var += near_particles[i].pt();  
-    if(iId == 5) var += (near_particles[i].pt()*(near_particles[i].pt()/pDR2));
+    if(iId == 4) var += fPartPt[j];  
+    if(iId == 5) var += (fPartPt[j]*(fPartPt[j]/pDR2));
   }
-  if(iId == 1) var += centre.pt(); //Sum in a cone
+  if(iId == 1) var += fPartPt[iCentre]; //Sum in a cone
   if(iId == 0 && var != 0) var = log(var);
   if(iId == 3 && var != 0) var = log(var);
   if(iId == 5 && var != 0) var = log(var);
   return var;
 }
-//In fact takes the median not the average
-void PuppiContainer::getRMSAvg(int iOpt,std::vector<fastjet::PseudoJet> &iConstits,std::vector<fastjet::PseudoJet> &iParticles,std::vector<fastjet::PseudoJet> &iChargedParticles) { 
-  for(unsigned int i0 = 0; i0 < iConstits.size(); i0++ ) { 
-    double pVal = -1;
-    //Calculate the Puppi Algo to use
-    int  pPupId   = getPuppiId(iConstits[i0].pt(),iConstits[i0].eta());
-    if(fPuppiAlgo[pPupId].numAlgos() <= iOpt) pPupId = -1;
-    if(pPupId == -1) {fVals.push_back(-1); continue;}
-    //Get the Puppi Sub Algo (given iteration)
+//Compute the metric of particles iBegin to iEnd, neighbour lists must exist
+void PuppiContainer::computeVals(int iOpt,int iBegin,int iEnd) { 
+  for(int i0 = iBegin; i0 < iEnd; i0++ ) { 
+    int  pPupId   = fPartPupId[i0];
+    if(pPupId == -1 || fPuppiAlgo[pPupId].numAlgos() <= iOpt) {fIterVals[i0] = -1; continue;}
     int  pAlgo    = fPuppiAlgo[pPupId].algoId   (iOpt); 
     bool pCharged = fPuppiAlgo[pPupId].isCharged(iOpt);
     double pCone  = fPuppiAlgo[pPupId].coneSize (iOpt);
-    //Compute the Puppi Metric 
-    if(!pCharged) pVal = goodVar(iConstits[i0],iParticles       ,pAlgo,pCone);
-    if( pCharged) pVal = goodVar(iConstits[i0],iChargedParticles,pAlgo,pCone);
+    //Lists are only searched here, getRMSAvg built them
+    int i1 = 0;
+    while(fNeighbours[i1].cone != pCone || fNeighbours[i1].charged != pCharged) i1++;
+    fIterVals[i0] = var_within_R(pAlgo,fNeighbours[i1],i0);
+  }
+}
+//In fact takes the median not the average
+void PuppiContainer::getRMSAvg(int iOpt) { 
+  int lNParticles = fPFParticles.size();
+  //Build the neighbour lists needed by this iteration
+  for(int i0 = 0; i0 < fNAlgos; i0++) { 
+    if(fPuppiAlgo[i0].numAlgos() <= iOpt) continue;
+    getNeighbours(fPuppiAlgo[i0].coneSize(iOpt),fPuppiAlgo[i0].isCharged(iOpt));
+  }
+  //Compute the Puppi Metric, the particles are independent
+  fIterVals.resize(lNParticles);
+  int lNThreads = std::min(fNThreads, lNParticles/64);
+  if(lNThreads > 1) { 
+    std::vector<std::thread> lThreads;
+    for(int i0 = 0; i0 < lNThreads; i0++) { 
+      lThreads.push_back(std::thread(&PuppiContainer::computeVals,this,iOpt,
+        lNParticles*i0/lNThreads,lNParticles*(i0+1)/lNThreads));
+    }
+    for(int i0 = 0; i0 < lNThreads; i0++) lThreads[i0].join();
+  } else { 
+    computeVals(iOpt,0,lNParticles);
+  }
+  //Fill the algos in the particle order
+  for(int i0 = 0; i0 < lNParticles; i0++ ) { 
+    double pVal = fIterVals[i0];
+    int  pPupId = fPartPupId[i0];
     fVals.push_back(pVal);
-    if(std::isnan(pVal) || std::isinf(pVal)) cerr << "====> Value is Nan " << pVal << " == " << iConstits[i0].pt() << " -- " << iConstits[i0].eta() << endl;
+    if(pPupId == -1 || fPuppiAlgo[pPupId].numAlgos() <= iOpt) continue;
+    if(std::isnan(pVal) || std::isinf(pVal)) cerr << "====> Value is Nan " << pVal << " == " << fPartPt[i0] << " -- " << fPartEta[i0] << endl;
     if(std::isnan(pVal) || std::isinf(pVal)) continue;
-    fPuppiAlgo[pPupId].add(iConstits[i0],pVal,iOpt);
-    /*   eta extrapolation code
-        for(int i1 = 0; i1 < fNAlgos; i1++){
-            pAlgo    = fPuppiAlgo[i1].algoId   (iOpt);
-            pCharged = fPuppiAlgo[i1].isCharged(iOpt);
-            pCone    = fPuppiAlgo[i1].coneSize (iOpt);
-            double curVal = -1;
-            if(!pCharged) curVal = goodVar(iConstits[i0],iParticles       ,pAlgo,pCone);
-            if( pCharged) curVal = goodVar(iConstits[i0],iChargedParticles,pAlgo,pCone);
-            //std::cout << "i1 = " << i1 << ", curVal = " << curVal << ", eta = " << iConstits[i0].eta() << ", pupID = " << pPupId << std::endl;                                
-            fPuppiAlgo[i1].add(iConstits[i0],curVal,iOpt);
-        }
-    */
+    fPuppiAlgo[pPupId].add(fPFParticles[i0],pVal,iOpt);
   }
   for(int i0 = 0; i0 < fNAlgos; i0++) fPuppiAlgo[i0].computeMedRMS(iOpt,fPVFrac);
 }
@@ -137,7 +209,7 @@ double PuppiContainer::getChi2FromdZ(double iDZ) {
   lChi2PU*=lChi2PU;
   return lChi2PU;
 }
-const std::vector<double> PuppiContainer::puppiWeights() {
+const std::vector<double> &PuppiContainer::puppiWeights() {
   fPupParticles .resize(0);
   fWeights      .resize(0);
   fVals         .resize(0);
@@ -148,7 +220,7 @@ const std::vector<double> PuppiContainer::puppiWeights() {
   //Run through all compute mean and RMS
   int lNParticles    = fRecoParticles.size();
   for(int i0 = 0; i0 < lNMaxAlgo; i0++) { 
-    getRMSAvg(i0,fPFParticles,fPFParticles,fChargedPV);
+    getRMSAvg(i0);
   }
   std::vector<double> pVals;
   for(int i0 = 0; i0 < lNParticles; i0++) {
@@ -14,17 +14,38 @@ public:
     void initialize(const std::vector<RecoObj> &iRecoObjects);
     std::vector<fastjet::PseudoJet> pfParticles(){ return fPFParticles; }    
     std::vector<fastjet::PseudoJet> pvParticles(){ return fChargedPV; }        
-    const std::vector<double> puppiWeights();
-    std::vector<fastjet::PseudoJet> puppiParticles() { return fPupParticles;}
+    const std::vector<double> &puppiWeights();
+    const std::vector<fastjet::PseudoJet> &puppiParticles() { return fPupParticles;}
+    void setNumberOfThreads(int iNThreads) { fNThreads = iNThreads; }
 
 protected:
-    double  goodVar      (fastjet::PseudoJet &iPart,std::vector<fastjet::PseudoJet> &iParts, int iOpt,double iRCone);
-    void    getRMSAvg    (int iOpt,std::vector<fastjet::PseudoJet> &iConstits,std::vector<fastjet::PseudoJet> &iParticles,std::vector<fastjet::PseudoJet> &iChargeParticles);
+    // particles within a cone around each particle, one list per cone size
+    // and neighbour collection (all or charged from PV), shared by all algos
+    struct NeighbourList {
+      double cone;
+      bool   charged;
+      std::vector<int> offsets;
+      std::vector<int> indices;
+    };
+    const NeighbourList &getNeighbours(double iRCone,bool iCharged);
+    void    getRMSAvg    (int iOpt);
+    void    computeVals  (int iOpt,int iBegin,int iEnd);
     double  getChi2FromdZ(double iDZ);
     int     getPuppiId   (const float &iPt,const float &iEta);
-    double  var_within_R (int iId, const std::vector<fastjet::PseudoJet> & particles, const fastjet::PseudoJet& centre, double R);  
+    double  var_within_R (int iId, const NeighbourList &iNeighbours, int iCentre);
     
     std::vector<RecoObj>  fRecoParticles;
+    // particle kinematics as used by the metrics (structure of arrays)
+    std::vector<double>   fPartRap;
+    std::vector<double>   fPartPhi;
+    std::vector<double>   fPartEta;
+    std::vector<double>   fPartPt;
+    std::vector<bool>     fPartChargedPV;
+    std::vector<int>      fPartPupId;
+    std::vector<double>   fIterVals;
+    std::vector<NeighbourList> fNeighbours;
+    int    fNNeighbours;
+    int    fNThreads;
     std::vector<fastjet::PseudoJet> fPFParticles;
     std::vector<fastjet::PseudoJet> fChargedPV;
     std::vector<fastjet::PseudoJet> fPupParticles;
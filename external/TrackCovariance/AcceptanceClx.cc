@@ -53,6 +53,19 @@ AcceptanceClx::AcceptanceClx(TString InFile)
 	ReadAcceptance(InFile);
 }
 //
+AcceptanceClx::AcceptanceClx(TVectorF Pta, TVectorF Tha, TMatrixF Acc)
+{
+	// Acc has one row per pt node and one column per theta node
+	fNPtNodes = Pta.GetNrows();
+	fNThNodes = Tha.GetNrows();
+	fPtArray.ResizeTo(fNPtNodes);
+	fPtArray = Pta;
+	fThArray.ResizeTo(fNThNodes);
+	fThArray = Tha;
+	fAcc.ResizeTo(fNPtNodes, fNThNodes);
+	fAcc = Acc;
+}
+//
 AcceptanceClx::AcceptanceClx(SolGeom* InGeo)
 {
 	// Initializations
@@ -36,6 +36,7 @@ public:
 	// Constructors
 	AcceptanceClx(SolGeom *InGeo);				// Initialize arrays from geometry
 	AcceptanceClx(TString InFile);				// Initialize from acceptance file
+	AcceptanceClx(TVectorF Pta, TVectorF Tha, TMatrixF Acc);	// Initialize from arrays
 	// Destructor
 	~AcceptanceClx();
 	//
@@ -13,88 +13,57 @@
 // Constructors
 //
 // x(3) track origin, p(3) track momentum at origin, Q charge, B magnetic field in Tesla
-ObsTrk::ObsTrk(TVector3 x, TVector3 p, Double_t Q, SolGridCov *GC, SolGeom *G)
+ObsTrk::ObsTrk(TVector3 x, TVector3 p, Double_t Q, SolGridCov *GC, SolGeom *G) : fTrk(x, p, G)
 {
-	fB = G->B();
-	SetB(fB);
 	fG = G;
 	fGC = GC;
 	fGenX = x;
 	fGenP = p;
 	fGenQ = Q;
-	fEflag = kFALSE;		// Electron flag 
-	fEscale = 1.;			// Electron scale
-	fGenPar.ResizeTo(5);
-	fGenParMm.ResizeTo(5);
-	fGenParACTS.ResizeTo(6);
-	fGenParILC.ResizeTo(5);
-	fObsPar.ResizeTo(5);
-	fObsParMm.ResizeTo(5);
-	fObsParACTS.ResizeTo(6);
-	fObsParILC.ResizeTo(5);
-	fCov.ResizeTo(5, 5);
-	fCovMm.ResizeTo(5, 5);
-	fCovACTS.ResizeTo(6, 6);
-	fCovILC.ResizeTo(5, 5);
-	//
-	FillGen();
+	Init();
 	//
 	fCov = CovCalc(fGenPar);
-	fCovMm = CovToMm(fCov);
-	fCovACTS = CovToACTS(fObsPar, fCov);
-	fCovILC = CovToILC(fCov);
-	//
-	fObsDone = kFALSE;
+	fCovDone = kTRUE;
 }
 //
 // x[3] track origin, p[3] track momentum at origin, Q charge, B magnetic field in Tesla
-ObsTrk::ObsTrk(Double_t *x, Double_t *p, Double_t Q, SolGridCov* GC, SolGeom *G)
+ObsTrk::ObsTrk(Double_t *x, Double_t *p, Double_t Q, SolGridCov* GC, SolGeom *G) : fTrk(x, p, G)
 {
-	fB = G->B();
-	SetB(fB);
 	fG = G;
 	fGC = GC;
 	fGenX.SetXYZ(x[0],x[1],x[2]);
 	fGenP.SetXYZ(p[0],p[1],p[2]);
 	fGenQ = Q;
-	fEflag = kFALSE;		// Electron flag 
-	fEscale = 1.;			// Electron scale
-	fGenPar.ResizeTo(5);
-	fGenParMm.ResizeTo(5);
-	fGenParACTS.ResizeTo(6);
-	fGenParILC.ResizeTo(5);
-	fObsPar.ResizeTo(5);
-	fObsParMm.ResizeTo(5);
-	fObsParACTS.ResizeTo(6);
-	fObsParILC.ResizeTo(5);
-	fCov.ResizeTo(5, 5);
-	fCovMm.ResizeTo(5, 5);
-	fCovACTS.ResizeTo(6, 6);
-	fCovILC.ResizeTo(5, 5);
-	//
-	FillGen();
+	Init();
 	//
 	fCov = CovCalc(fGenPar);
-	fCovMm = CovToMm(fCov);
-	fCovACTS = CovToACTS(fObsPar, fCov);
-	fCovILC = CovToILC(fCov);
-	//
-	fObsDone = kFALSE;
+	fCovDone = kTRUE;
 }
 //
 // Kalman version with alwys direct calculation
 // Grid is not needed!
+// The Kalman filter only runs when the covariance or the number
+// of measurements is requested, so that the layer intersections
+// of fTrk can be used first to check the acceptance.
 //
-ObsTrk::ObsTrk(TVector3 x, TVector3 p, Double_t Q, Double_t mass, SolGeom *G)
+ObsTrk::ObsTrk(TVector3 x, TVector3 p, Double_t Q, Double_t mass, SolGeom *G) : fTrk(x, p, Q, G)
 {
-	fB = G->B();
-	SetB(fB);
 	fG = G;
+	fGC = 0;
 	fGenX = x;
 	fGenP = p;
 	fGenQ = Q;
+	fMass = mass;
+	Init();
+}
+//
+void ObsTrk::Init()
+{
+	fB = fG->B();
+	SetB(fB);
 	fEflag = kFALSE;		// Electron flag
 	fEscale = 1.;			// Electron scale
+	fNmeasure = 0;
 	fGenPar.ResizeTo(5);
 	fGenParMm.ResizeTo(5);
 	fGenParACTS.ResizeTo(6);
@@ -108,40 +77,40 @@ ObsTrk::ObsTrk(TVector3 x, TVector3 p, Double_t Q, Double_t mass, SolGeom *G)
 	fCovACTS.ResizeTo(6, 6);
 	fCovILC.ResizeTo(5, 5);
 	//
-	FillGen();
-	//
-	SolTrack trk(fGenX, fGenP, fGenQ, fG);
-	Bool_t Res = kTRUE;	// Turn resolution on
-	Bool_t MS  = kTRUE; // Turn multiple scattering on
-	//std::cout<<"ObsTrk: x input: x(0)= "<<x(0)*1.e20<<", x(1)= "<<x(1)*1.e20<<std::endl;
-	//std::cout<<"ObsTrk: Q= "<<Q<<", mass= "<<mass<<", p input:"<<std::endl; p.Print();
-	trk.KalmanCovT(Res, MS, mass);
-	fNmeasure = trk.GetUmeas();		// Available only after call to KalmanCov or KalmanCovT
-	fCov = trk.Cov();
-	fCovMm = CovToMm(fCov);
-	fCovACTS = CovToACTS(fObsPar, fCov);
-	fCovILC = CovToILC(fCov);
-	//
 	fObsDone = kFALSE;
+	fCovDone = kFALSE;
+	fFirstDone = kFALSE;
+	fGenFmtDone = kFALSE;
+	fObsFmtDone = kFALSE;
+	fCovFmtDone = kFALSE;
+	//
+	FillGen();
 }
+//
 void ObsTrk::FillGen()
 {
 // Fill Generated track arrays
 //
 	fGenPar = XPtoPar(fGenX, fGenP, fGenQ);
+}
+//
+void ObsTrk::FillGenFmt()
+{
+// Convert generated parameters to the other formats
+//
 	fGenParMm = ParToMm(fGenPar);
 	fGenParACTS = ParToACTS(fGenPar);
 	fGenParILC = ParToILC(fGenPar);
+	//
+	fGenFmtDone = kTRUE;
 }
 //
 void ObsTrk::FillObs()
 {
 // Fill Observed track arrays
 //
+	if(!fCovDone) FillCov();
 	fObsPar = TrkUtil::CovSmear(fGenPar, fCov);
-	fObsParMm = ParToMm(fObsPar);
-	fObsParACTS = ParToACTS(fObsPar);
-	fObsParILC = ParToILC(fObsPar);
 	fObsX = ParToX(fObsPar);
 	fObsP = ParToP(fObsPar);
 	fObsQ = ParToQ(fObsPar);
@@ -149,6 +118,54 @@ void ObsTrk::FillObs()
 	fObsDone = kTRUE;
 }
 //
+void ObsTrk::FillObsFmt()
+{
+// Convert observed parameters to the other formats
+//
+	if(!fObsDone) FillObs();
+	fObsParMm = ParToMm(fObsPar);
+	fObsParACTS = ParToACTS(fObsPar);
+	fObsParILC = ParToILC(fObsPar);
+	//
+	fObsFmtDone = kTRUE;
+}
+//
+void ObsTrk::FillCov()
+{
+// Kalman calculation of the covariance
+//
+	Bool_t Res = kTRUE;	// Turn resolution on
+	Bool_t MS  = kTRUE; // Turn multiple scattering on
+	fTrk.KalmanCovT(Res, MS, fMass);
+	fNmeasure = fTrk.GetUmeas();		// Available only after call to KalmanCov or KalmanCovT
+	fCov = fTrk.Cov();
+	//
+	fCovDone = kTRUE;
+}
+//
+void ObsTrk::FillCovFmt()
+{
+// Convert covariance to the other formats
+//
+	if(!fObsDone) FillObs();
+	fCovMm = CovToMm(fCov);
+	fCovACTS = CovToACTS(fObsPar, fCov);
+	fCovILC = CovToILC(fCov);
+	//
+	fCovFmtDone = kTRUE;
+}
+//
+void ObsTrk::FillFirst()
+{
+// First hit from the layer intersections of the generated track
+//
+	Double_t Xfirst, Yfirst, Zfirst;
+	fTrk.FirstHit(Xfirst, Yfirst, Zfirst);
+	fXfirst = TVector3(Xfirst, Yfirst, Zfirst);
+	//
+	fFirstDone = kTRUE;
+}
+//
 // Destructor
 ObsTrk::~ObsTrk()
 {
@@ -179,12 +196,11 @@ void ObsTrk::SetScale(Double_t scale)
 //
 	fEscale = scale;			// scale of resolution
 	if(!fEflag){ 
+		if(!fCovDone) FillCov();
 		fCov *= (fEscale*fEscale);	// Rescale covariance matrix
 		fEflag = kTRUE;				// Scaling flag 
-		// Update covariance matrix variants
-		fCovMm = CovToMm(fCov);
-		fCovACTS = CovToACTS(fObsPar, fCov);
-		fCovILC = CovToILC(fCov);
+		// Covariance matrix variants are updated on demand
+		fCovFmtDone = kFALSE;
 	}
 	else std::cout<<"ObsTrk::SetScale: Already called --> no action"<<std::endl;
 }
@@ -215,11 +231,8 @@ TMatrixDSym ObsTrk::CovCalc(TVectorD gPar)
 	Double_t ZinPos = fG->GetZminPos();
 	Double_t ZinNeg = fG->GetZminNeg();
 	Bool_t inside = TrkUtil::IsInside(fGenX, Rin, ZinNeg, ZinPos); // Check if in inner box
-	SolTrack* trk = new SolTrack(fGenX, fGenP, fG);
-	Double_t Xfirst, Yfirst, Zfirst;
-	Int_t iLay = trk->FirstHit(Xfirst, Yfirst, Zfirst);
-	fXfirst = TVector3(Xfirst, Yfirst, Zfirst);
-  //std::cout<<"obs trk: "<<Xfirst<<","<<Yfirst<<","<<Zfirst<<std::endl;
+	FillFirst();
+  //std::cout<<"obs trk: "<<fXfirst.X()<<","<<fXfirst.Y()<<","<<fXfirst.Z()<<std::endl;
 
 	if (inside)
 	{
@@ -235,10 +248,9 @@ TMatrixDSym ObsTrk::CovCalc(TVectorD gPar)
 		//std::cout<<"ObsTrk:: outside: x= "<<fGenX(0)<<", y= "<<fGenX(1)
                 //                         <<", z= "<<fGenX(2)<<std::endl;
 		Bool_t Res = kTRUE; Bool_t MS = kTRUE;
-		trk->CovCalc(Res, MS);					// Calculate covariance matrix
-		Cov = trk->Cov();
+		fTrk.CovCalc(Res, MS);					// Calculate covariance matrix
+		Cov = fTrk.Cov();
 	}					// Track covariance
-	delete trk;
 //
 	return Cov;
 }
@@ -8,6 +8,7 @@
 #include "SolGeom.h"
 #include "TrkUtil.h"
 #include "SolGridCov.h"
+#include "SolTrack.h"
 //
 // Class to handle smearing of generated charged particle tracks
 //
@@ -25,6 +26,8 @@ private:
 	Double_t fB;					// Solenoid magnetic field
 	SolGridCov* fGC;				// Covariance matrix grid
 	SolGeom*    fG;					// Tracker geometry
+	SolTrack fTrk;					// Generated track with its layer intersections
+	Double_t fMass;					// Mass for multiple scattering (Kalman version)
 	Double_t fGenQ;					// Generated track charge
 	Double_t fObsQ;					// Observed  track charge
 	TVector3 fGenX;					// Generated track origin (x,y,z)
@@ -50,11 +53,22 @@ private:
 	Bool_t fEflag;				// Electron flag
 	Double_t fEscale;			// Electron resolution degradation
 	Bool_t fObsDone;			// Flags completion of parameter generation
+	Bool_t fCovDone;			// Flags completion of covariance calculation
+	Bool_t fFirstDone;			// Flags completion of first hit search
+	Bool_t fGenFmtDone;			// Flags completion of generated mm, ACTS and ILC parameters
+	Bool_t fObsFmtDone;			// Flags completion of observed mm, ACTS and ILC parameters
+	Bool_t fCovFmtDone;			// Flags completion of mm, ACTS and ILC covariances
 	//
 	// Service routines
 	//
+	void Init();				// Common part of the constructors
 	void FillGen();				// Fill generated arrays
 	void FillObs();				// Fill observed arrays
+	void FillCov();				// Kalman covariance calculation
+	void FillFirst();			// Find first hit
+	void FillGenFmt();			// Convert generated parameters
+	void FillObsFmt();			// Convert observed parameters
+	void FillCovFmt();			// Convert covariance
 	TVectorD GenToObsPar(TVectorD gPar);	// Extract observed parameters
 	TMatrixDSym CovCalc(TVectorD gPar);	// Calculate covariance matrix
 	//
@@ -77,11 +91,14 @@ public:
 	TVector3 GetGenP()	{ return fGenP; }
 	// D, phi0, C, z0, cot(th)
 	TVectorD GetGenPar()	{ return fGenPar; }		// in meters
-	TVectorD GetGenParMm()	{ return fGenParMm; }		// in mm
+	TVectorD GetGenParMm()	{ if(!fGenFmtDone) FillGenFmt();
+				  return fGenParMm; }		// in mm
 	// D, z0, phi0, theta, q/p, time
-	TVectorD GetGenParACTS()	{ return fGenParACTS; }
+	TVectorD GetGenParACTS(){ if(!fGenFmtDone) FillGenFmt();
+				  return fGenParACTS; }
 	// d0, phi0, w, z0, tan(lambda)
-	TVectorD GetGenParILC()	{ return fGenParILC; }
+	TVectorD GetGenParILC()	{ if(!fGenFmtDone) FillGenFmt();
+				  return fGenParILC; }
 	//
 	// Observed level X, P, Q
 	Double_t GetObsQ()	{ if(!fObsDone) FillObs();
@@ -93,22 +110,30 @@ public:
 	// D, phi0, C, z0, cot(th)
 	TVectorD GetObsPar()	{ if(!fObsDone) FillObs();
 				  return fObsPar; }		// in meters
-	TVectorD GetObsParMm()	{ if(!fObsDone) FillObs();
+	TVectorD GetObsParMm()	{ if(!fObsFmtDone) FillObsFmt();
 				  return fObsParMm; }		// In mm
 	// D, z0, phi0, theta, q/p, time
-	TVectorD GetObsParACTS(){ if(!fObsDone) FillObs();
+	TVectorD GetObsParACTS(){ if(!fObsFmtDone) FillObsFmt();
 				  return fObsParACTS; }
 	// d0, phi0, w, z0, tan(lambda)
-	TVectorD GetObsParILC()	{ if(!fObsDone) FillObs();
+	TVectorD GetObsParILC()	{ if(!fObsFmtDone) FillObsFmt();
 				  return fObsParILC; }
 	// Covariances
-	TMatrixDSym GetCov()	{ return fCov; }	// in meters
-	TMatrixDSym GetCovMm()	{ return fCov; }	// in mm
-	TMatrixDSym GetCovACTS(){ return fCovACTS; }
-	TMatrixDSym GetCovILC() { return fCovILC; }
+	TMatrixDSym GetCov()	{ if(!fCovDone) FillCov();
+				  return fCov; }	// in meters
+	TMatrixDSym GetCovMm()	{ if(!fCovFmtDone) FillCovFmt();
+				  return fCovMm; }	// in mm
+	TMatrixDSym GetCovACTS(){ if(!fCovFmtDone) FillCovFmt();
+				  return fCovACTS; }
+	TMatrixDSym GetCovILC() { if(!fCovFmtDone) FillCovFmt();
+				  return fCovILC; }
 	// First hit
-	TVector3 GetFirstHit()  { return fXfirst; }
-	Int_t GetUmeas() { return fNmeasure;}	// #used measurement including layer efficiency
+	TVector3 GetFirstHit()  { if(!fFirstDone) FillFirst();
+				  return fXfirst; }
+	Int_t GetUmeas() { if(!fCovDone) FillCov();
+			   return fNmeasure;}	// #used measurement including layer efficiency
+	// Generated track, layer intersections are computed only once
+	SolTrack *GetTrack()	{ return &fTrk; }
 	// Set resolution degradation scale
 	void SetScale(Double_t scale);
 };
@@ -28,6 +28,7 @@ SolGridCov::SolGridCov()
   Double_t a[] = { 10., 15., 20., 25., 30., 35., 40., 45., 50., 60., 70., 80., 90. };
   for (Int_t ia = 0; ia < fNang; ia++) fAnga(ia) = a[ia];
   fCov = new TMatrixDSym[fNpt * fNang];
+  fAcc = 0;
   for (Int_t ip = 0; ip < fNpt; ip++)
   {
     for (Int_t ia = 0; ia < fNang; ia++) fCov[ip * fNang + ia].ResizeTo(5, 5);
@@ -64,6 +65,57 @@ void SolGridCov::Calc(SolGeom *G)
 // Now make acceptance
 fAcc = new AcceptanceClx(G);
 }
+//
+// Flat array layout: grid size, covariance grid, then acceptance pt and
+// theta node numbers, pt nodes, theta nodes and acceptance matrix
+//
+void SolGridCov::Pack(std::vector<Double_t> &Buffer)
+{
+  Buffer.clear();
+  Buffer.push_back(fNpt);
+  Buffer.push_back(fNang);
+  for (Int_t ig = 0; ig < fNpt * fNang; ig++)
+  {
+    const Double_t *cv = fCov[ig].GetMatrixArray();
+    Buffer.insert(Buffer.end(), cv, cv + 25);
+  }
+  if (!fAcc) return;
+  Int_t Npt = fAcc->GetNrPt();
+  Int_t Nth = fAcc->GetNrTh();
+  Buffer.push_back(Npt);
+  Buffer.push_back(Nth);
+  for (Int_t i = 0; i < Npt; i++) Buffer.push_back((*fAcc->GetPtArray())(i));
+  for (Int_t i = 0; i < Nth; i++) Buffer.push_back((*fAcc->GetThArray())(i));
+  const Float_t *acc = fAcc->GetAccMatrix()->GetMatrixArray();
+  Buffer.insert(Buffer.end(), acc, acc + Npt * Nth);
+}
+//
+Bool_t SolGridCov::Unpack(const Double_t *Buffer, Long64_t Size)
+{
+  Long64_t Ncov = 25 * fNpt * fNang;
+  if (Size < Ncov + 4) return kFALSE;
+  if (TMath::Nint(Buffer[0]) != fNpt || TMath::Nint(Buffer[1]) != fNang) return kFALSE;
+  Buffer += 2;
+  Size -= 2;
+  Int_t Npt = TMath::Nint(Buffer[Ncov]);
+  Int_t Nth = TMath::Nint(Buffer[Ncov + 1]);
+  if (Npt < 2 || Nth < 2 || Size != Ncov + 2 + Npt + Nth + Long64_t(Npt) * Nth) return kFALSE;
+  //
+  // the grid matrices point into the buffer, which may be a read-only file mapping
+  for (Int_t ig = 0; ig < fNpt * fNang; ig++) fCov[ig].Use(5, const_cast<Double_t *>(Buffer + 25 * ig));
+  const Double_t *b = Buffer + Ncov + 2;
+  TVectorF Pta(Npt);
+  for (Int_t i = 0; i < Npt; i++) Pta(i) = *b++;
+  TVectorF Tha(Nth);
+  for (Int_t i = 0; i < Nth; i++) Tha(i) = *b++;
+  TMatrixF Acc(Npt, Nth);
+  Float_t *acc = Acc.GetMatrixArray();
+  for (Int_t i = 0; i < Npt * Nth; i++) acc[i] = *b++;
+  //
+  delete fAcc;
+  fAcc = new AcceptanceClx(Pta, Tha, Acc);
+  return kTRUE;
+}
 
 
 //
@@ -119,13 +171,23 @@ Bool_t SolGridCov::IsAccepted(TVector3 x, TVector3 p, SolGeom* G)
 	if (inside) Accept = IsAccepted(p);
 	else
 	{
-		SolTrack* trk = new SolTrack(x, p, G);
-		if (trk->nmHit() >= fNminHits)Accept = kTRUE;
-		delete trk;
+		SolTrack trk(x, p, G);
+		Accept = IsAccepted(&trk);
 	}
 	//
 	return Accept;
 }
+//
+// Acceptance of a track outside the inner box, the intersections
+// are kept in the track for a later covariance calculation
+//
+Bool_t SolGridCov::IsAccepted(SolTrack *trk)
+{
+	Bool_t Accept = kFALSE;
+	if (trk->nmHit() >= fNminHits)Accept = kTRUE;
+	//
+	return Accept;
+}
 
 //
 // Find bin in grid
@@ -3,9 +3,11 @@
 
 #include <TVectorD.h>
 #include <TMatrixDSym.h>
+#include <vector>
 #include "AcceptanceClx.h"
 
 class SolGeom;
+class SolTrack;
 
 // Class to create geometry for solenoid geometry
 
@@ -28,6 +30,14 @@ public:
 
   void Calc(SolGeom *G);
 
+  // Store/restore covariance grid and acceptance as a flat array (caching).
+  // Unpack does not copy the covariance grid, which is read from Buffer
+  // as long as this object exists; the acceptance map is copied.
+  // Increase the version when the grid, its calculation or the layout change.
+  static Int_t GetPackVersion() { return 2; }
+  void Pack(std::vector<Double_t> &Buffer);
+  Bool_t Unpack(const Double_t *Buffer, Long64_t Size);
+
   // Covariance interpolation
   Double_t GetMinPt()  { return fPta(0); }
   Double_t GetMaxPt()  { return fPta(fNpt - 1); }
@@ -43,6 +53,7 @@ public:
 	Bool_t IsAccepted(Double_t *p);					// From momentum components (GeV)
 	Bool_t IsAccepted(TVector3 p);					// As above in Vector3 format
 	Bool_t IsAccepted(TVector3 x, TVector3 p, SolGeom *G);		// As above checking track origin
+	Bool_t IsAccepted(SolTrack *trk);				// From the layer intersections of a track
 
 };
 
@@ -38,6 +38,7 @@ SolTrack::SolTrack(Double_t *x, Double_t *p, SolGeom *G)
 	// Init covariances
 	//
 	fCov.ResizeTo(5, 5);
+	fHitsDone = kFALSE;
 }
 SolTrack::SolTrack(TVector3 x, TVector3 p, Double_t Charge, SolGeom* G)
 {
@@ -64,6 +65,7 @@ SolTrack::SolTrack(TVector3 x, TVector3 p, Double_t Charge, SolGeom* G)
 	// Init covariances
 	//
 	fCov.ResizeTo(5, 5);
+	fHitsDone = kFALSE;
 }
 SolTrack::SolTrack(TVector3 x, TVector3 p, SolGeom* G)
 {
@@ -93,6 +95,7 @@ SolTrack::SolTrack(TVector3 x, TVector3 p, SolGeom* G)
 	// Init covariances
 	//
 	fCov.ResizeTo(5, 5);
+	fHitsDone = kFALSE;
 }
 //
 SolTrack::SolTrack(Double_t D, Double_t phi0, Double_t C, Double_t z0, Double_t ct, SolGeom *G)
@@ -120,6 +123,7 @@ SolTrack::SolTrack(Double_t D, Double_t phi0, Double_t C, Double_t z0, Double_t
 	// Init covariances
 	//
 	fCov.ResizeTo(5, 5);
+	fHitsDone = kFALSE;
 }
 // Destructor
 SolTrack::~SolTrack()
@@ -189,38 +193,58 @@ Bool_t SolTrack::HitLayer(Int_t il, Double_t &R, Double_t &phi, Double_t &zz)
 	return val;
 }
 //
-// # of layers hit
-Int_t SolTrack::nHit()
+// Intersections with all layers
+void SolTrack::FillHits()
 {
-	Int_t kh = 0;
+	fHitLay.clear();
+	fHitR.clear();
+	fHitPhi.clear();
+	fHitZ.clear();
+	fNmHit = 0;
+	fNMeas = 0;
+	//
 	Double_t R; Double_t phi; Double_t zz;
 	for (Int_t i = 0; i < fG->Nl(); i++)
-	if (HitLayer(i, R, phi, zz))kh++;
+	{
+		if (HitLayer(i, R, phi, zz))
+		{
+			fHitLay.push_back(i);
+			fHitR.push_back(R);
+			fHitPhi.push_back(phi);
+			fHitZ.push_back(zz);
+			if (fG->isMeasure(i))
+			{
+				fNmHit++;
+				fNMeas += fG->lND(i);
+			}
+		}
+	}
 	//
-	return kh;
+	fHitsDone = kTRUE;
+}
+//
+// # of layers hit
+Int_t SolTrack::nHit()
+{
+	if (!fHitsDone) FillHits();
+	//
+	return fHitLay.size();
 }
 //
 // # of measurement layers hit
 Int_t SolTrack::nmHit()
 {
-	Int_t kmh = 0;
-	Double_t R; Double_t phi; Double_t zz;
-	for (Int_t i = 0; i < fG->Nl(); i++)
-	if (HitLayer(i, R, phi, zz))if (fG->isMeasure(i))kmh++;
+	if (!fHitsDone) FillHits();
 	//
-	return kmh;
+	return fNmHit;
 }
 //
 // # of measurement
 Int_t SolTrack::nMeas()
 {
-	Int_t kmh = 0;
-	Double_t R; Double_t phi; Double_t zz;
-	for (Int_t i = 0; i < fG->Nl(); i++)
-	if (HitLayer(i, R, phi, zz))
-		if (fG->isMeasure(i))kmh += fG->lND(i);
+	if (!fHitsDone) FillHits();
 	//
-	return kmh;
+	return fNMeas;
 }
 //
 // List of layers hit with intersections
@@ -236,22 +260,16 @@ Int_t SolTrack::HitList(Int_t *&ihh, Double_t *&rhh, Double_t *&zhh)
 	//
 	// ***** NB: double layers with stereo on lower layer not included
 	//
-	Int_t kh = 0;	// Number of layers hit
-	Int_t kmh = 0;  // Number of measurement layers of given type
-	for (Int_t i = 0; i < fG->Nl(); i++)
+	if (!fHitsDone) FillHits();
+	//
+	for (UInt_t kh = 0; kh < fHitLay.size(); kh++)
 	{
-		Double_t R; Double_t phi; Double_t zz;
-		if (HitLayer(i, R, phi, zz))
-		{
-			zhh[kh] = zz;
-			rhh[kh] = R;
-			ihh[kh] = i;
-			if (fG->isMeasure(i))kmh++;
-			kh++;
-		}
+		zhh[kh] = fHitZ[kh];
+		rhh[kh] = fHitR[kh];
+		ihh[kh] = fHitLay[kh];
 	}
 	//
-	return kmh;
+	return fNmHit;
 }
 Int_t SolTrack::HitList(Int_t *&ihh, Double_t *&rhh, Double_t *&phh, Double_t *&zhh)
 {
@@ -266,23 +284,17 @@ Int_t SolTrack::HitList(Int_t *&ihh, Double_t *&rhh, Double_t *&phh, Double_t *&
 	//
 	// ***** NB: double layers with stereo on lower layer not included
 	//
-	Int_t kh = 0;	// Number of layers hit
-	Int_t kmh = 0;  // Number of measurement layers of given type
-	for (Int_t i = 0; i < fG->Nl(); i++)
+	if (!fHitsDone) FillHits();
+	//
+	for (UInt_t kh = 0; kh < fHitLay.size(); kh++)
 	{
-		Double_t R; Double_t phi; Double_t zz;
-		if (HitLayer(i, R, phi, zz))
-		{
-			zhh[kh] = zz;
-			rhh[kh] = R;
-			phh[kh] = phi;
-			ihh[kh] = i;
-			if (fG->isMeasure(i))kmh++;
-			kh++;
-		}
+		zhh[kh] = fHitZ[kh];
+		rhh[kh] = fHitR[kh];
+		phh[kh] = fHitPhi[kh];
+		ihh[kh] = fHitLay[kh];
 	}
 	//
-	return kmh;
+	return fNmHit;
 }
 //
 // List of XYZ measurements without any error
@@ -296,20 +308,19 @@ Int_t SolTrack::HitListXYZ(Int_t *&ihh, Double_t *&Xh, Double_t *&Yh, Double_t *
 	// Xh, Yh, Zh = X, Y, Z of hit - No measurement error - No multiple scattering
 	//
 	//
+	if (!fHitsDone) FillHits();
+	//
 	Int_t kmh = 0;  // Number of measurement layers hit
-	for (Int_t i = 0; i < fG->Nl(); i++)
+	for (UInt_t kh = 0; kh < fHitLay.size(); kh++)
 	{
-		Double_t R; Double_t phi; Double_t zz;
-		if (HitLayer(i, R, phi, zz)) // Only barrel type layers
+		Int_t i = fHitLay[kh];
+		if (fG->isMeasure(i))
 		{
-			if (fG->isMeasure(i))
-			{
-				ihh[kmh] = i;
-				Xh[kmh] = R*cos(phi);
-				Yh[kmh] = R*sin(phi);
-				Zh[kmh] = zz;
-				kmh++;
-			}
+			ihh[kmh] = i;
+			Xh[kmh] = fHitR[kh]*cos(fHitPhi[kh]);
+			Yh[kmh] = fHitR[kh]*sin(fHitPhi[kh]);
+			Zh[kmh] = fHitZ[kh];
+			kmh++;
 		}
 	}
 	//
@@ -8,6 +8,7 @@
 #include "SolGeom.h"
 #include "TrkUtil.h"
 #include <TGraph.h>
+#include <vector>
 //
 //
 // Class to store track information
@@ -29,6 +30,16 @@ private:
 	TMatrixDSym fCov;		// Full covariance matrix
 	Int_t fNmeasure;		// Number of measurements used (account for layer efficiency)
 	//
+	// Layer intersections, computed once on first use
+	Bool_t fHitsDone;			// Flags completion of intersection calculation
+	std::vector<Int_t> fHitLay;		// Layers hit
+	std::vector<Double_t> fHitR;		// Radius of hit
+	std::vector<Double_t> fHitPhi;		// Phi of hit
+	std::vector<Double_t> fHitZ;		// z of hit
+	Int_t fNmHit;				// Nr. of measurement layers hit
+	Int_t fNMeas;				// Nr. of measurements
+	void FillHits();			// Fill intersection lists
+	//
 public:
 	//
 	// Constructors
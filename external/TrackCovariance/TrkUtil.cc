@@ -1192,6 +1192,7 @@ Double_t TrkUtil::Nclusters(Double_t begam, Int_t Opt) {
 	Double_t interp = 0.0;
 	TSpline3* sp3 = new TSpline3("sp3", bg, ncl, Npt);
 	if (begam > bg[0] && begam < bg[Npt - 1]) interp = sp3->Eval(begam);
+	delete sp3;
 	return 100 * interp;
 }
 //
@@ -26,6 +26,7 @@
 
 #include "modules/AngularSmearing.h"
 
+#include "classes/DelphesCandidateBatch.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
@@ -55,6 +56,7 @@ AngularSmearing::AngularSmearing()
 {
   fFormulaEta = new DelphesFormula;
   fFormulaPhi = new DelphesFormula;
+  fBatch = new DelphesCandidateBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -63,6 +65,7 @@ AngularSmearing::~AngularSmearing()
 {
   delete fFormulaEta;
   delete fFormulaPhi;
+  delete fBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -96,24 +99,43 @@ void AngularSmearing::Finish()
 void AngularSmearing::Process()
 {
   Candidate *candidate, *mother;
-  Double_t pt, eta, phi, e, m;
+  Double_t pt, eta, phi, m;
+  Int_t i, size;
+
+  fBatch->Clear();
 
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
   {
     const TLorentzVector &candidateMomentum = candidate->Momentum;
-    eta = candidateMomentum.Eta();
-    phi = candidateMomentum.Phi();
-    pt = candidateMomentum.Pt();
-    e = candidateMomentum.E();
-    m = candidateMomentum.M();
+    fBatch->Add(candidate, candidateMomentum.Pt(), candidateMomentum.Eta(), candidateMomentum.Phi(), candidateMomentum.E());
+  }
+
+  size = fBatch->GetSize();
 
-    // apply smearing formula for eta,phi
-    eta = gRandom->Gaus(eta, fFormulaEta->Eval(pt, eta, phi, e, candidate));
-    phi = gRandom->Gaus(phi, fFormulaPhi->Eval(pt, eta, phi, e, candidate));
+  // two random numbers per candidate, drawn in the order eta, phi
+  fBatch->DrawGaus(2 * size);
+
+  // apply smearing formula for eta
+  fBatch->Evaluate(fFormulaEta);
+  for(i = 0; i < size; ++i)
+  {
+    fBatch->Eta[i] += fBatch->Values[i] * fBatch->Random[2 * i];
+  }
+
+  // apply smearing formula for phi using the smeared eta
+  fBatch->Evaluate(fFormulaPhi);
+  for(i = 0; i < size; ++i)
+  {
+    candidate = fBatch->Candidates[i];
+    pt = fBatch->PT[i];
+    eta = fBatch->Eta[i];
+    phi = fBatch->Phi[i] + fBatch->Values[i] * fBatch->Random[2 * i + 1];
 
     if(pt <= 0.0) continue;
 
+    m = candidate->Momentum.M();
+
     mother = candidate;
     candidate = static_cast<Candidate *>(candidate->Clone());
     candidate->Momentum.SetPtEtaPhiM(pt, eta, phi, m);
@@ -32,6 +32,7 @@
 class TIterator;
 class TObjArray;
 class DelphesFormula;
+class DelphesCandidateBatch;
 
 class AngularSmearing: public DelphesModule
 {
@@ -47,6 +48,8 @@ private:
   DelphesFormula *fFormulaEta = nullptr; //!
   DelphesFormula *fFormulaPhi = nullptr; //!
 
+  DelphesCandidateBatch *fBatch = nullptr; //!
+
   TIterator *fItInputArray = nullptr; //!
 
   const TObjArray *fInputArray = nullptr; //!
@@ -22,6 +22,13 @@
  *  applies b-tagging efficiency (miss identification rate) formulas
  *  and sets b-tagging flags
  *
+ *  With UseWeights set to true, the b-tagging flag is set for all jets
+ *  with a non-zero efficiency and the efficiencies are stored in BTagWeights
+ *  for BitNumber, followed by the efficiencies of EfficiencyFormula<name>
+ *  for each name of the global WeightVariations.  Flavors missing in a
+ *  variation use the nominal formulas.  Weights are only computed for the
+ *  default flavor definition, BTagAlgo and BTagPhys are still drawn.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -64,9 +71,9 @@ BTagging::~BTagging()
 void BTagging::Init()
 {
   map<Int_t, DelphesFormula *>::iterator itEfficiencyMap;
-  ExRootConfParam param;
+  ExRootConfParam param, variation;
   DelphesFormula *formula;
-  Int_t i, size;
+  Int_t i, j, size;
 
   fBitNumber = GetInt("BitNumber", 0);
 
@@ -93,6 +100,27 @@ void BTagging::Init()
     fEfficiencyMap[0] = formula;
   }
 
+  // read efficiency formulas of the variations
+  fUseWeights = GetBool("UseWeights", false);
+
+  param = GetWeightVariations();
+  size = param.GetSize();
+
+  fVariationMaps.clear();
+  for(j = 0; fUseWeights && j < size; ++j)
+  {
+    fVariationMaps.push_back(map<Int_t, DelphesFormula *>());
+
+    variation = GetParam(Form("EfficiencyFormula%s", param[j].GetString()));
+    for(i = 0; i < variation.GetSize() / 2; ++i)
+    {
+      formula = new DelphesFormula;
+      formula->Compile(variation[i * 2 + 1].GetString());
+
+      fVariationMaps.back()[variation[i * 2].GetInt()] = formula;
+    }
+  }
+
   // import input array(s)
 
   fJetInputArray = ImportArray(GetString("JetInputArray", "FastJetFinder/jets"));
@@ -113,6 +141,15 @@ void BTagging::Finish()
     formula = itEfficiencyMap->second;
     if(formula) delete formula;
   }
+
+  vector<map<Int_t, DelphesFormula *> >::iterator itVariationMaps;
+  for(itVariationMaps = fVariationMaps.begin(); itVariationMaps != fVariationMaps.end(); ++itVariationMaps)
+  {
+    for(itEfficiencyMap = itVariationMaps->begin(); itEfficiencyMap != itVariationMaps->end(); ++itEfficiencyMap)
+    {
+      delete itEfficiencyMap->second;
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -122,6 +159,7 @@ void BTagging::Process()
   Candidate *jet;
   Double_t pt, eta, phi, e;
   map<Int_t, DelphesFormula *>::iterator itEfficiencyMap;
+  vector<map<Int_t, DelphesFormula *> >::iterator itVariationMaps;
   DelphesFormula *formula;
 
   // loop over all input jets
@@ -143,7 +181,24 @@ void BTagging::Process()
     formula = itEfficiencyMap->second;
 
     // apply an efficiency formula
-    jet->BTag |= (gRandom->Uniform() <= formula->Eval(pt, eta, phi, e)) << fBitNumber;
+    if(fUseWeights)
+    {
+      fWeights.clear();
+      fWeights.push_back(formula->Eval(pt, eta, phi, e));
+
+      for(itVariationMaps = fVariationMaps.begin(); itVariationMaps != fVariationMaps.end(); ++itVariationMaps)
+      {
+        itEfficiencyMap = itVariationMaps->find(jet->Flavor);
+        fWeights.push_back((itEfficiencyMap != itVariationMaps->end() ? itEfficiencyMap->second : formula)->Eval(pt, eta, phi, e));
+      }
+
+      jet->SetBTagWeights(fBitNumber, fWeights);
+      jet->BTag |= (*max_element(fWeights.begin(), fWeights.end()) > 0.0) << fBitNumber;
+    }
+    else
+    {
+      jet->BTag |= (gRandom->Uniform() <= formula->Eval(pt, eta, phi, e)) << fBitNumber;
+    }
 
     // find an efficiency formula for algo flavor definition
     itEfficiencyMap = fEfficiencyMap.find(jet->FlavorAlgo);
@@ -153,7 +208,7 @@ void BTagging::Process()
     }
     formula = itEfficiencyMap->second;
 
-    // apply an efficiency formula
+    // apply an efficiency formula, also with UseWeights
     jet->BTagAlgo |= (gRandom->Uniform() <= formula->Eval(pt, eta, phi, e)) << fBitNumber;
 
     // find an efficiency formula for phys flavor definition
@@ -164,7 +219,7 @@ void BTagging::Process()
     }
     formula = itEfficiencyMap->second;
 
-    // apply an efficiency formula
+    // apply an efficiency formula, also with UseWeights
     jet->BTagPhys |= (gRandom->Uniform() <= formula->Eval(pt, eta, phi, e)) << fBitNumber;
   }
 }
@@ -25,6 +25,13 @@
  *  applies b-tagging efficiency (miss identification rate) formulas
  *  and sets b-tagging flags 
  *
+ *  With UseWeights set to true, the b-tagging flag is set for all jets
+ *  with a non-zero efficiency and the efficiencies are stored in BTagWeights
+ *  for BitNumber, followed by the efficiencies of EfficiencyFormula<name>
+ *  for each name of the global WeightVariations.  Flavors missing in a
+ *  variation use the nominal formulas.  Weights are only computed for the
+ *  default flavor definition, BTagAlgo and BTagPhys are still drawn.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -32,6 +39,7 @@
 #include "classes/DelphesModule.h"
 
 #include <map>
+#include <vector>
 
 class TObjArray;
 class DelphesFormula;
@@ -49,8 +57,14 @@ public:
 private:
   Int_t fBitNumber;
 
+  Bool_t fUseWeights;
+
 #if !defined(__CINT__) && !defined(__CLING__)
   std::map<Int_t, DelphesFormula *> fEfficiencyMap; //!
+
+  std::vector<std::map<Int_t, DelphesFormula *> > fVariationMaps; //!
+
+  std::vector<Double_t> fWeights; //!
 #endif
 
   TIterator *fItJetInputArray = nullptr; //!
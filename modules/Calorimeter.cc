@@ -166,6 +166,9 @@ void Calorimeter::Init()
   fECalResolutionFormula->Compile(GetString("ECalResolutionFormula", "0"));
   fHCalResolutionFormula->Compile(GetString("HCalResolutionFormula", "0"));
 
+  TabulateFormula(fECalResolutionFormula, "ECalResolutionMap", kTRUE);
+  TabulateFormula(fHCalResolutionFormula, "HCalResolutionMap", kTRUE);
+
   // import array with output from other modules
   fParticleInputArray = ImportArray(GetString("ParticleInputArray", "ParticlePropagator/particles"));
   fItParticleInputArray = fParticleInputArray->MakeIterator();
@@ -180,6 +183,8 @@ void Calorimeter::Init()
   fEFlowTrackOutputArray = ExportArray(GetString("EFlowTrackOutputArray", "eflowTracks"));
   fEFlowPhotonOutputArray = ExportArray(GetString("EFlowPhotonOutputArray", "eflowPhotons"));
   fEFlowNeutralHadronOutputArray = ExportArray(GetString("EFlowNeutralHadronOutputArray", "eflowNeutralHadrons"));
+
+  SetInputReadOnly(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -34,31 +34,44 @@
 #include "TLorentzVector.h"
 #include "TMath.h"
 #include "TObjArray.h"
-#include "TVectorD.h"
+#include "TRandom3.h"
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
 
 using namespace std;
 
 //------------------------------------------------------------------------------
 
+// range of the Nclusters(beta*gamma) parametrization in TrkUtil
+static const Double_t kBGMin = 0.5;
+static const Double_t kBGMax = 10000.0;
+static const Int_t kTableSize = 4096;
+
+// relative distance of the first and last samples from the ends of the range
+static const Double_t kBGEdge = 1.0e-9;
+
+//------------------------------------------------------------------------------
+
 ClusterCounting::ClusterCounting()
 {
-  fTrackUtil = new TrkUtil();
 }
 
 //------------------------------------------------------------------------------
 
 ClusterCounting::~ClusterCounting()
 {
-  delete fTrackUtil;
 }
 
 //------------------------------------------------------------------------------
 
 void ClusterCounting::Init()
 {
+  stringstream message;
+  Double_t bg, expected;
+  Int_t i;
 
   // geometric acceptance
   fRmin = GetDouble("Rmin", 0.);
@@ -76,10 +89,50 @@ void ClusterCounting::Init()
   // 3:  Argon 100
   fGasOption = GetInt("GasOption", 0);
 
-  // initialize drift chamber geometry and gas mix
-  fTrackUtil->SetBfield(fBz);
-  fTrackUtil->SetDchBoundaries(fRmin, fRmax, fZmin, fZmax);
-  fTrackUtil->SetGasMix(fGasOption);
+  if(fGasOption < 0 || fGasOption > 3)
+  {
+    cout << "** WARNING: gas option " << fGasOption << " not allowed, using option 0" << endl;
+    fGasOption = 0;
+  }
+
+  if(fZmin == 0.0 && fZmax == 0.0)
+  {
+    cout << "** WARNING: no drift chamber volume defined, no clusters will be counted" << endl;
+  }
+
+  if(fBz == 0.0)
+  {
+    cout << "** WARNING: Bz not set, no clusters will be counted" << endl;
+  }
+
+  // tabulate the spline interpolation of the number of clusters per meter
+  fLogBGMin = TMath::Log(kBGMin);
+  fLogBGMax = TMath::Log(kBGMax);
+  fInvLogBGStep = kTableSize / (fLogBGMax - fLogBGMin);
+
+  // TrkUtil::Nclusters returns 0 at the ends of its range, which are
+  // therefore sampled slightly inside
+  fNclustersTable.resize(kTableSize + 1);
+  for(i = 0; i <= kTableSize; ++i)
+  {
+    bg = TMath::Exp(fLogBGMin + i / fInvLogBGStep);
+    if(i == 0) bg = kBGMin * (1.0 + kBGEdge);
+    if(i == kTableSize) bg = kBGMax * (1.0 - kBGEdge);
+    fNclustersTable[i] = TrkUtil::Nclusters(bg, fGasOption);
+  }
+
+  // the table must follow the spline up to both ends
+  for(i = 0; i < 2; ++i)
+  {
+    bg = i == 0 ? kBGMin * (1.0 + 1.0e-3) : kBGMax * (1.0 - 1.0e-3);
+    expected = TrkUtil::Nclusters(bg, fGasOption);
+    if(!(TMath::Abs(GetNclusters(bg) - expected) <= 1.0e-2 * expected))
+    {
+      message << "cluster count table differs from TrkUtil::Nclusters at beta*gamma = " << bg;
+      message << " in module '" << GetName() << "'";
+      throw runtime_error(message.str());
+    }
+  }
 
   // import input array
   fInputArray = ImportArray(GetString("InputArray", "TrackMerger/tracks"));
@@ -98,41 +151,174 @@ void ClusterCounting::Finish()
 
 //------------------------------------------------------------------------------
 
+Double_t ClusterCounting::GetNclusters(Double_t bg) const
+{
+  Double_t x;
+  Int_t i;
+
+  if(bg <= kBGMin || bg >= kBGMax) return 0.0;
+
+  x = (TMath::Log(bg) - fLogBGMin) * fInvLogBGStep;
+  i = TMath::Min(Int_t(x), kTableSize - 1);
+  x -= i;
+
+  return (1.0 - x) * fNclustersTable[i] + x * fNclustersTable[i + 1];
+}
+
+//------------------------------------------------------------------------------
+
+Double_t ClusterCounting::TrackLength(Double_t D, Double_t C, Double_t z0, Double_t ct) const
+{
+  // track length inside the chamber volume, see TrkUtil::TrkLen
+
+  Double_t phases[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+  Double_t rTop, ph, ph2, z, zDir, rInt, opCD, halfSin;
+  Int_t i, iPos;
+
+  if(fZmin == 0.0 && fZmax == 0.0) return 0.0;
+
+  opCD = 1.0 + 2.0 * C * D;
+  rTop = TMath::Abs((1.0 + C * D) / C);
+
+  // inner cylinder, including the second branch of loopers
+  if(rTop > fRmin && TMath::Abs(D) < fRmin)
+  {
+    ph = 2.0 * TMath::ASin(C * TMath::Sqrt((fRmin * fRmin - D * D) / opCD));
+    z = z0 + ct * ph / (2.0 * C);
+    if(z < fZmax && z > fZmin) phases[0] = TMath::Abs(ph);
+
+    ph2 = TMath::TwoPi() - TMath::Abs(ph);
+    if(ph < 0) ph2 = -ph2;
+    z = z0 + ct * ph2 / (2.0 * C);
+    if(z < fZmax && z > fZmin) phases[1] = TMath::Abs(ph2);
+  }
+
+  // outer cylinder
+  if(rTop > fRmax && TMath::Abs(D) < fRmax)
+  {
+    ph = 2.0 * TMath::ASin(C * TMath::Sqrt((fRmax * fRmax - D * D) / opCD));
+    z = z0 + ct * ph / (2.0 * C);
+    if(z < fZmax && z > fZmin) phases[2] = TMath::Abs(ph);
+  }
+
+  // end walls
+  zDir = (fZmin - z0) / ct;
+  if(zDir > 0.0)
+  {
+    ph = 2.0 * C * zDir;
+    halfSin = TMath::Sin(0.5 * ph);
+    rInt = TMath::Sqrt(D * D + opCD * halfSin * halfSin / (C * C));
+    if(rInt < fRmax && rInt > fRmin) phases[3] = TMath::Abs(ph);
+  }
+
+  zDir = (fZmax - z0) / ct;
+  if(zDir > 0.0)
+  {
+    ph = 2.0 * C * zDir;
+    halfSin = TMath::Sin(0.5 * ph);
+    rInt = TMath::Sqrt(D * D + opCD * halfSin * halfSin / (C * C));
+    if(rInt < fRmax && rInt > fRmin) phases[4] = TMath::Abs(ph);
+  }
+
+  // the track crosses the chamber between the two lowest non-zero phases
+  sort(phases, phases + 5);
+  iPos = -1;
+  for(i = 0; i < 5; ++i)
+  {
+    if(phases[i] <= 0.0) iPos = i;
+  }
+
+  if(iPos >= 3) return 0.0;
+
+  return (phases[iPos + 2] - phases[iPos + 1]) * TMath::Sqrt(1.0 + ct * ct) / (2.0 * TMath::Abs(C));
+}
+
+//------------------------------------------------------------------------------
+
 void ClusterCounting::Process()
 {
   Candidate *candidate, *mother, *particle;
   Double_t mass, trackLength, Ncl;
+  Double_t x, y, z, px, py, pz, pt, a, r2, cross, T, D, C, phi0, s, z0, ct;
+  Int_t i, n;
+
+  fTracks.clear();
+  fTrackLengths.clear();
+  fMeanClusters.clear();
 
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
   {
-
-    // converting to meters
     particle = static_cast<Candidate *>(candidate->GetCandidates()->At(0));
 
-    // converting to meters
-    const TLorentzVector &candidatePosition = particle->Position * 1e-03;
+    const TLorentzVector &candidatePosition = particle->Position;
     const TLorentzVector &candidateMomentum = particle->Momentum;
 
-    TVectorD Par = TrkUtil::XPtoPar(candidatePosition.Vect(), candidateMomentum.Vect(), candidate->Charge, fBz);
+    // helix parameters in meters, see TrkUtil::XPtoPar
+    x = candidatePosition.X() * 1.0E-3;
+    y = candidatePosition.Y() * 1.0E-3;
+    z = candidatePosition.Z() * 1.0E-3;
+    px = candidateMomentum.Px();
+    py = candidateMomentum.Py();
+    pz = candidateMomentum.Pz();
+
+    a = -candidate->Charge * fBz * TrkUtil::cSpeed();
+    pt = TMath::Hypot(px, py);
+    C = a / (2.0 * pt);
+    if(TMath::Abs(x) < 1.0E-10) x = 0.0;
+    if(TMath::Abs(y) < 1.0E-10) y = 0.0;
+    r2 = x * x + y * y;
+    cross = x * py - y * px;
+    phi0 = TMath::ATan2(py - a * x, px + a * y);
+    if(r2 == 0.0)
+    {
+      D = 0.0;
+    }
+    else if(pt < 10.0)
+    {
+      T = TMath::Sqrt(pt * pt - 2.0 * a * cross + a * a * r2);
+      D = (T - pt) / a;
+    }
+    else
+    {
+      T = TMath::Sqrt(pt * pt - 2.0 * a * cross + a * a * r2);
+      D = (-2.0 * cross + a * r2) / (T + pt);
+    }
+    ct = pz / pt;
+    s = TMath::ATan2(py, px) - phi0;
+    if(s > TMath::Pi()) s -= TMath::TwoPi();
+    if(s < -TMath::Pi()) s += TMath::TwoPi();
+    z0 = z - ct * s / (2.0 * C);
+
     mass = candidateMomentum.M();
 
-    trackLength = fTrackUtil->TrkLen(Par);
+    trackLength = (fBz != 0.0) ? TrackLength(D, C, z0, ct) : 0.0;
 
     mother = candidate;
     candidate = static_cast<Candidate *>(candidate->Clone());
+    candidate->AddCandidate(mother);
+
+    fOutputArray->Add(candidate);
 
-    Ncl = 0.;
-    if(fTrackUtil->IonClusters(Ncl, mass, Par))
+    if(trackLength > 0.0)
     {
-      candidate->Nclusters = Ncl;
-      candidate->dNdx = (trackLength > 0.) ? Ncl / trackLength : -1;
+      fTracks.push_back(candidate);
+      fTrackLengths.push_back(trackLength);
+      // momentum from the helix curvature, as in TrkUtil::IonClusters
+      pt = fBz * TrkUtil::cSpeed() / TMath::Abs(2.0 * C);
+      fMeanClusters.push_back(GetNclusters(pt * TMath::Sqrt(1.0 + ct * ct) / mass) * trackLength);
     }
+  }
 
-    candidate->AddCandidate(mother);
+  // draw the number of clusters of all tracks in one pass,
+  // in the same order as the tracks
+  n = fTracks.size();
+  for(i = 0; i < n; ++i)
+  {
+    Ncl = gRandom->PoissonD(fMeanClusters[i]);
 
-    fOutputArray->Add(candidate);
+    candidate = fTracks[i];
+    candidate->Nclusters = Ncl;
+    candidate->dNdx = Ncl / fTrackLengths[i];
   }
 }
-
-//------------------------------------------------------------------------------
@@ -30,10 +30,11 @@
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TIterator;
 class TObjArray;
-
-class TrkUtil;
+class Candidate;
 
 class ClusterCounting: public DelphesModule
 {
@@ -46,6 +47,9 @@ public:
   void Finish();
 
 private:
+  Double_t TrackLength(Double_t D, Double_t C, Double_t z0, Double_t ct) const;
+  Double_t GetNclusters(Double_t bg) const;
+
   Double_t fRmin;
   Double_t fRmax;
   Double_t fZmin;
@@ -54,7 +58,13 @@ private:
 
   Int_t fGasOption;
 
-  TrkUtil *fTrackUtil = nullptr;
+  // clusters per meter on a uniform grid in log(beta*gamma)
+  std::vector<Double_t> fNclustersTable; //!
+  Double_t fLogBGMin, fLogBGMax, fInvLogBGStep; //!
+
+  std::vector<Candidate *> fTracks; //!
+  std::vector<Double_t> fTrackLengths; //!
+  std::vector<Double_t> fMeanClusters; //!
 
   TIterator *fItInputArray = nullptr; //!
 
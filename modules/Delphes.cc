@@ -21,6 +21,9 @@
  *  Main Delphes module.
  *  Controls execution of all other modules.
  *
+ *  The execution of the module chain stops for the current event
+ *  as soon as one of the modules rejects the event (see EventFilter).
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -30,6 +33,8 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesTaskGraph.h"
+#include "classes/DelphesVariant.h"
 
 #include "ExRootAnalysis/ExRootClassifier.h"
 #include "ExRootAnalysis/ExRootConfReader.h"
@@ -38,6 +43,7 @@
 #include "ExRootAnalysis/ExRootTreeWriter.h"
 
 #include "TDatabasePDG.h"
+#include "TFile.h"
 #include "TFolder.h"
 #include "TFormula.h"
 #include "TLorentzVector.h"
@@ -48,9 +54,12 @@
 #include "TString.h"
 
 #include <algorithm>
+#include <iomanip>
 #include <iostream>
+#include <set>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 #include <stdio.h>
 #include <string.h>
@@ -85,6 +94,14 @@ Delphes::~Delphes()
     folder->Clear();
     delete folder;
   }
+  delete fTaskGraph;
+
+  vector<DelphesVariant *>::iterator itVariants;
+  for(itVariants = fVariants.begin(); itVariants != fVariants.end(); ++itVariants)
+  {
+    delete *itVariants;
+  }
+
   delete fFactory;
 }
 
@@ -92,6 +109,12 @@ Delphes::~Delphes()
 
 void Delphes::Clear(Option_t * /*option*/)
 {
+  vector<DelphesVariant *>::iterator itVariants;
+  for(itVariants = fVariants.begin(); itVariants != fVariants.end(); ++itVariants)
+  {
+    (*itVariants)->Clear();
+  }
+
   if(fFactory) fFactory->Clear();
 }
 
@@ -120,7 +143,17 @@ void Delphes::Init()
   ExRootConfParam param = confReader->GetParam("::ExecutionPath");
   Long_t i, size = param.GetSize();
 
-  gRandom->SetSeed(confReader->GetInt("::RandomSeed", 0));
+  fRandomSeed = confReader->GetInt("::RandomSeed", 0);
+  gRandom->SetSeed(fRandomSeed);
+
+  fNumberOfThreads = confReader->GetInt("::NumberOfThreads", 0);
+  if(fNumberOfThreads > 0)
+  {
+    ROOT::EnableThreadSafety();
+    // read the particle table before the modules run concurrently
+    TDatabasePDG::Instance()->GetParticle(211);
+    fFactory->SetThreadSafe(kTRUE);
+  }
 
   for(i = 0; i < size; ++i)
   {
@@ -146,6 +179,347 @@ void Delphes::Init()
 
 //------------------------------------------------------------------------------
 
+void Delphes::InitTask()
+{
+  ExRootTreeWriter *treeWriter;
+
+  // branches created by the reader before the modules are initialized
+  treeWriter = static_cast<ExRootTreeWriter *>(GetObject("TreeWriter", ExRootTreeWriter::Class()));
+  if(treeWriter)
+  {
+    fReaderBranches.assign(treeWriter->GetBranches().begin(), treeWriter->GetBranches().end());
+  }
+
+  DelphesModule::InitTask();
+
+  // arrays are only known once all modules are initialized
+  InitVariants();
+
+  if(GetConfReader()->GetBool("::PruneModules", false)) PruneModules();
+}
+
+//------------------------------------------------------------------------------
+
+void Delphes::InitVariants()
+{
+  stringstream message;
+  ExRootConfReader *confReader = GetConfReader();
+  const ExRootConfReader::ExRootVariantList *variants = confReader->GetVariants();
+  ExRootConfReader::ExRootVariantList::const_iterator itVariants;
+  const ExRootConfReader::ExRootTaskMap *modules = confReader->GetModules();
+  ExRootConfReader::ExRootTaskMap::const_iterator itModules;
+  vector<DelphesModule *> shared;
+  vector<DelphesModule *>::iterator itShared;
+  vector<const TObjArray *>::const_iterator itArrays;
+  vector<ExRootTreeBranch *>::iterator itBranches;
+  vector<TString> names;
+  ExRootTreeWriter *mainTreeWriter, *treeWriter;
+  DelphesVariant *variant;
+  DelphesModule *module;
+  ExRootTask *task;
+  TFile *file;
+  TString variantName, forkName, name;
+  const char *fileName;
+  Long_t i, fork, size;
+
+  for(itVariants = variants->begin(); itVariants != variants->end(); ++itVariants)
+  {
+    variantName = itVariants->first;
+    forkName = itVariants->second;
+
+    cout << left;
+    cout << setw(30) << "** INFO: initializing variant";
+    cout << setw(25) << variantName << endl;
+
+    // modules of ExecutionPath up to the fork module are shared
+
+    TIter itTasks(GetListOfTasks());
+    shared.clear();
+    shared.push_back(this);
+    names.clear();
+    fork = -1;
+    for(i = 0; (task = static_cast<ExRootTask *>(itTasks.Next())); ++i)
+    {
+      if(fork >= 0)
+      {
+        names.push_back(task->GetName());
+        continue;
+      }
+
+      module = dynamic_cast<DelphesModule *>(task);
+      if(module) shared.push_back(module);
+      if(forkName == task->GetName()) fork = i;
+    }
+
+    if(fork < 0)
+    {
+      message << "module '" << forkName << "' is specified as fork of variant '";
+      message << variantName << "' but not in ExecutionPath.";
+      throw runtime_error(message.str());
+    }
+
+    name = variantName + "::ExecutionPath";
+    ExRootConfParam param = confReader->GetParam(name);
+    size = param.GetSize();
+    if(size > 0)
+    {
+      names.clear();
+      for(i = 0; i < size; ++i)
+      {
+        names.push_back(param[i].GetString());
+      }
+    }
+
+    // variant tree is written to the main output file or to its own file
+
+    mainTreeWriter = static_cast<ExRootTreeWriter *>(GetObject("TreeWriter", ExRootTreeWriter::Class()));
+    if(!mainTreeWriter)
+    {
+      message << "can't access output tree of variant '" << variantName << "'";
+      throw runtime_error(message.str());
+    }
+    fMainTreeWriter = mainTreeWriter;
+
+    fileName = confReader->GetString(variantName + "::OutputFile", "");
+    if(strlen(fileName) > 0)
+    {
+      file = TFile::Open(fileName, "RECREATE");
+      if(!file)
+      {
+        message << "can't create output file " << fileName;
+        throw runtime_error(message.str());
+      }
+      treeWriter = new ExRootTreeWriter(file, confReader->GetString(variantName + "::TreeName", "Delphes"));
+    }
+    else
+    {
+      file = 0;
+      treeWriter = new ExRootTreeWriter(mainTreeWriter->GetTreeFile(), confReader->GetString(variantName + "::TreeName", variantName));
+    }
+
+    variant = new DelphesVariant(variantName, fork, fFactory);
+    fVariants.push_back(variant);
+
+    variant->SetTreeWriter(treeWriter, file);
+
+    // entries of the variant tree match those of the main tree
+    for(itBranches = fReaderBranches.begin(); itBranches != fReaderBranches.end(); ++itBranches)
+    {
+      treeWriter->AddBranch(*itBranches);
+    }
+    mainTreeWriter->AddWriter(treeWriter);
+
+    for(itShared = shared.begin(); itShared != shared.end(); ++itShared)
+    {
+      const vector<const TObjArray *> &exported = (*itShared)->GetExportedArrays();
+      for(itArrays = exported.begin(); itArrays != exported.end(); ++itArrays)
+      {
+        variant->AddArray((*itShared)->GetName(), *itArrays);
+      }
+    }
+
+    // modules configured inside the variant replace the main ones
+
+    for(i = 0; i < Long_t(names.size()); ++i)
+    {
+      name = names[i];
+      itModules = modules->find(variantName + "::" + name);
+      if(itModules == modules->end()) itModules = modules->find(name);
+      if(itModules == modules->end())
+      {
+        message << "module '" << name << "' is specified in ExecutionPath of variant '";
+        message << variantName << "' but not configured.";
+        throw runtime_error(message.str());
+      }
+
+      task = NewTask(itModules->second, name);
+      if(task) variant->AddTask(task);
+    }
+
+    variant->Init();
+  }
+
+  // seeds follow those of the modules run by DelphesTaskGraph
+  size = GetListOfTasks()->GetSize() + fVariants.size();
+  for(i = 0; i < Long_t(fVariants.size()); ++i)
+  {
+    fVariants[i]->SetRandomSeed(fRandomSeed > 0 ? fRandomSeed + size + i + 1 : 0);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void Delphes::PruneModules()
+{
+  ExRootConfReader *confReader = GetConfReader();
+  TIter itTasks(GetListOfTasks());
+  ExRootTask *task;
+  DelphesModule *module;
+  vector<DelphesModule *> modules;
+  vector<DelphesModule *>::reverse_iterator itModules;
+  vector<const TObjArray *>::const_iterator itArrays;
+  set<const TObjArray *> needed;
+  set<DelphesModule *> kept;
+  Bool_t changed, keep;
+  Int_t pruned = 0;
+
+  ExRootConfParam param = confReader->GetParam("::KeepArrays");
+  Long_t i, size = param.GetSize();
+
+  for(i = 0; i < size; ++i)
+  {
+    needed.insert(ImportArray(param[i].GetString()));
+  }
+
+  for(i = 0; i < Long_t(fVariants.size()); ++i)
+  {
+    needed.insert(fVariants[i]->GetSharedArrays().begin(), fVariants[i]->GetSharedArrays().end());
+  }
+
+  while((task = static_cast<ExRootTask *>(itTasks.Next())))
+  {
+    // dependencies of other tasks are not known
+    module = dynamic_cast<DelphesModule *>(task);
+    if(!module)
+    {
+      cout << "** WARNING: task '" << task->GetName() << "' is not a module, no module skipped" << endl;
+      return;
+    }
+    modules.push_back(module);
+  }
+
+  // a module is kept if it writes the output tree or filters events,
+  // if it exports an array used by a kept module, or if it is not
+  // declared input read-only, since it may then update candidates
+  // reached from other arrays (isolation, particle density, ...);
+  // only input read-only modules are ever skipped
+
+  do
+  {
+    changed = kFALSE;
+    for(itModules = modules.rbegin(); itModules != modules.rend(); ++itModules)
+    {
+      module = *itModules;
+      if(kept.count(module)) continue;
+
+      const vector<const TObjArray *> &imported = module->GetImportedArrays();
+      const vector<const TObjArray *> &exported = module->GetExportedArrays();
+
+      keep = module->HasTreeWriter() || module->IsEventFilter() || !module->IsInputReadOnly();
+
+      for(itArrays = exported.begin(); !keep && itArrays != exported.end(); ++itArrays)
+      {
+        keep = needed.count(*itArrays) > 0;
+      }
+
+      if(!keep) continue;
+
+      kept.insert(module);
+      needed.insert(imported.begin(), imported.end());
+      changed = kTRUE;
+    }
+  } while(changed);
+
+  cout << left;
+  for(i = 0; i < Long_t(modules.size()); ++i)
+  {
+    module = modules[i];
+    if(kept.count(module)) continue;
+
+    module->SetActive(kFALSE);
+    ++pruned;
+
+    cout << setw(30) << "** INFO: skipping module";
+    cout << setw(25) << module->GetName() << " (output not used)" << endl;
+  }
+
+  cout << "** INFO: " << pruned << " of " << modules.size() << " modules skipped" << endl;
+}
+
+//------------------------------------------------------------------------------
+
+void Delphes::ProcessTask()
+{
+  TIter itTasks(GetListOfTasks());
+  ExRootTask *task;
+  DelphesModule *module;
+  vector<DelphesVariant *>::iterator itVariants;
+  Bool_t accepted;
+  Int_t i;
+
+  SetEventAccepted(kTRUE);
+
+  if(fNumberOfThreads > 0)
+  {
+    // modules have imported and exported their arrays in Init
+    if(!fTaskGraph)
+    {
+      fTaskGraph = new DelphesTaskGraph;
+      for(i = 0; (task = static_cast<ExRootTask *>(itTasks.Next())); ++i)
+      {
+        fTaskGraph->AddTask(task);
+        for(itVariants = fVariants.begin(); itVariants != fVariants.end(); ++itVariants)
+        {
+          if((*itVariants)->GetFork() == i) fTaskGraph->AddTask((*itVariants)->GetForkTask(), (*itVariants)->GetSharedArrays());
+        }
+      }
+      fTaskGraph->Start(fNumberOfThreads, fRandomSeed);
+    }
+
+    SetEventAccepted(fTaskGraph->Process());
+  }
+  else
+  {
+    for(i = 0; (task = static_cast<ExRootTask *>(itTasks.Next())); ++i)
+    {
+      task->ProcessTask();
+
+      // skip remaining modules if the event has been rejected
+      module = dynamic_cast<DelphesModule *>(task);
+      if(module && !module->IsEventAccepted())
+      {
+        SetEventAccepted(kFALSE);
+        break;
+      }
+
+      for(itVariants = fVariants.begin(); itVariants != fVariants.end(); ++itVariants)
+      {
+        if((*itVariants)->GetFork() == i) (*itVariants)->Fork();
+      }
+    }
+  }
+
+  if(fVariants.empty()) return;
+
+  // each tree is filled if the event is accepted by its own execution path,
+  // the event is passed to the tree writer if any of them accepts it
+  accepted = IsEventAccepted();
+  fMainTreeWriter->SetAccepted(accepted);
+
+  for(itVariants = fVariants.begin(); itVariants != fVariants.end(); ++itVariants)
+  {
+    if((*itVariants)->Process()) accepted = kTRUE;
+  }
+
+  SetEventAccepted(accepted);
+}
+
+//------------------------------------------------------------------------------
+
+void Delphes::FinishTask()
+{
+  vector<DelphesVariant *>::iterator itVariants;
+
+  DelphesModule::FinishTask();
+
+  for(itVariants = fVariants.begin(); itVariants != fVariants.end(); ++itVariants)
+  {
+    (*itVariants)->Finish();
+  }
+}
+
+//------------------------------------------------------------------------------
+
 void Delphes::Process()
 {
 }
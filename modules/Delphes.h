@@ -24,6 +24,25 @@
  *  Main Delphes module.
  *  Controls execution of all other modules.
  *
+ *  The execution of the module chain stops for the current event
+ *  as soon as one of the modules rejects the event (see EventFilter).
+ *
+ *  With NumberOfThreads > 0, independent modules of the same event
+ *  run concurrently (see DelphesTaskGraph).
+ *
+ *  With PruneModules set to true, input read-only modules that cannot
+ *  affect the output tree, the event selection or the arrays listed in
+ *  KeepArrays are disabled after initialization.
+ *
+ *  Variants declared in the configuration file with
+ *  variant <name> <fork module> { ... } share the modules of
+ *  ExecutionPath up to the fork module and run their own copy of
+ *  the remaining modules, or of their own ExecutionPath, writing
+ *  a separate tree or OutputFile (see DelphesVariant).
+ *  Module parameters set inside a variant override the main ones.
+ *  Each tree is filled if the event is accepted by its own execution
+ *  path, IsEventAccepted returns true if any of them accepts it.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -33,9 +52,12 @@
 class TFolder;
 class TObjArray;
 
+class ExRootTreeBranch;
 class ExRootTreeWriter;
 
 class DelphesFactory;
+class DelphesTaskGraph;
+class DelphesVariant;
 
 class Delphes: public DelphesModule
 {
@@ -49,13 +71,32 @@ public:
 
   void Clear(Option_t *option = "");
 
+  virtual void InitTask();
+  virtual void ProcessTask();
+  virtual void FinishTask();
+
   virtual void Init();
   virtual void Process();
   virtual void Finish();
 
 private:
+  void InitVariants();
+  void PruneModules();
+
   DelphesFactory *fFactory = nullptr;
 
+  Int_t fNumberOfThreads = 0;
+  UInt_t fRandomSeed = 0;
+
+  DelphesTaskGraph *fTaskGraph = nullptr; //!
+
+  std::vector<DelphesVariant *> fVariants; //!
+
+  // tree writer of the main execution path, set if there are variants
+  ExRootTreeWriter *fMainTreeWriter = nullptr; //!
+
+  std::vector<ExRootTreeBranch *> fReaderBranches; //!
+
   ClassDef(Delphes, 1)
 };
 
@@ -177,6 +177,9 @@ void DualReadoutCalorimeter::Init()
   fECalResolutionFormula->Compile(GetString("ECalResolutionFormula", "0"));
   fHCalResolutionFormula->Compile(GetString("HCalResolutionFormula", "0"));
 
+  TabulateFormula(fECalResolutionFormula, "ECalResolutionMap", kTRUE);
+  TabulateFormula(fHCalResolutionFormula, "HCalResolutionMap", kTRUE);
+
   // import array with output from other modules
   fParticleInputArray = ImportArray(GetString("ParticleInputArray", "ParticlePropagator/particles"));
   fItParticleInputArray = fParticleInputArray->MakeIterator();
@@ -20,12 +20,19 @@
  *
  *  Selects candidates from the InputArray according to the efficiency formula.
  *
+ *  With UseWeights set to true, candidates are not dropped but copied with
+ *  the efficiency multiplied into their EfficiencyWeights, followed by the
+ *  efficiencies of EfficiencyFormula<name> for each name of the global
+ *  WeightVariations.
+ *  Candidates with zero efficiency for all formulas are dropped.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
 
 #include "modules/Efficiency.h"
 
+#include "classes/DelphesCandidateBatch.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
@@ -54,6 +61,7 @@ using namespace std;
 Efficiency::Efficiency()
 {
   fFormula = new DelphesFormula;
+  fBatch = new DelphesCandidateBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -61,16 +69,36 @@ Efficiency::Efficiency()
 Efficiency::~Efficiency()
 {
   delete fFormula;
+  delete fBatch;
 }
 
 //------------------------------------------------------------------------------
 
 void Efficiency::Init()
 {
+  ExRootConfParam param;
+  DelphesFormula *formula;
+  Int_t i, size;
+
   // read efficiency formula
 
   fFormula->Compile(GetString("EfficiencyFormula", "1.0"));
 
+  // read efficiency formulas of the variations
+
+  fUseWeights = GetBool("UseWeights", false);
+
+  param = GetWeightVariations();
+  size = param.GetSize();
+
+  fVariationFormulas.clear();
+  for(i = 0; fUseWeights && i < size; ++i)
+  {
+    formula = new DelphesFormula;
+    formula->Compile(GetString(Form("EfficiencyFormula%s", param[i].GetString()), GetString("EfficiencyFormula", "1.0")));
+    fVariationFormulas.push_back(formula);
+  }
+
   // import input array
 
   fInputArray = ImportArray(GetString("InputArray", "ParticlePropagator/stableParticles"));
@@ -82,13 +110,22 @@ void Efficiency::Init()
   // create output array
 
   fOutputArray = ExportArray(GetString("OutputArray", "stableParticles"));
+
+  SetInputReadOnly(kTRUE);
 }
 
 //------------------------------------------------------------------------------
 
 void Efficiency::Finish()
 {
+  vector<DelphesFormula *>::iterator itFormulas;
+
   delete fItInputArray;
+
+  for(itFormulas = fVariationFormulas.begin(); itFormulas != fVariationFormulas.end(); ++itFormulas)
+  {
+    delete *itFormulas;
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -97,6 +134,9 @@ void Efficiency::Process()
 {
   Candidate *candidate;
   Double_t pt, eta, phi, e;
+  Int_t i, j, size, variations;
+
+  fBatch->Clear();
 
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
@@ -115,10 +155,51 @@ void Efficiency::Process()
     pt = candidateMomentum.Pt();
     e = candidateMomentum.E();
 
-    // apply an efficency formula
-    if(gRandom->Uniform() > fFormula->Eval(pt, eta, phi, e, candidate)) continue;
+    fBatch->Add(candidate, pt, eta, phi, e);
+  }
+
+  // apply an efficency formula to all candidates at once
+  fBatch->Evaluate(fFormula);
+
+  size = fBatch->GetSize();
+
+  if(fUseWeights)
+  {
+    variations = fVariationFormulas.size();
+
+    fValues.assign(fBatch->Values.begin(), fBatch->Values.end());
+    for(j = 0; j < variations; ++j)
+    {
+      fBatch->Evaluate(fVariationFormulas[j]);
+      fValues.insert(fValues.end(), fBatch->Values.begin(), fBatch->Values.end());
+    }
+
+    for(i = 0; i < size; ++i)
+    {
+      fWeights.clear();
+      for(j = 0; j <= variations; ++j)
+      {
+        fWeights.push_back(fValues[j * size + i]);
+      }
+
+      if(*max_element(fWeights.begin(), fWeights.end()) <= 0.0) continue;
+
+      // candidate is copied, since it can belong to other arrays
+      candidate = static_cast<Candidate *>(fBatch->Candidates[i]->Clone());
+      candidate->MultiplyEfficiencyWeights(fWeights);
+      fOutputArray->Add(candidate);
+    }
+
+    return;
+  }
+
+  fBatch->DrawUniform();
+
+  for(i = 0; i < size; ++i)
+  {
+    if(fBatch->Random[i] > fBatch->Values[i]) continue;
 
-    fOutputArray->Add(candidate);
+    fOutputArray->Add(fBatch->Candidates[i]);
   }
 }
 
@@ -23,15 +23,24 @@
  *
  *  Selects candidates from the InputArray according to the efficiency formula.
  *
+ *  With UseWeights set to true, candidates are not dropped but copied with
+ *  the efficiency multiplied into their EfficiencyWeights, followed by the
+ *  efficiencies of EfficiencyFormula<name> for each name of the global
+ *  WeightVariations.
+ *  Candidates with zero efficiency for all formulas are dropped.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TIterator;
 class TObjArray;
 class DelphesFormula;
+class DelphesCandidateBatch;
 
 class Efficiency: public DelphesModule
 {
@@ -46,6 +55,16 @@ public:
 private:
   DelphesFormula *fFormula = nullptr; //!
 
+  Bool_t fUseWeights; //!
+
+#if !defined(__CINT__) && !defined(__CLING__)
+  std::vector<DelphesFormula *> fVariationFormulas; //!
+
+  std::vector<Double_t> fValues, fWeights; //!
+#endif
+
+  DelphesCandidateBatch *fBatch = nullptr; //!
+
   TIterator *fItInputArray = nullptr; //!
 
   const TObjArray *fInputArray = nullptr; //!
@@ -26,6 +26,7 @@
 
 #include "modules/EnergySmearing.h"
 
+#include "classes/DelphesCandidateBatch.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
@@ -54,6 +55,8 @@ using namespace std;
 EnergySmearing::EnergySmearing()
 {
   fFormula = new DelphesFormula;
+  fBatch = new DelphesCandidateBatch;
+  fSmearedBatch = new DelphesCandidateBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -61,6 +64,8 @@ EnergySmearing::EnergySmearing()
 EnergySmearing::~EnergySmearing()
 {
   delete fFormula;
+  delete fBatch;
+  delete fSmearedBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -79,6 +84,8 @@ void EnergySmearing::Init()
   // create output array
 
   fOutputArray = ExportArray(GetString("OutputArray", "stableParticles"));
+
+  SetInputReadOnly(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -94,6 +101,9 @@ void EnergySmearing::Process()
 {
   Candidate *candidate, *mother;
   Double_t pt, energy, eta, phi, m;
+  Int_t i, size;
+
+  fBatch->Clear();
 
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
@@ -105,22 +115,50 @@ void EnergySmearing::Process()
     eta = candidatePosition.Eta();
     phi = candidatePosition.Phi();
     energy = candidateMomentum.E();
-    m = candidateMomentum.M();
+
+    fBatch->Add(candidate, pt, eta, phi, energy);
+  }
+
+  // evaluate smearing formula for all candidates at once
+  fBatch->Evaluate(fFormula, kFALSE);
+  fBatch->DrawGaus(fBatch->GetSize());
+
+  fSmearedBatch->Clear();
+
+  size = fBatch->GetSize();
+  for(i = 0; i < size; ++i)
+  {
+    candidate = fBatch->Candidates[i];
 
     // apply smearing formula
-    energy = gRandom->Gaus(energy, fFormula->Eval(pt, eta, phi, energy));
+    energy = fBatch->E[i] + fBatch->Values[i] * fBatch->Random[i];
 
     if(energy <= 0.0) continue;
 
+    const TLorentzVector &candidateMomentum = candidate->Momentum;
+
     mother = candidate;
     candidate = static_cast<Candidate *>(candidate->Clone());
     eta = candidateMomentum.Eta();
     phi = candidateMomentum.Phi();
+    m = candidateMomentum.M();
     pt = (energy > m) ? TMath::Sqrt(energy * energy - m * m) / TMath::CosH(eta) : 0;
     candidate->Momentum.SetPtEtaPhiE(pt, eta, phi, energy);
-    candidate->TrackResolution = fFormula->Eval(pt, eta, phi, energy) / candidateMomentum.E();
     candidate->AddCandidate(mother);
 
+    fSmearedBatch->Add(candidate, pt, eta, phi, energy);
+  }
+
+  // resolution at the smeared energy, evaluated for all clones at once
+  fSmearedBatch->Evaluate(fFormula, kFALSE);
+
+  size = fSmearedBatch->GetSize();
+  for(i = 0; i < size; ++i)
+  {
+    candidate = fSmearedBatch->Candidates[i];
+    mother = static_cast<Candidate *>(candidate->GetCandidates()->Last());
+    candidate->TrackResolution = fSmearedBatch->Values[i] / mother->Momentum.E();
+
     fOutputArray->Add(candidate);
   }
 }
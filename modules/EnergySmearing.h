@@ -32,6 +32,7 @@
 class TIterator;
 class TObjArray;
 class DelphesFormula;
+class DelphesCandidateBatch;
 
 class EnergySmearing: public DelphesModule
 {
@@ -46,6 +47,9 @@ public:
 private:
   DelphesFormula *fFormula = nullptr; //!
 
+  DelphesCandidateBatch *fBatch = nullptr; //!
+  DelphesCandidateBatch *fSmearedBatch = nullptr; //!
+
   TIterator *fItInputArray = nullptr; //!
 
   const TObjArray *fInputArray = nullptr; //!
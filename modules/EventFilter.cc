@@ -0,0 +1,170 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class EventFilter
+ *
+ *  Rejects events that do not pass a set of multiplicity requirements.
+ *  Each requirement counts the candidates of an input array that pass
+ *  a selection formula. When one of the requirements is not satisfied,
+ *  the remaining modules of the execution path are skipped and
+ *  the event is not written to the output tree.
+ *
+ */
+
+#include "modules/EventFilter.h"
+
+#include "classes/DelphesClasses.h"
+#include "classes/DelphesFactory.h"
+#include "classes/DelphesFormula.h"
+
+#include "TLorentzVector.h"
+#include "TObjArray.h"
+#include "TString.h"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+EventFilter::EventFilter() :
+  fProcessedEvents(0), fAcceptedEvents(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+EventFilter::~EventFilter()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void EventFilter::Init()
+{
+  ExRootConfParam param;
+  Long_t i, size;
+  const TObjArray *array;
+  DelphesFormula *formula;
+  stringstream message;
+
+  // read selections: input array, minimum and maximum multiplicity, selection formula
+  // a negative maximum multiplicity means no upper limit
+
+  param = GetParam("Selection");
+  size = param.GetSize();
+
+  if(size % 4 != 0)
+  {
+    message << "module '" << GetName() << "': each Selection entry requires";
+    message << " an input array, a minimum and a maximum multiplicity and a formula";
+    throw runtime_error(message.str());
+  }
+
+  for(i = 0; i < size / 4; ++i)
+  {
+    array = ImportArray(param[i * 4].GetString());
+    fInputList.push_back(array->MakeIterator());
+
+    fMinimumList.push_back(param[i * 4 + 1].GetInt());
+    fMaximumList.push_back(param[i * 4 + 2].GetInt());
+
+    formula = new DelphesFormula;
+    formula->Compile(param[i * 4 + 3].GetString());
+    fFormulaList.push_back(formula);
+  }
+
+  fProcessedEvents = 0;
+  fAcceptedEvents = 0;
+
+  SetEventFilter(kTRUE);
+}
+
+//------------------------------------------------------------------------------
+
+void EventFilter::Finish()
+{
+  vector<TIterator *>::iterator itInputList;
+  vector<DelphesFormula *>::iterator itFormulaList;
+
+  for(itInputList = fInputList.begin(); itInputList != fInputList.end(); ++itInputList)
+  {
+    if(*itInputList) delete *itInputList;
+  }
+
+  for(itFormulaList = fFormulaList.begin(); itFormulaList != fFormulaList.end(); ++itFormulaList)
+  {
+    if(*itFormulaList) delete *itFormulaList;
+  }
+
+  cout << "** INFO: module " << GetName() << " accepted ";
+  cout << fAcceptedEvents << " out of " << fProcessedEvents << " events" << endl;
+}
+
+//------------------------------------------------------------------------------
+
+void EventFilter::Process()
+{
+  Candidate *candidate;
+  TIterator *iterator;
+  DelphesFormula *formula;
+  Double_t pt, eta, phi, e;
+  Int_t count, maximum;
+  Bool_t accepted = kTRUE;
+  size_t i;
+
+  ++fProcessedEvents;
+
+  // selections are evaluated in the order they are listed in the card
+  for(i = 0; accepted && i < fInputList.size(); ++i)
+  {
+    iterator = fInputList[i];
+    formula = fFormulaList[i];
+    maximum = fMaximumList[i];
+
+    count = 0;
+    iterator->Reset();
+    while((candidate = static_cast<Candidate *>(iterator->Next())))
+    {
+      const TLorentzVector &candidateMomentum = candidate->Momentum;
+      pt = candidateMomentum.Pt();
+      eta = candidateMomentum.Eta();
+      phi = candidateMomentum.Phi();
+      e = candidateMomentum.E();
+
+      if(formula->Eval(pt, eta, phi, e, candidate) <= 0.0) continue;
+
+      ++count;
+
+      // no need to look further once the requirement is fulfilled
+      if(maximum < 0 && count >= fMinimumList[i]) break;
+
+      if(maximum >= 0 && count > maximum) break;
+    }
+
+    if(count < fMinimumList[i] || (maximum >= 0 && count > maximum)) accepted = kFALSE;
+  }
+
+  if(accepted) ++fAcceptedEvents;
+
+  SetEventAccepted(accepted);
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,62 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EventFilter_h
+#define EventFilter_h
+
+/** \class EventFilter
+ *
+ *  Rejects events that do not pass a set of multiplicity requirements.
+ *  Each requirement counts the candidates of an input array that pass
+ *  a selection formula. When one of the requirements is not satisfied,
+ *  the remaining modules of the execution path are skipped and
+ *  the event is not written to the output tree.
+ *
+ */
+
+#include "classes/DelphesModule.h"
+
+#include <vector>
+
+class TIterator;
+class TObjArray;
+class DelphesFormula;
+
+class EventFilter: public DelphesModule
+{
+public:
+  EventFilter();
+  ~EventFilter();
+
+  void Init();
+  void Process();
+  void Finish();
+
+private:
+  std::vector<TIterator *> fInputList; //!
+  std::vector<DelphesFormula *> fFormulaList; //!
+  std::vector<Int_t> fMinimumList; //!
+  std::vector<Int_t> fMaximumList; //!
+
+  Long64_t fProcessedEvents; //!
+  Long64_t fAcceptedEvents; //!
+
+  ClassDef(EventFilter, 1)
+};
+
+#endif
@@ -69,6 +69,7 @@
 #include "fastjet/contribs/RecursiveTools/SoftDrop.hh"
 #include "fastjet/tools/Filter.hh"
 #include "fastjet/tools/Pruner.hh"
+#include "fastjet/tools/Recluster.hh"
 
 using namespace std;
 using namespace fastjet;
@@ -140,9 +141,11 @@ void FastJetFinder::Init()
   default:
   case 1:
     fAxesDef = new WTA_KT_Axes();
+    fAxesRecomb = new WinnerTakeAllRecombiner();
     break;
   case 2:
     fAxesDef = new OnePass_WTA_KT_Axes();
+    fAxesRecomb = new WinnerTakeAllRecombiner();
     break;
   case 3:
     fAxesDef = new KT_Axes();
@@ -151,6 +154,16 @@ void FastJetFinder::Init()
     fAxesDef = new OnePass_KT_Axes();
   }
 
+  // same clustering as the seeding of the axes definitions above
+  if(fAxesRecomb)
+  {
+    fAxesDefinition = new JetDefinition(kt_algorithm, JetDefinition::max_allowable_R, fAxesRecomb, Best);
+  }
+  else
+  {
+    fAxesDefinition = new JetDefinition(kt_algorithm, JetDefinition::max_allowable_R, E_scheme, Best);
+  }
+
   //-- Trimming parameters --
 
   fComputeTrimming = GetBool("ComputeTrimming", false);
@@ -171,6 +184,25 @@ void FastJetFinder::Init()
   fSymmetryCutSoftDrop = GetDouble("SymmetryCutSoftDrop", 0.1);
   fR0SoftDrop = GetDouble("R0SoftDrop=", 0.8);
 
+  // substructure tools are built once and applied to every jet
+  if(fComputeTrimming)
+  {
+    fTrimmer = new fastjet::Filter(JetDefinition(kt_algorithm, fRTrim), SelectorPtFractionMin(fPtFracTrim));
+  }
+
+  if(fComputePruning)
+  {
+    fPruner = new fastjet::Pruner(JetDefinition(cambridge_algorithm, fRPrun), fZcutPrun, fRcutPrun);
+  }
+
+  if(fComputeSoftDrop)
+  {
+    // the jet is reclustered with C/A before soft drop is applied to it
+    fSoftDropRecluster = new fastjet::Recluster(cambridge_algorithm, JetDefinition::max_allowable_R);
+    fSoftDrop = new contrib::SoftDrop(fBetaSoftDrop, fSymmetryCutSoftDrop, fR0SoftDrop);
+    fSoftDrop->set_reclustering(false);
+  }
+
   // ---  Jet Area Parameters ---
 
   fAreaAlgorithm = GetInt("AreaAlgorithm", 0);
@@ -292,6 +324,9 @@ void FastJetFinder::Init()
   fOutputArray = ExportArray(GetString("OutputArray", "jets"));
   fRhoOutputArray = ExportArray(GetString("RhoOutputArray", "rho"));
   fConstituentsOutputArray = ExportArray(GetString("ConstituentsOutputArray", "constituents"));
+
+  SetInputReadOnly(kTRUE);
+  SetSerialized(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -313,6 +348,12 @@ void FastJetFinder::Finish()
   delete fNjettinessPlugin;
   delete fAxesDef;
   delete fMeasureDef;
+  delete fAxesDefinition;
+  delete fAxesRecomb;
+  delete fTrimmer;
+  delete fPruner;
+  delete fSoftDropRecluster;
+  delete fSoftDrop;
   delete fValenciaPlugin;
 }
 
@@ -328,11 +369,11 @@ void FastJetFinder::Process()
   Double_t neutralEnergyFraction, chargedEnergyFraction;
 
   Int_t number, ncharged, nneutrals;
-  Int_t charge;
+  Int_t charge, n, i;
   Double_t rho = 0.0;
   PseudoJet jet, area;
   ClusterSequence *sequence;
-  vector<PseudoJet> inputList, outputList, subjets;
+  vector<PseudoJet> inputList, outputList, subjets, axes;
   vector<PseudoJet>::iterator itInputList, itOutputList;
   vector<TEstimatorStruct>::iterator itEstimators;
   Double_t excl_ymerge12 = 0.0;
@@ -503,8 +544,7 @@ void FastJetFinder::Process()
     if(fComputeTrimming)
     {
 
-      fastjet::Filter trimmer(fastjet::JetDefinition(fastjet::kt_algorithm, fRTrim), fastjet::SelectorPtFractionMin(fPtFracTrim));
-      fastjet::PseudoJet trimmed_jet = trimmer(*itOutputList);
+      fastjet::PseudoJet trimmed_jet = (*fTrimmer)(*itOutputList);
 
       candidate->TrimmedP4[0].SetPtEtaPhiM(trimmed_jet.pt(), trimmed_jet.eta(), trimmed_jet.phi(), trimmed_jet.m());
 
@@ -529,8 +569,7 @@ void FastJetFinder::Process()
     if(fComputePruning)
     {
 
-      fastjet::Pruner pruner(fastjet::JetDefinition(fastjet::cambridge_algorithm, fRPrun), fZcutPrun, fRcutPrun);
-      fastjet::PseudoJet pruned_jet = pruner(*itOutputList);
+      fastjet::PseudoJet pruned_jet = (*fPruner)(*itOutputList);
 
       candidate->PrunedP4[0].SetPtEtaPhiM(pruned_jet.pt(), pruned_jet.eta(), pruned_jet.phi(), pruned_jet.m());
 
@@ -555,8 +594,7 @@ void FastJetFinder::Process()
     if(fComputeSoftDrop)
     {
 
-      contrib::SoftDrop softDrop(fBetaSoftDrop, fSymmetryCutSoftDrop, fR0SoftDrop);
-      fastjet::PseudoJet softdrop_jet = softDrop(*itOutputList);
+      fastjet::PseudoJet softdrop_jet = (*fSoftDrop)((*fSoftDropRecluster)(*itOutputList));
 
       candidate->SoftDroppedP4[0].SetPtEtaPhiM(softdrop_jet.pt(), softdrop_jet.eta(), softdrop_jet.phi(), softdrop_jet.m());
 
@@ -582,18 +620,25 @@ void FastJetFinder::Process()
 
     if(fComputeNsubjettiness)
     {
+      // seed axes for all N from a single exclusive kt clustering of the constituents,
+      // as done separately for each N by Nsubjettiness
+      ClusterSequence axesSequence(inputList, *fAxesDefinition);
 
-      Nsubjettiness nSub1(1, *fAxesDef, *fMeasureDef);
-      Nsubjettiness nSub2(2, *fAxesDef, *fMeasureDef);
-      Nsubjettiness nSub3(3, *fAxesDef, *fMeasureDef);
-      Nsubjettiness nSub4(4, *fAxesDef, *fMeasureDef);
-      Nsubjettiness nSub5(5, *fAxesDef, *fMeasureDef);
-
-      candidate->Tau[0] = nSub1(*itOutputList);
-      candidate->Tau[1] = nSub2(*itOutputList);
-      candidate->Tau[2] = nSub3(*itOutputList);
-      candidate->Tau[3] = nSub4(*itOutputList);
-      candidate->Tau[4] = nSub5(*itOutputList);
+      for(n = 1; n <= 5; ++n)
+      {
+        if(Int_t(inputList.size()) <= n)
+        {
+          candidate->Tau[n - 1] = 0.0;
+          continue;
+        }
+
+        subjets = axesSequence.exclusive_jets_up_to(n);
+        axes.resize(n);
+        for(i = 0; i < n; ++i) axes[i].reset_momentum(subjets[i]);
+
+        axes = fAxesDef->get_refined_axes(n, inputList, axes, fMeasureDef);
+        candidate->Tau[n - 1] = fMeasureDef->result(inputList, axes);
+      }
     }
 
     fOutputArray->Add(candidate);
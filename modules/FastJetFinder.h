@@ -39,12 +39,17 @@ namespace fastjet
 class JetDefinition;
 class AreaDefinition;
 class JetMedianBackgroundEstimator;
+class Filter;
+class Pruner;
+class Recluster;
 namespace contrib
 {
 class NjettinessPlugin;
 class ValenciaPlugin;
 class AxesDefinition;
 class MeasureDefinition;
+class SoftDrop;
+class WinnerTakeAllRecombiner;
 } // namespace contrib
 } // namespace fastjet
 
@@ -65,6 +70,15 @@ private:
   fastjet::contrib::AxesDefinition *fAxesDef = nullptr;
   fastjet::contrib::MeasureDefinition *fMeasureDef = nullptr;
 
+  // exclusive kt clustering giving the N-subjettiness seed axes
+  fastjet::JetDefinition *fAxesDefinition = nullptr; //!
+  fastjet::contrib::WinnerTakeAllRecombiner *fAxesRecomb = nullptr; //!
+
+  fastjet::Filter *fTrimmer = nullptr; //!
+  fastjet::Pruner *fPruner = nullptr; //!
+  fastjet::Recluster *fSoftDropRecluster = nullptr; //!
+  fastjet::contrib::SoftDrop *fSoftDrop = nullptr; //!
+
   fastjet::contrib::NjettinessPlugin *fNjettinessPlugin = nullptr; //!
   fastjet::contrib::ValenciaPlugin *fValenciaPlugin = nullptr; //!
   fastjet::JetDefinition *fDefinition = nullptr; //!
@@ -113,6 +113,8 @@ void FastJetGridMedianEstimator::Init()
   fItInputArray = fInputArray->MakeIterator();
 
   fRhoOutputArray = ExportArray(GetString("RhoOutputArray", "rho"));
+
+  SetSerialized(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -21,6 +21,13 @@
  *  Converts particles with some PDG code into another particle,
  *  according to parametrized probability.
  *
+ *  With UseWeights set to true, particles with a non-zero probability are
+ *  copied and weighted by this probability, followed by the probabilities
+ *  of EfficiencyFormula<name> for each name of the global WeightVariations
+ *  (see Candidate::EfficiencyWeights).  Each PDG code should then have a
+ *  single outcome, and variations should list the same PDG codes in the
+ *  same order as EfficiencyFormula.
+ *
  *  \author M. Selvaggi - UCL, Louvain-la-Neuve
  *
  */
@@ -64,7 +71,7 @@ IdentificationMap::~IdentificationMap()
 
 //------------------------------------------------------------------------------
 
-void IdentificationMap::Init()
+void IdentificationMap::ReadEfficiencyMap(const char *name, TMisIDMap &efficiencyMap)
 {
   TMisIDMap::iterator itEfficiencyMap;
   ExRootConfParam param;
@@ -72,26 +79,86 @@ void IdentificationMap::Init()
   Int_t i, size, pdg;
 
   // read efficiency formulas
-  param = GetParam("EfficiencyFormula");
+  param = GetParam(name);
   size = param.GetSize();
 
-  fEfficiencyMap.clear();
+  efficiencyMap.clear();
   for(i = 0; i < size / 3; ++i)
   {
     formula = new DelphesFormula;
     formula->Compile(param[i * 3 + 2].GetString());
     pdg = param[i * 3].GetInt();
-    fEfficiencyMap.insert(make_pair(pdg, make_pair(param[i * 3 + 1].GetInt(), formula)));
+    efficiencyMap.insert(make_pair(pdg, make_pair(param[i * 3 + 1].GetInt(), formula)));
   }
 
   // set default efficiency formula
-  itEfficiencyMap = fEfficiencyMap.find(0);
-  if(itEfficiencyMap == fEfficiencyMap.end())
+  itEfficiencyMap = efficiencyMap.find(0);
+  if(itEfficiencyMap == efficiencyMap.end())
   {
     formula = new DelphesFormula;
     formula->Compile("1.0");
 
-    fEfficiencyMap.insert(make_pair(0, make_pair(0, formula)));
+    efficiencyMap.insert(make_pair(0, make_pair(0, formula)));
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void IdentificationMap::Init()
+{
+  TMisIDMap::iterator itEfficiencyMap, itVariationMap;
+  ExRootConfParam param;
+  stringstream message;
+  TString name;
+  Int_t i, size;
+
+  ReadEfficiencyMap("EfficiencyFormula", fEfficiencyMap);
+
+  fUseWeights = GetBool("UseWeights", false);
+
+  // outcomes of a particle are exclusive, they cannot be kept as
+  // separate weighted copies
+  for(itEfficiencyMap = fEfficiencyMap.begin(); fUseWeights && itEfficiencyMap != fEfficiencyMap.end(); ++itEfficiencyMap)
+  {
+    if(fEfficiencyMap.count(itEfficiencyMap->first) > 1)
+    {
+      message << "UseWeights requires a single outcome for PDG code " << itEfficiencyMap->first;
+      message << " in module '" << GetName() << "'";
+      throw runtime_error(message.str());
+    }
+  }
+
+  // read efficiency formulas of the variations, missing variations use
+  // the nominal formulas
+
+  param = GetWeightVariations();
+  size = param.GetSize();
+
+  fVariationMaps.clear();
+  for(i = 0; fUseWeights && i < size; ++i)
+  {
+    name = TString("EfficiencyFormula") + param[i].GetString();
+    if(GetParam(name).GetSize() == 0) name = "EfficiencyFormula";
+
+    fVariationMaps.push_back(TMisIDMap());
+    ReadEfficiencyMap(name, fVariationMaps.back());
+
+    itEfficiencyMap = fEfficiencyMap.begin();
+    itVariationMap = fVariationMaps.back().begin();
+    while(itEfficiencyMap != fEfficiencyMap.end() && itVariationMap != fVariationMaps.back().end()
+      && itEfficiencyMap->first == itVariationMap->first
+      && itEfficiencyMap->second.first == itVariationMap->second.first)
+    {
+      ++itEfficiencyMap;
+      ++itVariationMap;
+    }
+
+    if(itEfficiencyMap != fEfficiencyMap.end() || itVariationMap != fVariationMaps.back().end())
+    {
+      message << "efficiency formulas '" << name << "' in module '" << GetName() << "'";
+      message << " should list the same PDG codes in the same order as 'EfficiencyFormula'";
+      throw runtime_error(message.str());
+    }
   }
 
   // import input array
@@ -117,6 +184,16 @@ void IdentificationMap::Finish()
     formula = (itEfficiencyMap->second).second;
     if(formula) delete formula;
   }
+
+  vector<TMisIDMap>::iterator itVariationMaps;
+  for(itVariationMaps = fVariationMaps.begin(); itVariationMaps != fVariationMaps.end(); ++itVariationMaps)
+  {
+    for(itEfficiencyMap = itVariationMaps->begin(); itEfficiencyMap != itVariationMaps->end(); ++itEfficiencyMap)
+    {
+      formula = (itEfficiencyMap->second).second;
+      if(formula) delete formula;
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -129,6 +206,8 @@ void IdentificationMap::Process()
   pair<TMisIDMap::iterator, TMisIDMap::iterator> range;
   DelphesFormula *formula;
   Int_t pdgCodeIn, pdgCodeOut, charge;
+  vector<TMisIDMap::iterator> itVariations;
+  vector<TMisIDMap>::size_type i, variations = fVariationMaps.size();
 
   Double_t p, r, total;
 
@@ -154,6 +233,42 @@ void IdentificationMap::Process()
     if(range.first == range.second) range = fEfficiencyMap.equal_range(-pdgCodeIn);
     if(range.first == range.second) range = fEfficiencyMap.equal_range(0);
 
+    if(fUseWeights)
+    {
+      // no map entry for this PDG code, the candidate is dropped
+      if(range.first == range.second) continue;
+
+      // variations list the same PDG codes in the same order
+      itVariations.clear();
+      for(i = 0; i < variations; ++i)
+      {
+        itVariations.push_back(fVariationMaps[i].lower_bound(range.first->first));
+      }
+
+      // keep a weighted copy for the single outcome
+      for(TMisIDMap::iterator it = range.first; it != range.second; ++it)
+      {
+        pdgCodeOut = (it->second).first;
+
+        fWeights.clear();
+        fWeights.push_back((it->second).second->Eval(pt, eta, phi, e));
+        for(i = 0; i < variations; ++i)
+        {
+          fWeights.push_back((itVariations[i]->second).second->Eval(pt, eta, phi, e));
+          ++itVariations[i];
+        }
+
+        if(*max_element(fWeights.begin(), fWeights.end()) <= 0.0) continue;
+
+        Candidate *clone = static_cast<Candidate *>(candidate->Clone());
+        if(pdgCodeOut != 0) clone->PID = charge * pdgCodeOut;
+        clone->MultiplyEfficiencyWeights(fWeights);
+        fOutputArray->Add(clone);
+      }
+
+      continue;
+    }
+
     r = gRandom->Uniform();
     total = 0.0;
 
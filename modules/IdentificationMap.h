@@ -24,12 +24,22 @@
  *  Converts particles with some PDG code into another particle,
  *  according to parametrized probability.
  *
+ *  With UseWeights set to true, particles with a non-zero probability are
+ *  copied and weighted by this probability, followed by the probabilities
+ *  of EfficiencyFormula<name> for each name of the global WeightVariations
+ *  (see Candidate::EfficiencyWeights).  Each PDG code should then have a
+ *  single outcome, and variations should list the same PDG codes in the
+ *  same order as EfficiencyFormula.
+ *
  *  \author M. Selvaggi - UCL, Louvain-la-Neuve
  *
  */
 
 #include "classes/DelphesModule.h"
 
+#include <map>
+#include <vector>
+
 class TIterator;
 class TObjArray;
 class DelphesFormula;
@@ -49,6 +59,14 @@ private:
 
   TMisIDMap fEfficiencyMap; //!
 
+  Bool_t fUseWeights; //!
+
+  std::vector<TMisIDMap> fVariationMaps; //!
+
+  std::vector<Double_t> fWeights; //!
+
+  void ReadEfficiencyMap(const char *name, TMisIDMap &efficiencyMap);
+
   TIterator *fItInputArray = nullptr; //!
 
   const TObjArray *fInputArray = nullptr; //!
@@ -26,6 +26,7 @@
 
 #include "modules/ImpactParameterSmearing.h"
 
+#include "classes/DelphesCandidateBatch.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
@@ -54,6 +55,7 @@ using namespace std;
 ImpactParameterSmearing::ImpactParameterSmearing()
 {
   fFormula = new DelphesFormula;
+  fBatch = new DelphesCandidateBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -61,6 +63,7 @@ ImpactParameterSmearing::ImpactParameterSmearing()
 ImpactParameterSmearing::~ImpactParameterSmearing()
 {
   delete fFormula;
+  delete fBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -70,6 +73,7 @@ void ImpactParameterSmearing::Init()
   // read resolution formula
 
   fFormula->Compile(GetString("ResolutionFormula", "0.0"));
+  TabulateFormula(fFormula, "ResolutionMap");
 
   // import input array
 
@@ -93,23 +97,38 @@ void ImpactParameterSmearing::Finish()
 void ImpactParameterSmearing::Process()
 {
   Candidate *candidate, *particle, *mother;
-  Double_t xd, yd, zd, d0, sx, sy, sz, dd0;
-  Double_t pt, eta, px, py, phi, e;
+  Double_t xd, yd, zd, d0, sx, sy, sz, dd0, sigma;
+  Double_t pt, px, py;
+  Int_t i, size;
+
+  fBatch->Clear();
 
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
   {
-
     // take momentum before smearing (otherwise apply double smearing on d0)
     particle = static_cast<Candidate *>(candidate->GetCandidates()->At(0));
 
     const TLorentzVector &candidateMomentum = particle->Momentum;
 
-    eta = candidateMomentum.Eta();
-    pt = candidateMomentum.Pt();
-    phi = candidateMomentum.Phi();
-    e = candidateMomentum.E();
+    fBatch->Add(candidate, candidateMomentum.Pt(), candidateMomentum.Eta(), candidateMomentum.Phi(), candidateMomentum.E());
+  }
+
+  // the resolution only depends on the kinematics, evaluate it once per candidate
+  fBatch->Evaluate(fFormula, kFALSE);
+
+  // four random numbers per candidate, drawn in the order x, y, z, d0
+  size = fBatch->GetSize();
+  fBatch->DrawGaus(4 * size);
+
+  for(i = 0; i < size; ++i)
+  {
+    candidate = fBatch->Candidates[i];
+    particle = static_cast<Candidate *>(candidate->GetCandidates()->At(0));
+
+    const TLorentzVector &candidateMomentum = particle->Momentum;
 
+    pt = fBatch->PT[i];
     px = candidateMomentum.Px();
     py = candidateMomentum.Py();
 
@@ -119,9 +138,10 @@ void ImpactParameterSmearing::Process()
     zd = candidate->Zd;
 
     // calculate smeared values
-    sx = gRandom->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
-    sy = gRandom->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
-    sz = gRandom->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
+    sigma = fBatch->Values[i];
+    sx = sigma * fBatch->Random[4 * i];
+    sy = sigma * fBatch->Random[4 * i + 1];
+    sz = sigma * fBatch->Random[4 * i + 2];
 
     xd += sx;
     yd += sy;
@@ -130,7 +150,7 @@ void ImpactParameterSmearing::Process()
     // calculate impact parameter (after-smearing)
     d0 = (xd * py - yd * px) / pt;
 
-    dd0 = gRandom->Gaus(0.0, fFormula->Eval(pt, eta, phi, e));
+    dd0 = sigma * fBatch->Random[4 * i + 3];
 
     // fill smeared values in candidate
     mother = candidate;
@@ -32,6 +32,7 @@
 class TIterator;
 class TObjArray;
 class DelphesFormula;
+class DelphesCandidateBatch;
 
 class ImpactParameterSmearing: public DelphesModule
 {
@@ -46,6 +47,8 @@ public:
 private:
   DelphesFormula *fFormula = nullptr; //!
 
+  DelphesCandidateBatch *fBatch = nullptr; //!
+
   TIterator *fItInputArray = nullptr; //!
 
   const TObjArray *fInputArray = nullptr; //!
@@ -89,6 +89,8 @@ void Merger::Init()
   fMomentumOutputArray = ExportArray(GetString("MomentumOutputArray", "momentum"));
 
   fEnergyOutputArray = ExportArray(GetString("EnergyOutputArray", "energy"));
+
+  SetInputReadOnly(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -47,6 +47,7 @@
 #include "modules/DualReadoutCalorimeter.h"
 #include "modules/OldCalorimeter.h"
 #include "modules/Isolation.h"
+#include "modules/MultiIsolation.h"
 #include "modules/EnergyScale.h"
 #include "modules/UniqueObjectFinder.h"
 #include "modules/TrackCountingBTagging.h"
@@ -75,6 +76,7 @@
 #include "modules/VertexSorter.h"
 #include "modules/VertexFinder.h"
 #include "modules/VertexFinderDA4D.h"
+#include "modules/VertexFitter.h"
 #include "modules/DecayFilter.h"
 #include "modules/ParticleDensity.h"
 #include "modules/TruthVertexFinder.h"
@@ -82,6 +84,7 @@
 #include "modules/LLPFilter.h"
 #include "modules/CscClusterEfficiency.h"
 #include "modules/CscClusterId.h"
+#include "modules/EventFilter.h"
 
 #ifdef __CINT__
 
@@ -111,6 +114,7 @@
 #pragma link C++ class DualReadoutCalorimeter+;
 #pragma link C++ class OldCalorimeter+;
 #pragma link C++ class Isolation+;
+#pragma link C++ class MultiIsolation+;
 #pragma link C++ class EnergyScale+;
 #pragma link C++ class UniqueObjectFinder+;
 #pragma link C++ class TrackCountingBTagging+;
@@ -139,6 +143,7 @@
 #pragma link C++ class VertexSorter+;
 #pragma link C++ class VertexFinder+;
 #pragma link C++ class VertexFinderDA4D+;
+#pragma link C++ class VertexFitter+;
 #pragma link C++ class DecayFilter+;
 #pragma link C++ class ParticleDensity+;
 #pragma link C++ class TruthVertexFinder+;
@@ -146,5 +151,6 @@
 #pragma link C++ class LLPFilter+;
 #pragma link C++ class CscClusterEfficiency+;
 #pragma link C++ class CscClusterId+;
+#pragma link C++ class EventFilter+;
 
 #endif
@@ -26,6 +26,7 @@
 
 #include "modules/MomentumSmearing.h"
 
+#include "classes/DelphesCandidateBatch.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
@@ -54,6 +55,7 @@ using namespace std;
 MomentumSmearing::MomentumSmearing()
 {
   fFormula = new DelphesFormula;
+  fBatch = new DelphesCandidateBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -61,6 +63,7 @@ MomentumSmearing::MomentumSmearing()
 MomentumSmearing::~MomentumSmearing()
 {
   delete fFormula;
+  delete fBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -70,6 +73,7 @@ void MomentumSmearing::Init()
   // read resolution formula
 
   fFormula->Compile(GetString("ResolutionFormula", "0.0"));
+  TabulateFormula(fFormula, "ResolutionMap");
 
   // import input array
 
@@ -82,6 +86,8 @@ void MomentumSmearing::Init()
   // create output array
 
   fOutputArray = ExportArray(GetString("OutputArray", "stableParticles"));
+
+  SetInputReadOnly(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -97,6 +103,9 @@ void MomentumSmearing::Process()
 {
   Candidate *candidate, *mother;
   Double_t pt, eta, phi, e, m, res;
+  Int_t i, j, size, count;
+
+  fBatch->Clear();
 
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
@@ -114,22 +123,45 @@ void MomentumSmearing::Process()
 
     pt = candidateMomentum.Pt();
     e = candidateMomentum.E();
-    m = candidateMomentum.M();
-    res = fFormula->Eval(pt, eta, phi, e, candidate);
+
+    fBatch->Add(candidate, pt, eta, phi, e);
+  }
+
+  // evaluate smearing formula for all candidates at once
+  fBatch->Evaluate(fFormula);
+
+  // random numbers are only needed for candidates with positive pt
+  size = fBatch->GetSize();
+  count = 0;
+  for(i = 0; i < size; ++i)
+  {
+    if(fBatch->PT[i] > 0.0) ++count;
+  }
+  fBatch->DrawGaus(count);
+
+  j = 0;
+  for(i = 0; i < size; ++i)
+  {
+    candidate = fBatch->Candidates[i];
+    pt = fBatch->PT[i];
+    res = fBatch->Values[i];
 
     // apply smearing formula
     //pt = gRandom->Gaus(pt, fFormula->Eval(pt, eta, phi, e) * pt);
 
     res = (res > 1.0) ? 1.0 : res;
 
-    pt = LogNormal(pt, res * pt);
+    pt = (pt > 0.0) ? LogNormal(pt, res * pt, fBatch->Random[j++]) : 0.0;
 
     //if(pt <= 0.0) continue;
 
-    mother = candidate;
-    candidate = static_cast<Candidate *>(candidate->Clone());
+    const TLorentzVector &candidateMomentum = candidate->Momentum;
     eta = candidateMomentum.Eta();
     phi = candidateMomentum.Phi();
+    m = candidateMomentum.M();
+
+    mother = candidate;
+    candidate = static_cast<Candidate *>(candidate->Clone());
     candidate->Momentum.SetPtEtaPhiM(pt, eta, phi, m);
     //candidate->TrackResolution = fFormula->Eval(pt, eta, phi, e);
     candidate->TrackResolution = res;
@@ -140,7 +172,7 @@ void MomentumSmearing::Process()
 }
 //----------------------------------------------------------------
 
-Double_t MomentumSmearing::LogNormal(Double_t mean, Double_t sigma)
+Double_t MomentumSmearing::LogNormal(Double_t mean, Double_t sigma, Double_t gaus)
 {
   Double_t a, b;
 
@@ -149,7 +181,7 @@ Double_t MomentumSmearing::LogNormal(Double_t mean, Double_t sigma)
     b = TMath::Sqrt(TMath::Log((1.0 + (sigma * sigma) / (mean * mean))));
     a = TMath::Log(mean) - 0.5 * b * b;
 
-    return TMath::Exp(a + b * gRandom->Gaus(0.0, 1.0));
+    return TMath::Exp(a + b * gaus);
   }
   else
   {
@@ -32,6 +32,7 @@
 class TIterator;
 class TObjArray;
 class DelphesFormula;
+class DelphesCandidateBatch;
 
 class MomentumSmearing: public DelphesModule
 {
@@ -44,10 +45,12 @@ public:
   void Finish();
 
 private:
-  Double_t LogNormal(Double_t mean, Double_t sigma);
+  Double_t LogNormal(Double_t mean, Double_t sigma, Double_t gaus);
 
   DelphesFormula *fFormula = nullptr; //!
 
+  DelphesCandidateBatch *fBatch = nullptr; //!
+
   TIterator *fItInputArray = nullptr; //!
 
   const TObjArray *fInputArray = nullptr; //!
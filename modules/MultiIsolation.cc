@@ -0,0 +1,412 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class MultiIsolation
+ *
+ *  Same isolation variables and selection as the Isolation module,
+ *  computed for several candidate collections with respect to
+ *  a single collection of isolation objects.
+ *
+ *  The isolation objects are indexed once per event in phi bins sorted
+ *  by pseudorapidity, so that each candidate only visits the objects
+ *  close to it.  Each candidate collection has its own isolation cone,
+ *  veto cone, output array and optionally its own selection.  The same
+ *  input array can be isolated with several cones, the candidates of
+ *  every group after the first one are then cloned.
+ *
+ */
+
+#include "modules/MultiIsolation.h"
+
+#include "classes/DelphesClasses.h"
+#include "classes/DelphesFactory.h"
+
+#include "TLorentzVector.h"
+#include "TMath.h"
+#include "TObjArray.h"
+#include "TVector2.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+MultiIsolation::MultiIsolation() :
+  fNPhiBins(1)
+{
+}
+
+//------------------------------------------------------------------------------
+
+MultiIsolation::~MultiIsolation()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void MultiIsolation::Init()
+{
+  ExRootConfParam param, selection;
+  Long_t i, j, size;
+  const char *rhoInputArrayName;
+  stringstream message;
+  Target target;
+  Double_t deltaRMax = 0.0;
+
+  // default selection of all groups
+
+  Double_t ptRatioMax = GetDouble("PTRatioMax", 0.1);
+
+  Double_t ptSumMax = GetDouble("PTSumMax", 5.0);
+
+  Bool_t usePTSum = GetBool("UsePTSum", false);
+
+  Bool_t useRhoCorrection = GetBool("UseRhoCorrection", true);
+
+  Double_t ptMin = GetDouble("PTMin", 0.5);
+
+  // import input array(s)
+
+  fIsolationInputArray = ImportArray(GetString("IsolationInputArray", "EFlowMerger/eflow"));
+
+  rhoInputArrayName = GetString("RhoInputArray", "");
+  if(rhoInputArrayName[0] != '\0')
+  {
+    fRhoInputArray = ImportArray(rhoInputArrayName);
+  }
+  else
+  {
+    fRhoInputArray = 0;
+  }
+
+  // read candidate collections: input array, output array,
+  // isolation cone and veto cone (mini cone if positive,
+  // otherwise only the candidate itself is vetoed)
+
+  param = GetParam("Candidates");
+  size = param.GetSize();
+
+  if(size == 0 || size % 4 != 0)
+  {
+    throw runtime_error("Candidates should be given as groups of input array, output array, DeltaRMax and DeltaRMin");
+  }
+
+  // optional selection of a group, identified by its output array:
+  // output array, PTMin, PTRatioMax, PTSumMax, UsePTSum and UseRhoCorrection
+
+  selection = GetParam("Selection");
+
+  if(selection.GetSize() % 6 != 0)
+  {
+    message << "Selection should be given as groups of output array, PTMin, PTRatioMax, PTSumMax,";
+    message << " UsePTSum and UseRhoCorrection in module '" << GetName() << "'";
+    throw runtime_error(message.str());
+  }
+
+  fTargets.clear();
+  fPTMin = ptMin;
+  for(i = 0; i < size / 4; ++i)
+  {
+    target.inputArray = ImportArray(param[i * 4].GetString());
+    target.outputArray = ExportArray(param[i * 4 + 1].GetString());
+    target.deltaRMax = param[i * 4 + 2].GetDouble();
+    target.deltaRMin = param[i * 4 + 3].GetDouble();
+
+    if(target.deltaRMax <= 0.0)
+    {
+      throw runtime_error("DeltaRMax should be positive");
+    }
+
+    target.ptMin = ptMin;
+    target.ptRatioMax = ptRatioMax;
+    target.ptSumMax = ptSumMax;
+    target.usePTSum = usePTSum;
+    target.useRhoCorrection = useRhoCorrection;
+
+    for(j = 0; j < selection.GetSize() / 6; ++j)
+    {
+      if(string(selection[j * 6].GetString()) != param[i * 4 + 1].GetString()) continue;
+
+      target.ptMin = selection[j * 6 + 1].GetDouble();
+      target.ptRatioMax = selection[j * 6 + 2].GetDouble();
+      target.ptSumMax = selection[j * 6 + 3].GetDouble();
+      target.usePTSum = selection[j * 6 + 4].GetBool();
+      target.useRhoCorrection = selection[j * 6 + 5].GetBool();
+    }
+
+    // variables of candidates already isolated by another group are kept
+    target.clone = kFALSE;
+    for(j = 0; j < Long_t(fTargets.size()); ++j)
+    {
+      if(fTargets[j].inputArray == target.inputArray) target.clone = kTRUE;
+    }
+
+    deltaRMax = TMath::Max(deltaRMax, target.deltaRMax);
+    fPTMin = TMath::Min(fPTMin, target.ptMin);
+
+    fTargets.push_back(target);
+  }
+
+  // phi bins not narrower than the largest isolation cone,
+  // the candidates only visit their own bin and its two neighbours
+
+  fNPhiBins = TMath::Max(Int_t(TMath::TwoPi() / deltaRMax), 1);
+}
+
+//------------------------------------------------------------------------------
+
+void MultiIsolation::Finish()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void MultiIsolation::Index()
+{
+  Candidate *object;
+  Int_t i, j, size, bin;
+  Double_t binWidth = TMath::TwoPi() / fNPhiBins;
+  vector<Int_t> bins, next;
+
+  fObjects.clear();
+  fPT.clear();
+  fEta.clear();
+  fPhi.clear();
+
+  size = fIsolationInputArray->GetEntriesFast();
+  for(i = 0; i < size; ++i)
+  {
+    object = static_cast<Candidate *>(fIsolationInputArray->At(i));
+    const TLorentzVector &momentum = object->Momentum;
+
+    if(momentum.Pt() < fPTMin) continue;
+
+    fObjects.push_back(object);
+    fPT.push_back(momentum.Pt());
+    fEta.push_back(momentum.Eta());
+    fPhi.push_back(momentum.Phi());
+  }
+
+  // counting sort by phi bin
+
+  size = fObjects.size();
+
+  bins.resize(size);
+  fBinOffsets.assign(fNPhiBins + 1, 0);
+  for(i = 0; i < size; ++i)
+  {
+    bin = TMath::Min(Int_t((fPhi[i] + TMath::Pi()) / binWidth), fNPhiBins - 1);
+    bins[i] = TMath::Max(bin, 0);
+    ++fBinOffsets[bins[i] + 1];
+  }
+
+  for(bin = 0; bin < fNPhiBins; ++bin)
+  {
+    fBinOffsets[bin + 1] += fBinOffsets[bin];
+  }
+
+  fBinObjects.resize(size);
+  next.assign(fBinOffsets.begin(), fBinOffsets.end() - 1);
+  for(i = 0; i < size; ++i)
+  {
+    fBinObjects[next[bins[i]]++] = i;
+  }
+
+  // sort each bin by eta
+
+  fBinEta.resize(size);
+  for(bin = 0; bin < fNPhiBins; ++bin)
+  {
+    sort(fBinObjects.begin() + fBinOffsets[bin], fBinObjects.begin() + fBinOffsets[bin + 1],
+      [this](Int_t a, Int_t b) { return fEta[a] < fEta[b]; });
+
+    for(j = fBinOffsets[bin]; j < fBinOffsets[bin + 1]; ++j)
+    {
+      fBinEta[j] = fEta[fBinObjects[j]];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+Double_t MultiIsolation::FindRho(Double_t eta)
+{
+  Candidate *object;
+  Double_t rho = 0.0;
+  Int_t i;
+
+  if(!fRhoInputArray) return rho;
+
+  for(i = 0; i < fRhoInputArray->GetEntriesFast(); ++i)
+  {
+    object = static_cast<Candidate *>(fRhoInputArray->At(i));
+    if(eta >= object->Edges[0] && eta < object->Edges[1])
+    {
+      rho = object->Momentum.Pt();
+    }
+  }
+
+  return rho;
+}
+
+//------------------------------------------------------------------------------
+
+void MultiIsolation::Process()
+{
+  vector<Target>::iterator itTargets;
+  Candidate *candidate, *isolation, *mother;
+  Double_t sumChargedNoPU, sumChargedPU, sumNeutral, sumAllParticles;
+  Double_t sumDBeta, ratioDBeta, sumRhoCorr, ratioRhoCorr, sum, ratio;
+  Double_t eta, phi, deltaEta, deltaPhi, deltaR, rho, pt;
+  Int_t i, j, k, bin, binMin, binMax, first, last;
+  Double_t binWidth = TMath::TwoPi() / fNPhiBins;
+  Bool_t pass;
+
+  Index();
+
+  for(itTargets = fTargets.begin(); itTargets != fTargets.end(); ++itTargets)
+  {
+    const Target &target = *itTargets;
+
+    for(i = 0; i < target.inputArray->GetEntriesFast(); ++i)
+    {
+      candidate = static_cast<Candidate *>(target.inputArray->At(i));
+      const TLorentzVector &candidateMomentum = candidate->Momentum;
+      eta = candidateMomentum.Eta();
+      phi = candidateMomentum.Phi();
+
+      // collect isolation objects within the cone from the neighbouring bins,
+      // the eta window is slightly wider than the cone to be safe against rounding
+
+      fMatches.clear();
+
+      if(fNPhiBins < 3)
+      {
+        binMin = 0;
+        binMax = fNPhiBins - 1;
+      }
+      else
+      {
+        bin = TMath::Min(Int_t((phi + TMath::Pi()) / binWidth), fNPhiBins - 1);
+        bin = TMath::Max(bin, 0);
+        binMin = bin - 1;
+        binMax = bin + 1;
+      }
+
+      for(j = binMin; j <= binMax; ++j)
+      {
+        bin = (j + fNPhiBins) % fNPhiBins;
+
+        first = lower_bound(fBinEta.begin() + fBinOffsets[bin], fBinEta.begin() + fBinOffsets[bin + 1], eta - target.deltaRMax - 1.0E-9) - fBinEta.begin();
+        last = upper_bound(fBinEta.begin() + first, fBinEta.begin() + fBinOffsets[bin + 1], eta + target.deltaRMax + 1.0E-9) - fBinEta.begin();
+
+        for(k = first; k < last; ++k)
+        {
+          if(fPT[fBinObjects[k]] < target.ptMin) continue;
+
+          isolation = fObjects[fBinObjects[k]];
+
+          // same as TLorentzVector::DeltaR
+          deltaEta = eta - fEta[fBinObjects[k]];
+          deltaPhi = TVector2::Phi_mpi_pi(phi - fPhi[fBinObjects[k]]);
+          deltaR = TMath::Sqrt(deltaEta * deltaEta + deltaPhi * deltaPhi);
+
+          if(target.deltaRMin > 0.0)
+          {
+            pass = deltaR <= target.deltaRMax && deltaR > target.deltaRMin;
+          }
+          else
+          {
+            pass = deltaR <= target.deltaRMax && candidate->GetUniqueID() != isolation->GetUniqueID();
+          }
+
+          if(pass) fMatches.push_back(fBinObjects[k]);
+        }
+      }
+
+      // sum in input order, as the Isolation module does
+
+      sort(fMatches.begin(), fMatches.end());
+
+      sumNeutral = 0.0;
+      sumChargedNoPU = 0.0;
+      sumChargedPU = 0.0;
+      sumAllParticles = 0.0;
+
+      for(j = 0; j < Int_t(fMatches.size()); ++j)
+      {
+        isolation = fObjects[fMatches[j]];
+        pt = fPT[fMatches[j]];
+
+        sumAllParticles += pt;
+        if(isolation->Charge != 0)
+        {
+          if(isolation->IsRecoPU)
+          {
+            sumChargedPU += pt;
+          }
+          else
+          {
+            sumChargedNoPU += pt;
+          }
+        }
+        else
+        {
+          sumNeutral += pt;
+        }
+      }
+
+      rho = FindRho(TMath::Abs(eta));
+
+      // correct sum for pile-up contamination
+      sumDBeta = sumChargedNoPU + TMath::Max(sumNeutral - 0.5 * sumChargedPU, 0.0);
+      sumRhoCorr = sumChargedNoPU + TMath::Max(sumNeutral - TMath::Max(rho, 0.0) * target.deltaRMax * target.deltaRMax * TMath::Pi(), 0.0);
+      ratioDBeta = sumDBeta / candidateMomentum.Pt();
+      ratioRhoCorr = sumRhoCorr / candidateMomentum.Pt();
+
+      sum = target.useRhoCorrection ? sumRhoCorr : sumDBeta;
+      ratio = target.useRhoCorrection ? ratioRhoCorr : ratioDBeta;
+      pass = target.usePTSum ? sum <= target.ptSumMax : ratio <= target.ptRatioMax;
+
+      // only the selected candidates of a shared input array are cloned
+      if(target.clone)
+      {
+        if(!pass) continue;
+
+        mother = candidate;
+        candidate = static_cast<Candidate *>(candidate->Clone());
+        candidate->AddCandidate(mother);
+      }
+
+      candidate->IsolationVar = ratioDBeta;
+      candidate->IsolationVarRhoCorr = ratioRhoCorr;
+      candidate->SumPtCharged = sumChargedNoPU;
+      candidate->SumPtNeutral = sumNeutral;
+      candidate->SumPtChargedPU = sumChargedPU;
+      candidate->SumPt = sumAllParticles;
+
+      if(pass) target.outputArray->Add(candidate);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
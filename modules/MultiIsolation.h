@@ -0,0 +1,97 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MultiIsolation_h
+#define MultiIsolation_h
+
+/** \class MultiIsolation
+ *
+ *  Same isolation variables and selection as the Isolation module,
+ *  computed for several candidate collections with respect to
+ *  a single collection of isolation objects.
+ *
+ *  The isolation objects are indexed once per event in phi bins sorted
+ *  by pseudorapidity, so that each candidate only visits the objects
+ *  close to it.  Each candidate collection has its own isolation cone,
+ *  veto cone, output array and optionally its own selection.  The same
+ *  input array can be isolated with several cones, the candidates of
+ *  every group after the first one are then cloned.
+ *
+ */
+
+#include "classes/DelphesModule.h"
+
+#include <vector>
+
+class TObjArray;
+class Candidate;
+
+class MultiIsolation: public DelphesModule
+{
+public:
+  MultiIsolation();
+  ~MultiIsolation();
+
+  void Init();
+  void Process();
+  void Finish();
+
+private:
+  struct Target
+  {
+    const TObjArray *inputArray;
+    TObjArray *outputArray;
+    Double_t deltaRMax;
+    Double_t deltaRMin;
+    Double_t ptMin;
+    Double_t ptRatioMax;
+    Double_t ptSumMax;
+    Bool_t usePTSum;
+    Bool_t useRhoCorrection;
+    Bool_t clone;
+  };
+
+  void Index();
+  Double_t FindRho(Double_t eta);
+
+  // smallest PTMin of all groups, objects below it are not indexed
+  Double_t fPTMin;
+
+  std::vector<Target> fTargets; //!
+
+  Int_t fNPhiBins;
+
+  // isolation objects of the current event, in input order
+  std::vector<Candidate *> fObjects; //!
+  std::vector<Double_t> fPT, fEta, fPhi; //!
+
+  // object indices in phi bins sorted by eta, bin i ranges
+  // from fBinOffsets[i] to fBinOffsets[i + 1]
+  std::vector<Int_t> fBinOffsets, fBinObjects; //!
+  std::vector<Double_t> fBinEta; //!
+
+  std::vector<Int_t> fMatches; //!
+
+  const TObjArray *fIsolationInputArray = nullptr; //!
+
+  const TObjArray *fRhoInputArray = nullptr; //!
+
+  ClassDef(MultiIsolation, 1)
+};
+
+#endif
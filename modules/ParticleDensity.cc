@@ -20,6 +20,7 @@
  *
  *  This module calculates the particle multiplicity density in eta-phi bins.
  *  It then assigns the value to the candidates according to the candidate eta.
+ *  Optionally, the density is averaged over neighbouring bins.
  *
  *  \author R. Preghenella - INFN, Bologna
  *
@@ -36,7 +37,6 @@
 #include "ExRootAnalysis/ExRootResult.h"
 
 #include "TFormula.h"
-#include "TH2F.h"
 #include "TLorentzVector.h"
 #include "TMath.h"
 #include "TObjArray.h"
@@ -76,29 +76,42 @@ void ParticleDensity::Init()
 
   fOutputArray = ExportArray(GetString("OutputArray", "tracks"));
 
-  // create multiplicity histogram
+  // create multiplicity grid, bin edges are stored in single precision as in a TH2F
 
   ExRootConfParam paramEta = GetParam("EtaBins");
   const Long_t sizeEta = paramEta.GetSize();
-  Int_t nbinsEta = sizeEta - 1;
-  std::vector<Float_t> binsEta(static_cast<size_t>(sizeEta));
+  fEdgesEta.resize(sizeEta);
   for(Int_t i = 0; i < sizeEta; ++i)
   {
-    binsEta[i] = paramEta[i].GetDouble();
+    fEdgesEta[i] = Float_t(paramEta[i].GetDouble());
   }
 
   ExRootConfParam paramPhi = GetParam("PhiBins");
   const Long_t sizePhi = paramPhi.GetSize();
-  Int_t nbinsPhi = sizePhi - 1;
-  std::vector<Float_t> binsPhi(static_cast<size_t>(sizePhi));
+  fEdgesPhi.resize(sizePhi);
   for(Int_t i = 0; i < sizePhi; ++i)
   {
-    binsPhi[i] = paramPhi[i].GetDouble();
+    fEdgesPhi[i] = Float_t(paramPhi[i].GetDouble());
   }
 
-  fHisto = new TH2F("hParticleDensity", ";#eta;#varphi;d^{2}N/d#etad#varphi", nbinsEta, binsEta.data(), nbinsPhi, binsPhi.data());
+  if(sizeEta < 2 || sizePhi < 2)
+  {
+    throw runtime_error("ParticleDensity requires at least two EtaBins and two PhiBins edges");
+  }
+
+  fNEta = sizeEta - 1;
+  fNPhi = sizePhi - 1;
+
+  // bin contents including underflow and overflow bins
+  fCounts.assign((fNEta + 2) * (fNPhi + 2), 0);
+  fTouched.clear();
 
   fUseMomentumVector = GetBool("UseMomentumVector", false);
+
+  // average the density over (2 * SmoothingRadius + 1)^2 neighbouring bins,
+  // phi bins wrap around if they cover the full circle
+  fSmoothingRadius = GetInt("SmoothingRadius", 0);
+  fWrapPhi = TMath::Abs(fEdgesPhi.back() - fEdgesPhi.front() - TMath::TwoPi()) < 1.0E-5;
 }
 
 //------------------------------------------------------------------------------
@@ -106,47 +119,121 @@ void ParticleDensity::Init()
 void ParticleDensity::Finish()
 {
   delete fItInputArray;
-  delete fHisto;
 }
 
 //------------------------------------------------------------------------------
 
-void ParticleDensity::Process()
+Int_t ParticleDensity::FindBin(const vector<Double_t> &edges, Double_t value) const
 {
-  Candidate *candidate;
-  fHisto->Reset();
+  Int_t n = edges.size() - 1;
+  Int_t bin;
 
-  // loop over all input candidates to fill histogram
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
+  if(value < edges.front()) return 0;
+  if(value >= edges.back()) return n + 1;
+
+  // guess the bin assuming equal widths and correct it with the actual edges
+  bin = 1 + Int_t(n * (value - edges.front()) / (edges.back() - edges.front()));
+  if(bin > n) bin = n;
+
+  if(value < edges[bin - 1] || value >= edges[bin])
   {
-    if(fUseMomentumVector)
-      fHisto->Fill(candidate->Momentum.Eta(), candidate->Momentum.Phi());
-    else
-      fHisto->Fill(candidate->Position.Eta(), candidate->Position.Phi());
+    bin = upper_bound(edges.begin(), edges.end(), value) - edges.begin();
   }
 
-  // normalise by bin width
-  fHisto->Scale(1., "width");
+  return bin;
+}
+
+//------------------------------------------------------------------------------
+
+Double_t ParticleDensity::GetDensity(Int_t ieta, Int_t iphi) const
+{
+  // under- and overflow bins use the width of the closest bin, as TAxis::GetBinWidth
+  Int_t jeta = TMath::Min(TMath::Max(ieta, 1), fNEta);
+  Int_t jphi = TMath::Min(TMath::Max(iphi, 1), fNPhi);
+  Double_t width = (fEdgesEta[jeta] - fEdgesEta[jeta - 1]) * (fEdgesPhi[jphi] - fEdgesPhi[jphi - 1]);
+
+  return Float_t(fCounts[ieta * (fNPhi + 2) + iphi] / width);
+}
+
+//------------------------------------------------------------------------------
 
-  // loop over all input candidates to assign multiplicity
+Double_t ParticleDensity::GetSmoothedDensity(Int_t ieta, Int_t iphi) const
+{
+  Int_t jeta, jphi, kphi, n;
+  Double_t sum;
+
+  if(fSmoothingRadius <= 0 || ieta < 1 || ieta > fNEta || iphi < 1 || iphi > fNPhi)
+  {
+    return GetDensity(ieta, iphi);
+  }
+
+  n = 0;
+  sum = 0.0;
+  for(jeta = TMath::Max(ieta - fSmoothingRadius, 1); jeta <= TMath::Min(ieta + fSmoothingRadius, fNEta); ++jeta)
+  {
+    for(jphi = iphi - fSmoothingRadius; jphi <= iphi + fSmoothingRadius; ++jphi)
+    {
+      kphi = jphi;
+      if(fWrapPhi)
+      {
+        kphi = (jphi - 1 + fNPhi) % fNPhi + 1;
+      }
+      else if(jphi < 1 || jphi > fNPhi)
+      {
+        continue;
+      }
+      sum += GetDensity(jeta, kphi);
+      ++n;
+    }
+  }
+
+  return sum / n;
+}
+
+//------------------------------------------------------------------------------
+
+void ParticleDensity::Process()
+{
+  Candidate *candidate;
+  Int_t i, bin, ieta, iphi;
+
+  // loop over all input candidates to fill grid
+  fBins.clear();
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
   {
-    Int_t ieta, iphi;
     if(fUseMomentumVector)
     {
-      ieta = fHisto->GetXaxis()->FindBin(candidate->Momentum.Eta());
-      iphi = fHisto->GetYaxis()->FindBin(candidate->Momentum.Phi());
+      ieta = FindBin(fEdgesEta, candidate->Momentum.Eta());
+      iphi = FindBin(fEdgesPhi, candidate->Momentum.Phi());
     }
     else
     {
-      ieta = fHisto->GetXaxis()->FindBin(candidate->Position.Eta());
-      iphi = fHisto->GetYaxis()->FindBin(candidate->Position.Phi());
+      ieta = FindBin(fEdgesEta, candidate->Position.Eta());
+      iphi = FindBin(fEdgesPhi, candidate->Position.Phi());
     }
-    candidate->ParticleDensity = fHisto->GetBinContent(ieta, iphi);
+
+    bin = ieta * (fNPhi + 2) + iphi;
+    if(fCounts[bin]++ == 0) fTouched.push_back(bin);
+    fBins.push_back(bin);
+  }
+
+  // loop over all input candidates to assign multiplicity density
+  i = 0;
+  fItInputArray->Reset();
+  while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
+  {
+    bin = fBins[i++];
+    candidate->ParticleDensity = GetSmoothedDensity(bin / (fNPhi + 2), bin % (fNPhi + 2));
     fOutputArray->Add(candidate);
   }
+
+  // clear only the bins filled in this event
+  for(i = 0; i < Int_t(fTouched.size()); ++i)
+  {
+    fCounts[fTouched[i]] = 0;
+  }
+  fTouched.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -23,6 +23,7 @@
  *
  *  This module calculates the particle multiplicity density in eta-phi bins.
  *  It then assigns the value to the candidates according to the candidate eta.
+ *  Optionally, the density is averaged over neighbouring bins.
  *
  *  \author R. Preghenella - INFN, Bologna
  *
@@ -31,9 +32,9 @@
 #include "classes/DelphesModule.h"
 
 #include <deque>
+#include <vector>
 
 class TObjArray;
-class TH2F;
 
 class ParticleDensity: public DelphesModule
 {
@@ -46,6 +47,10 @@ public:
   void Finish();
 
 private:
+  Int_t FindBin(const std::vector<Double_t> &edges, Double_t value) const;
+  Double_t GetDensity(Int_t ieta, Int_t iphi) const;
+  Double_t GetSmoothedDensity(Int_t ieta, Int_t iphi) const;
+
   TIterator *fItInputArray = nullptr; //!
 
   const TObjArray *fInputArray = nullptr; //!
@@ -53,7 +58,20 @@ private:
   TObjArray *fOutputArray = nullptr; //!
 
   Bool_t fUseMomentumVector; // !
-  TH2F *fHisto = nullptr; //!
+
+  Int_t fSmoothingRadius;
+  Bool_t fWrapPhi;
+
+  Int_t fNEta, fNPhi;
+  std::vector<Double_t> fEdgesEta; //!
+  std::vector<Double_t> fEdgesPhi; //!
+
+  // number of candidates per bin and list of non-empty bins
+  std::vector<Int_t> fCounts; //!
+  std::vector<Int_t> fTouched; //!
+
+  // bin of each candidate in the current event
+  std::vector<Int_t> fBins; //!
 
   ClassDef(ParticleDensity, 1)
 };
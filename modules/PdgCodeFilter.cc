@@ -100,6 +100,8 @@ void PdgCodeFilter::Init()
 
   // create output array
   fOutputArray = ExportArray(GetString("OutputArray", "filteredParticles"));
+
+  SetInputReadOnly(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -22,6 +22,10 @@
  *  Non-matched pass the "fake" efficiency. Matched photons get further splitted into isolated and non-isolated (user can choose criterion for isolation)
  *  Isolated photons pass the "prompt" efficiency while the non-isolated pass the "non-prompt" efficiency
  *
+ *  With UseWeights set to true, photons are not dropped but weighted by the efficiency,
+ *  followed by the efficiencies of <formula><name> for each name of the global WeightVariations
+ *  (see Candidate::EfficiencyWeights)
+ *
  *  \author M. Selvaggi CERN
  *
  */
@@ -79,6 +83,12 @@ void PhotonID::Init()
   fNonPromptFormula->Compile(GetString("NonPromptFormula", "1.0"));
   fFakeFormula->Compile(GetString("FakeFormula", "1.0"));
 
+  // read formulae of the efficiency variations
+  fUseWeights = GetBool("UseWeights", false);
+  ReadVariations("PromptFormula", fPromptVariations);
+  ReadVariations("NonPromptFormula", fNonPromptVariations);
+  ReadVariations("FakeFormula", fFakeVariations);
+
   // import input arrays
   fInputPhotonArray = ImportArray(GetString("InputPhotonArray", "PhotonIsolation/photons"));
   fItInputPhotonArray = fInputPhotonArray->MakeIterator();
@@ -99,10 +109,36 @@ void PhotonID::Init()
 
 //------------------------------------------------------------------------------
 
+void PhotonID::ReadVariations(const char *name, vector<DelphesFormula *> &formulas)
+{
+  ExRootConfParam param;
+  DelphesFormula *formula;
+  Int_t i, size;
+
+  param = GetWeightVariations();
+  size = param.GetSize();
+
+  formulas.clear();
+  for(i = 0; fUseWeights && i < size; ++i)
+  {
+    formula = new DelphesFormula;
+    formula->Compile(GetString(Form("%s%s", name, param[i].GetString()), GetString(name, "1.0")));
+    formulas.push_back(formula);
+  }
+}
+
+//------------------------------------------------------------------------------
+
 void PhotonID::Finish()
 {
+  vector<DelphesFormula *>::iterator itFormulas;
+
   delete fItInputPhotonArray;
   delete fItInputGenArray;
+
+  for(itFormulas = fPromptVariations.begin(); itFormulas != fPromptVariations.end(); ++itFormulas) delete *itFormulas;
+  for(itFormulas = fNonPromptVariations.begin(); itFormulas != fNonPromptVariations.end(); ++itFormulas) delete *itFormulas;
+  for(itFormulas = fFakeVariations.begin(); itFormulas != fFakeVariations.end(); ++itFormulas) delete *itFormulas;
 }
 
 //------------------------------------------------------------------------------
@@ -113,6 +149,9 @@ void PhotonID::Process()
   Double_t pt, eta, phi, e;
   Double_t relIso;
   Bool_t isolated;
+  DelphesFormula *formula;
+  vector<DelphesFormula *> *variations;
+  vector<DelphesFormula *>::iterator itFormulas;
 
   //cout<< "----  new event ---------"<<endl;
 
@@ -140,10 +179,9 @@ void PhotonID::Process()
     {
       //cout<<"                    Fake!"<<endl;
 
-      if(gRandom->Uniform() > fFakeFormula->Eval(pt, eta, phi, e)) continue;
-      //cout<<"                    passed"<<endl;
+      formula = fFakeFormula;
+      variations = &fFakeVariations;
       candidate->Status = 3;
-      fOutputArray->Add(candidate);
     }
 
     // if matches photon in gen collection
@@ -157,22 +195,42 @@ void PhotonID::Process()
       if(isolated)
       {
         //cout<<"                       isolated!:   "<<relIso<<endl;
-        if(gRandom->Uniform() > fPromptFormula->Eval(pt, eta, phi, e)) continue;
-        //cout<<"                       passed"<<endl;
+        formula = fPromptFormula;
+        variations = &fPromptVariations;
         candidate->Status = 1;
-        fOutputArray->Add(candidate);
       }
 
       // if non-isolated apply non-prompt formula
       else
       {
         //cout<<"                       non-isolated!:   "<<relIso<<endl;
-        if(gRandom->Uniform() > fNonPromptFormula->Eval(pt, eta, phi, e)) continue;
-        //cout<<"                       passed"<<endl;
+        formula = fNonPromptFormula;
+        variations = &fNonPromptVariations;
         candidate->Status = 2;
-        fOutputArray->Add(candidate);
       }
     }
+
+    if(fUseWeights)
+    {
+      fWeights.clear();
+      fWeights.push_back(formula->Eval(pt, eta, phi, e));
+      for(itFormulas = variations->begin(); itFormulas != variations->end(); ++itFormulas)
+      {
+        fWeights.push_back((*itFormulas)->Eval(pt, eta, phi, e));
+      }
+
+      if(*max_element(fWeights.begin(), fWeights.end()) <= 0.0) continue;
+
+      // candidate is the copy made above, the input photon can belong to other arrays
+      candidate->MultiplyEfficiencyWeights(fWeights);
+    }
+    else if(gRandom->Uniform() > formula->Eval(pt, eta, phi, e))
+    {
+      continue;
+    }
+
+    //cout<<"                    passed"<<endl;
+    fOutputArray->Add(candidate);
   }
 }
 
@@ -25,12 +25,18 @@
  *  Non-matched pass the "fake" efficiency. Matched photons get further splitted into isolated and non-isolated (user can choose criterion for isolation)
  *  Isolated photons pass the "prompt" efficiency while the non-isolated pass the "non-prompt" efficiency
  *
+ *  With UseWeights set to true, photons are not dropped but weighted by the efficiency,
+ *  followed by the efficiencies of <formula><name> for each name of the global WeightVariations
+ *  (see Candidate::EfficiencyWeights)
+ *
  *  \author M. Selvaggi - CERN
  *
  */
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TIterator;
 class TObjArray;
 class DelphesFormula;
@@ -51,6 +57,18 @@ private:
   DelphesFormula *fNonPromptFormula = nullptr;
   DelphesFormula *fFakeFormula = nullptr;
 
+  Bool_t fUseWeights;
+
+#if !defined(__CINT__) && !defined(__CLING__)
+  std::vector<DelphesFormula *> fPromptVariations; //!
+  std::vector<DelphesFormula *> fNonPromptVariations; //!
+  std::vector<DelphesFormula *> fFakeVariations; //!
+
+  std::vector<Double_t> fWeights; //!
+
+  void ReadVariations(const char *name, std::vector<DelphesFormula *> &formulas);
+#endif
+
   // import input arrays
   const TObjArray *fInputPhotonArray = nullptr;
   TIterator *fItInputPhotonArray = nullptr;
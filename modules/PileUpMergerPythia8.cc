@@ -29,6 +29,7 @@
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesPileUpReader.h"
+#include "classes/DelphesPileUpWriter.h"
 #include "classes/DelphesTF2.h"
 
 #include "ExRootAnalysis/ExRootClassifier.h"
@@ -46,14 +47,166 @@
 #include "TString.h"
 
 #include <algorithm>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 
 using namespace std;
 
 //------------------------------------------------------------------------------
 
+struct PileUpParticle
+{
+  Int_t pid;
+  Float_t x, y, z, t;
+  Float_t px, py, pz, e;
+};
+
+struct PileUpEvent
+{
+  // number of entries in the Pythia event record
+  Int_t size;
+  vector<PileUpParticle> particles;
+};
+
+//------------------------------------------------------------------------------
+
+static void ReadPythiaEvent(Pythia8::Pythia *pythia, Double_t ptMin, PileUpEvent &event)
+{
+  Int_t i, status;
+  PileUpParticle particle;
+
+  while(!pythia->next());
+
+  event.size = pythia->event.size();
+  event.particles.clear();
+  for(i = 1; i < event.size; ++i)
+  {
+    Pythia8::Particle &entry = pythia->event[i];
+
+    status = entry.statusHepMC();
+
+    if(status != 1 || !entry.isVisible() || entry.pT() <= ptMin) continue;
+
+    particle.pid = entry.id();
+    particle.px = entry.px();
+    particle.py = entry.py();
+    particle.pz = entry.pz();
+    particle.e = entry.e();
+    particle.x = entry.xProd();
+    particle.y = entry.yProd();
+    particle.z = entry.zProd();
+    particle.t = entry.tProd();
+
+    event.particles.push_back(particle);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+/** \class PileUpMergerPythia8Worker
+ *
+ *  Generates minimum-bias events on a separate thread into a bounded
+ *  single-producer single-consumer ring buffer.
+ *
+ */
+
+class PileUpMergerPythia8Worker
+{
+public:
+  PileUpMergerPythia8Worker(Pythia8::Pythia *pythia, Double_t ptMin, Int_t capacity) :
+    fPythia(pythia), fPTMin(ptMin), fRing(capacity > 0 ? capacity : 1),
+    fHead(0), fTail(0), fStop(false), fThread(&PileUpMergerPythia8Worker::Run, this)
+  {
+  }
+
+  ~PileUpMergerPythia8Worker()
+  {
+    {
+      lock_guard<mutex> lock(fMutex);
+      fStop = true;
+    }
+    fNotFull.notify_all();
+    fThread.join();
+    delete fPythia;
+  }
+
+  // wait for the next event, it stays valid until Pop is called
+  const PileUpEvent &Front()
+  {
+    unique_lock<mutex> lock(fMutex);
+    fNotEmpty.wait(lock, [this] { return fTail != fHead; });
+    return fRing[fHead % fRing.size()];
+  }
+
+  void Pop()
+  {
+    {
+      lock_guard<mutex> lock(fMutex);
+      ++fHead;
+    }
+    fNotFull.notify_one();
+  }
+
+private:
+  void Run()
+  {
+    size_t tail;
+    while(true)
+    {
+      {
+        unique_lock<mutex> lock(fMutex);
+        fNotFull.wait(lock, [this] { return fStop || fTail - fHead < fRing.size(); });
+        if(fStop) break;
+        tail = fTail;
+      }
+
+      // the slot is not read by the consumer before fTail is increased
+      ReadPythiaEvent(fPythia, fPTMin, fRing[tail % fRing.size()]);
+
+      {
+        lock_guard<mutex> lock(fMutex);
+        ++fTail;
+      }
+      fNotEmpty.notify_one();
+    }
+  }
+
+  Pythia8::Pythia *fPythia;
+  Double_t fPTMin;
+
+  vector<PileUpEvent> fRing;
+  size_t fHead, fTail;
+  bool fStop;
+
+  mutex fMutex;
+  condition_variable fNotEmpty, fNotFull;
+
+  thread fThread;
+};
+
+//------------------------------------------------------------------------------
+
+// both execution modes configure their generators here,
+// a negative seed keeps the settings of the configuration file
+static Pythia8::Pythia *NewPythia(const char *fileName, Int_t seed)
+{
+  Pythia8::Pythia *pythia = new Pythia8::Pythia();
+  pythia->readFile(fileName);
+  if(seed >= 0)
+  {
+    pythia->readString("Random:setSeed = on");
+    pythia->readString(Form("Random:seed = %d", seed % 900000000));
+  }
+  pythia->init();
+  return pythia;
+}
+
+//------------------------------------------------------------------------------
+
 PileUpMergerPythia8::PileUpMergerPythia8()
 {
   fFunction = new DelphesTF2;
@@ -71,6 +224,8 @@ PileUpMergerPythia8::~PileUpMergerPythia8()
 void PileUpMergerPythia8::Init()
 {
   const char *fileName;
+  Pythia8::Pythia *pythia;
+  Int_t i, seed, bufferSize;
 
   fPileUpDistribution = GetInt("PileUpDistribution", 0);
 
@@ -90,8 +245,37 @@ void PileUpMergerPythia8::Init()
   fFunction->SetRange(-fZVertexSpread, -fTVertexSpread, fZVertexSpread, fTVertexSpread);
 
   fileName = GetString("ConfigFile", "MinBias.cmnd");
-  fPythia = new Pythia8::Pythia();
-  fPythia->readFile(fileName);
+
+  fNumberOfThreads = GetInt("NumberOfThreads", 0);
+  fNextWorker = 0;
+
+  // generator i is seeded with RandomSeed + i + 1, so that the sequential mode
+  // and a single worker thread produce the same pile-up events
+  seed = GetInt("RandomSeed", -1);
+
+  if(fNumberOfThreads > 0)
+  {
+    // one independently seeded generator per worker thread
+    if(seed < 0) seed = 0;
+    bufferSize = GetInt("BufferSize", 256);
+    for(i = 0; i < fNumberOfThreads; ++i)
+    {
+      pythia = NewPythia(fileName, seed + i + 1);
+      fWorkers.push_back(new PileUpMergerPythia8Worker(pythia, fPTMin, bufferSize));
+    }
+  }
+  else
+  {
+    fPythia = NewPythia(fileName, seed < 0 ? -1 : seed + 1);
+    fEvent = new PileUpEvent;
+  }
+
+  // optionally keep the generated events as a pile-up library for PileUpMerger
+  fileName = GetString("PileUpLibraryFile", "");
+  if(fileName[0])
+  {
+    fWriter = new DelphesPileUpWriter(fileName);
+  }
 
   // import input array
   fInputArray = ImportArray(GetString("InputArray", "Delphes/stableParticles"));
@@ -106,7 +290,23 @@ void PileUpMergerPythia8::Init()
 
 void PileUpMergerPythia8::Finish()
 {
+  vector<PileUpMergerPythia8Worker *>::iterator itWorker;
+
+  for(itWorker = fWorkers.begin(); itWorker != fWorkers.end(); ++itWorker)
+  {
+    delete *itWorker;
+  }
+  fWorkers.clear();
+
+  if(fWriter)
+  {
+    fWriter->WriteIndex();
+    delete fWriter;
+    fWriter = 0;
+  }
+
   delete fPythia;
+  delete fEvent;
 }
 
 //------------------------------------------------------------------------------
@@ -115,13 +315,14 @@ void PileUpMergerPythia8::Process()
 {
   TDatabasePDG *pdg = TDatabasePDG::Instance();
   TParticlePDG *pdgParticle;
-  Int_t pid, status;
   Float_t x, y, z, t, vx, vy;
-  Float_t px, py, pz, e;
   Double_t dz, dphi, dt;
-  Int_t numberOfEvents, event, numberOfParticles, i;
+  Int_t numberOfEvents, event, numberOfParticles;
   Candidate *candidate, *vertex;
   DelphesFactory *factory;
+  PileUpMergerPythia8Worker *worker = 0;
+  const PileUpEvent *pileUpEvent;
+  vector<PileUpParticle>::const_iterator itParticle;
 
   const Double_t c_light = 2.99792458E8;
 
@@ -176,7 +377,28 @@ void PileUpMergerPythia8::Process()
 
   for(event = 0; event < numberOfEvents; ++event)
   {
-    while(!fPythia->next());
+    if(fWorkers.empty())
+    {
+      ReadPythiaEvent(fPythia, fPTMin, *fEvent);
+      pileUpEvent = fEvent;
+    }
+    else
+    {
+      worker = fWorkers[fNextWorker];
+      fNextWorker = (fNextWorker + 1) % fWorkers.size();
+      pileUpEvent = &worker->Front();
+    }
+
+    if(fWriter)
+    {
+      for(itParticle = pileUpEvent->particles.begin(); itParticle != pileUpEvent->particles.end(); ++itParticle)
+      {
+        fWriter->WriteParticle(itParticle->pid,
+          itParticle->x, itParticle->y, itParticle->z, itParticle->t,
+          itParticle->px, itParticle->py, itParticle->pz, itParticle->e);
+      }
+      fWriter->WriteEntry();
+    }
 
     // --- Pile-up vertex smearing
 
@@ -189,43 +411,29 @@ void PileUpMergerPythia8::Process()
 
     vx = 0.0;
     vy = 0.0;
-    numberOfParticles = fPythia->event.size();
-    for(i = 1; i < numberOfParticles; ++i)
+    numberOfParticles = pileUpEvent->size;
+    for(itParticle = pileUpEvent->particles.begin(); itParticle != pileUpEvent->particles.end(); ++itParticle)
     {
-      Pythia8::Particle &particle = fPythia->event[i];
-
-      status = particle.statusHepMC();
-
-      if(status != 1 || !particle.isVisible() || particle.pT() <= fPTMin) continue;
-
-      pid = particle.id();
-      px = particle.px();
-      py = particle.py();
-      pz = particle.pz();
-      e = particle.e();
-      x = particle.xProd();
-      y = particle.yProd();
-      z = particle.zProd();
-      t = particle.tProd();
+      const PileUpParticle &particle = *itParticle;
 
       candidate = factory->NewCandidate();
 
-      candidate->PID = pid;
+      candidate->PID = particle.pid;
 
       candidate->Status = 1;
 
-      pdgParticle = pdg->GetParticle(pid);
+      pdgParticle = pdg->GetParticle(particle.pid);
       candidate->Charge = pdgParticle ? Int_t(pdgParticle->Charge() / 3.0) : -999;
       candidate->Mass = pdgParticle ? pdgParticle->Mass() : -999.9;
 
       candidate->IsPU = 1;
 
-      candidate->Momentum.SetPxPyPzE(px, py, pz, e);
+      candidate->Momentum.SetPxPyPzE(particle.px, particle.py, particle.pz, particle.e);
       candidate->Momentum.RotateZ(dphi);
 
-      x -= fInputBeamSpotX;
-      y -= fInputBeamSpotY;
-      candidate->Position.SetXYZT(x, y, z + dz, t + dt);
+      x = particle.x - fInputBeamSpotX;
+      y = particle.y - fInputBeamSpotY;
+      candidate->Position.SetXYZT(x, y, particle.z + dz, particle.t + dt);
       candidate->Position.RotateZ(dphi);
       candidate->Position += TLorentzVector(fOutputBeamSpotX, fOutputBeamSpotY, 0.0, 0.0);
 
@@ -235,6 +443,8 @@ void PileUpMergerPythia8::Process()
       fParticleOutputArray->Add(candidate);
     }
 
+    if(worker) worker->Pop();
+
     if(numberOfParticles > 0)
     {
       vx /= numberOfParticles;
@@ -23,14 +23,26 @@
  *
  *  Merges particles from pile-up sample into event
  *
+ *  With NumberOfThreads > 0, minimum-bias events are generated by
+ *  independently seeded Pythia instances on worker threads and
+ *  consumed in a fixed round-robin order, so that the output only
+ *  depends on the seeds and not on the thread scheduling.  Generator i
+ *  is seeded with RandomSeed + i + 1 in both modes, so one worker
+ *  thread reproduces the sequential mode when RandomSeed is set.
+ *
  *  \author M. Selvaggi - UCL, Louvain-la-Neuve
  *
  */
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TObjArray;
 class DelphesTF2;
+class DelphesPileUpWriter;
+class PileUpMergerPythia8Worker;
+struct PileUpEvent;
 
 namespace Pythia8
 {
@@ -61,9 +73,17 @@ private:
 
   Double_t fPTMin;
 
+  Int_t fNumberOfThreads;
+  Int_t fNextWorker;
+
   DelphesTF2 *fFunction = nullptr; //!
 
   Pythia8::Pythia *fPythia = nullptr; //!
+  PileUpEvent *fEvent = nullptr; //!
+
+  std::vector<PileUpMergerPythia8Worker *> fWorkers; //!
+
+  DelphesPileUpWriter *fWriter = nullptr; //!
 
   TIterator *fItInputArray = nullptr; //!
 
@@ -42,6 +42,8 @@ void RunPUPPI::Init()
   fApplyNoLep = GetBool("UseNoLep", true);
   fMinPuppiWeight = GetDouble("MinPuppiWeight", 0.01);
   fUseExp = GetBool("UseExp", false);
+  // number of threads computing the particle metrics, 0 to run on the main thread
+  fNumberOfThreads = GetInt("NumberOfThreads", 0);
   // read eta min ranges
   ExRootConfParam param = GetParam("EtaMinBin");
   fEtaMinBin.clear();
@@ -98,6 +100,8 @@ void RunPUPPI::Init()
   fOutputArray = ExportArray(GetString("OutputArray", "puppiParticles"));
   fOutputTrackArray = ExportArray(GetString("OutputArrayTracks", "puppiTracks"));
   fOutputNeutralArray = ExportArray(GetString("OutputArrayNeutrals", "puppiNeutrals"));
+
+  SetSerialized(kTRUE);
   // Create algorithm list for puppi
   std::vector<AlgoObj> puppiAlgo;
   if(puppiAlgo.empty())
@@ -139,6 +143,7 @@ void RunPUPPI::Init()
     puppiAlgo.push_back(algoTmp);
   }
   fPuppi = new PuppiContainer(true, fUseExp, fMinPuppiWeight, puppiAlgo);
+  fPuppi->setNumberOfThreads(fNumberOfThreads);
 }
 
 //------------------------------------------------------------------------------
@@ -165,7 +170,7 @@ void RunPUPPI::Process()
   fItNeutralInputArray->Reset();
   fPVItInputArray->Reset();
 
-  std::vector<Candidate *> InputParticles;
+  std::vector<Candidate *> &InputParticles = fInputParticles;
   InputParticles.clear();
 
   // take the leading vertex
@@ -173,7 +178,7 @@ void RunPUPPI::Process()
   Candidate *pv = static_cast<Candidate *>(fPVItInputArray->Next());
   if(pv) PVZ = pv->Position.Z();
   // Fill input particles for puppi
-  std::vector<RecoObj> puppiInputVector;
+  std::vector<RecoObj> &puppiInputVector = fPuppiInputVector;
   puppiInputVector.clear();
   // Loop on charge track candidate
   while((candidate = static_cast<Candidate *>(fItTrackInputArray->Next())))
@@ -260,10 +265,10 @@ void RunPUPPI::Process()
   // Create PUPPI container
   fPuppi->initialize(puppiInputVector);
   fPuppi->puppiWeights();
-  std::vector<PseudoJet> puppiParticles = fPuppi->puppiParticles();
+  const std::vector<PseudoJet> &puppiParticles = fPuppi->puppiParticles();
 
   // Loop on final particles
-  for(std::vector<PseudoJet>::iterator it = puppiParticles.begin(); it != puppiParticles.end(); it++)
+  for(std::vector<PseudoJet>::const_iterator it = puppiParticles.begin(); it != puppiParticles.end(); it++)
   {
     if(it->user_index() <= int(InputParticles.size()))
     {
@@ -2,10 +2,12 @@
 #define RunPUPPI_h
 
 #include "classes/DelphesModule.h"
+#include "PUPPI/RecoObj2.hh"
 #include <vector>
 
 class TObjArray;
 class TIterator;
+class Candidate;
 class PuppiContainer;
 
 class RunPUPPI: public DelphesModule
@@ -32,6 +34,7 @@ private:
   bool fApplyNoLep;
   double fMinPuppiWeight;
   bool fUseExp;
+  int fNumberOfThreads;
 
   std::vector<float> fEtaMinBin;
   std::vector<float> fEtaMaxBin;
@@ -47,6 +50,10 @@ private:
   std::vector<int> fMetricId;
   std::vector<int> fCombId;
 
+  // per-event inputs, kept to reuse their memory
+  std::vector<RecoObj> fPuppiInputVector; //!
+  std::vector<Candidate *> fInputParticles; //!
+
   TObjArray *fOutputArray = nullptr;
   TObjArray *fOutputTrackArray = nullptr;
   TObjArray *fOutputNeutralArray = nullptr;
@@ -179,6 +179,7 @@ void SimpleCalorimeter::Init()
 
   // read resolution formulas
   fResolutionFormula->Compile(GetString("ResolutionFormula", "0"));
+  TabulateFormula(fResolutionFormula, "ResolutionMap", kTRUE);
 
   // import array with output from other modules
   fParticleInputArray = ImportArray(GetString("ParticleInputArray", "ParticlePropagator/particles"));
@@ -192,6 +193,8 @@ void SimpleCalorimeter::Init()
 
   fEFlowTrackOutputArray = ExportArray(GetString("EFlowTrackOutputArray", "eflowTracks"));
   fEFlowTowerOutputArray = ExportArray(GetString("EFlowTowerOutputArray", "eflowTowers"));
+
+  SetInputReadOnly(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -22,6 +22,12 @@
  *  applies b-tagging efficiency (miss identification rate) formulas
  *  and sets b-tagging flags
  *
+ *  With UseWeights set to true, the tau-tagging flag is set for all jets
+ *  with a non-zero efficiency and the efficiencies are stored in TauWeights
+ *  for BitNumber, followed by the efficiencies of EfficiencyFormula<name>
+ *  for each name of the global WeightVariations.  Flavors missing in a
+ *  variation use the nominal formulas.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -115,9 +121,9 @@ TauTagging::~TauTagging()
 void TauTagging::Init()
 {
   map<Int_t, DelphesFormula *>::iterator itEfficiencyMap;
-  ExRootConfParam param;
+  ExRootConfParam param, variation;
   DelphesFormula *formula;
-  Int_t i, size;
+  Int_t i, j, size;
 
   fBitNumber = GetInt("BitNumber", 0);
 
@@ -146,6 +152,27 @@ void TauTagging::Init()
     fEfficiencyMap[0] = formula;
   }
 
+  // read efficiency formulas of the variations
+  fUseWeights = GetBool("UseWeights", false);
+
+  param = GetWeightVariations();
+  size = param.GetSize();
+
+  fVariationMaps.clear();
+  for(j = 0; fUseWeights && j < size; ++j)
+  {
+    fVariationMaps.push_back(map<Int_t, DelphesFormula *>());
+
+    variation = GetParam(Form("EfficiencyFormula%s", param[j].GetString()));
+    for(i = 0; i < variation.GetSize() / 2; ++i)
+    {
+      formula = new DelphesFormula;
+      formula->Compile(variation[i * 2 + 1].GetString());
+
+      fVariationMaps.back()[variation[i * 2].GetInt()] = formula;
+    }
+  }
+
   // import input array(s)
 
   fParticleInputArray = ImportArray(GetString("ParticleInputArray", "Delphes/allParticles"));
@@ -180,6 +207,15 @@ void TauTagging::Finish()
     formula = itEfficiencyMap->second;
     if(formula) delete formula;
   }
+
+  vector<map<Int_t, DelphesFormula *> >::iterator itVariationMaps;
+  for(itVariationMaps = fVariationMaps.begin(); itVariationMaps != fVariationMaps.end(); ++itVariationMaps)
+  {
+    for(itEfficiencyMap = itVariationMaps->begin(); itEfficiencyMap != itVariationMaps->end(); ++itEfficiencyMap)
+    {
+      delete itEfficiencyMap->second;
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -191,6 +227,7 @@ void TauTagging::Process()
   Double_t pt, eta, phi, e, eff;
   TObjArray *tauArray;
   map<Int_t, DelphesFormula *>::iterator itEfficiencyMap;
+  vector<map<Int_t, DelphesFormula *> >::iterator itVariationMaps;
   DelphesFormula *formula;
   Int_t pdgCode, charge, i;
 
@@ -279,7 +316,24 @@ void TauTagging::Process()
     // apply an efficency formula
     eff = formula->Eval(pt, eta, phi, e);
     jet->TauFlavor = pdgCode;
-    jet->TauTag |= (gRandom->Uniform() <= eff) << fBitNumber;
+    if(fUseWeights)
+    {
+      fWeights.clear();
+      fWeights.push_back(eff);
+
+      for(itVariationMaps = fVariationMaps.begin(); itVariationMaps != fVariationMaps.end(); ++itVariationMaps)
+      {
+        itEfficiencyMap = itVariationMaps->find(pdgCode);
+        fWeights.push_back((itEfficiencyMap != itVariationMaps->end() ? itEfficiencyMap->second : formula)->Eval(pt, eta, phi, e));
+      }
+
+      jet->SetTauWeights(fBitNumber, fWeights);
+      jet->TauTag |= (*max_element(fWeights.begin(), fWeights.end()) > 0.0) << fBitNumber;
+    }
+    else
+    {
+      jet->TauTag |= (gRandom->Uniform() <= eff) << fBitNumber;
+    }
     jet->TauWeight = eff;
 
     // set tau charge
@@ -25,6 +25,12 @@
  *  applies b-tagging efficiency (miss identification rate) formulas
  *  and sets b-tagging flags 
  *
+ *  With UseWeights set to true, the tau-tagging flag is set for all jets
+ *  with a non-zero efficiency and the efficiencies are stored in TauWeights
+ *  for BitNumber, followed by the efficiencies of EfficiencyFormula<name>
+ *  for each name of the global WeightVariations.  Flavors missing in a
+ *  variation use the nominal formulas.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -35,6 +41,7 @@
 #include "classes/DelphesModule.h"
 
 #include <map>
+#include <vector>
 
 class TObjArray;
 class DelphesFormula;
@@ -57,8 +64,14 @@ private:
 
   Double_t fDeltaR;
 
+  Bool_t fUseWeights;
+
 #if !defined(__CINT__) && !defined(__CLING__)
   std::map<Int_t, DelphesFormula *> fEfficiencyMap; //!
+
+  std::vector<std::map<Int_t, DelphesFormula *> > fVariationMaps; //!
+
+  std::vector<Double_t> fWeights; //!
 #endif
 
   TauTaggingPartonClassifier *fClassifier = nullptr; //!
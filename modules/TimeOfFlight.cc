@@ -76,6 +76,9 @@ void TimeOfFlight::Init()
   fVertexInputArray = ImportArray(GetString("VertexInputArray", "TruthVertexFinder/vertices"));
   fItVertexInputArray = fVertexInputArray->MakeIterator();
 
+  // vertex of each particle, rebuilt from the vertex constituents every event
+  fVertexIndex = new TObjArray;
+
   // create output array
   fOutputArray = ExportArray(GetString("OutputArray", "tracks"));
 }
@@ -86,6 +89,7 @@ void TimeOfFlight::Finish()
 {
   delete fItInputArray;
   delete fItVertexInputArray;
+  delete fVertexIndex;
 }
 
 //------------------------------------------------------------------------------
@@ -98,6 +102,18 @@ void TimeOfFlight::Process()
 
   const Double_t c_light = 2.99792458E8;
 
+  // a particle attached to several vertices points to the last one
+  fVertexIndex->Clear();
+  fItVertexInputArray->Reset();
+  while((vertex = static_cast<Candidate *>(fItVertexInputArray->Next())))
+  {
+    TIter itGenParts(vertex->GetCandidates());
+    while((constituent = static_cast<Candidate *>(itGenParts.Next())))
+    {
+      fVertexIndex->AddAtAndExpand(vertex, constituent->GetUniqueID());
+    }
+  }
+
   // first compute momenta of vertices based on reconstructed tracks
   ComputeVertexMomenta();
 
@@ -137,21 +153,8 @@ void TimeOfFlight::Process()
     {
       // same as 2 but attempt at estimate beta from vertex mass and momentum
       beta = 1.;
-      fItVertexInputArray->Reset();
-      while((vertex = static_cast<Candidate *>(fItVertexInputArray->Next())))
-      {
-        TIter itGenParts(vertex->GetCandidates());
-        itGenParts.Reset();
-
-        while((constituent = static_cast<Candidate *>(itGenParts.Next())))
-        {
-          if(particle == constituent)
-          {
-            beta = vertex->Momentum.Beta();
-            break;
-          }
-        }
-      } // end vertex  loop
+      vertex = FindVertex(particle);
+      if(vertex) beta = vertex->Momentum.Beta();
 
       // track displacement to be possibily replaced by vertex fitted position
       ti = candidateInitialPositionSmeared.Vect().Mag() * 1.0E-3 / (beta * c_light);
@@ -189,28 +192,30 @@ void TimeOfFlight::Process()
 
 void TimeOfFlight::ComputeVertexMomenta()
 {
-  Candidate *track, *constituent, *particle, *vertex;
+  Candidate *track, *particle, *vertex;
 
-  fItVertexInputArray->Reset();
-  while((vertex = static_cast<Candidate *>(fItVertexInputArray->Next())))
+  // a particle attached to several vertices only adds its track to the vertex
+  // found in the index, the last one, while every vertex used to receive it
+  fItInputArray->Reset();
+  while((track = static_cast<Candidate *>(fItInputArray->Next())))
   {
+    // get gen part that generated track
+    particle = static_cast<Candidate *>(track->GetCandidates()->At(0));
+    vertex = FindVertex(particle);
+    if(vertex)
+    {
+      vertex->Momentum += track->Momentum;
+    }
+  } // end track loop
+}
 
-    TIter itGenParts(vertex->GetCandidates());
-    itGenParts.Reset();
+//------------------------------------------------------------------------------
 
-    while((constituent = static_cast<Candidate *>(itGenParts.Next())))
-    {
-      fItInputArray->Reset();
-      while((track = static_cast<Candidate *>(fItInputArray->Next())))
-      {
-        // get gen part that generated track
-        particle = static_cast<Candidate *>(track->GetCandidates()->At(0));
-        if(particle == constituent)
-        {
-          vertex->Momentum += track->Momentum;
-        }
-
-      } // end track loop
-    } // end vertex consitutent loop
-  } // end vertex  loop
+Candidate *TimeOfFlight::FindVertex(Candidate *particle) const
+{
+  UInt_t id = particle->GetUniqueID();
+
+  if(id >= UInt_t(fVertexIndex->GetEntriesFast())) return 0;
+
+  return static_cast<Candidate *>(fVertexIndex->UncheckedAt(id));
 }
@@ -31,6 +31,7 @@
 
 class TIterator;
 class TObjArray;
+class Candidate;
 
 class TimeOfFlight: public DelphesModule
 {
@@ -44,6 +45,8 @@ public:
   void ComputeVertexMomenta();
 
 private:
+  Candidate *FindVertex(Candidate *particle) const;
+
   Int_t fVertexTimeMode;
 
   TIterator *fItInputArray = nullptr; //!
@@ -52,6 +55,9 @@ private:
   const TObjArray *fInputArray = nullptr; //!
   const TObjArray *fVertexInputArray = nullptr; //!
 
+  // vertex of each particle indexed by UniqueID, private to the module
+  TObjArray *fVertexIndex = nullptr; //!
+
   TObjArray *fOutputArray = nullptr; //!
 
   ClassDef(TimeOfFlight, 1)
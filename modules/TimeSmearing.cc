@@ -26,6 +26,7 @@
 
 #include "modules/TimeSmearing.h"
 
+#include "classes/DelphesCandidateBatch.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
@@ -53,6 +54,7 @@ using namespace std;
 TimeSmearing::TimeSmearing()
 {
   fResolutionFormula = new DelphesFormula;
+  fBatch = new DelphesCandidateBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -60,6 +62,7 @@ TimeSmearing::TimeSmearing()
 TimeSmearing::~TimeSmearing()
 {
   delete fResolutionFormula;
+  delete fBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -92,26 +95,37 @@ void TimeSmearing::Process()
 {
   Candidate *candidate, *mother;
   Double_t tf_smeared, tf;
-  Double_t eta, energy;
   Double_t timeResolution;
+  Int_t i, size;
 
   const Double_t c_light = 2.99792458E8;
 
+  fBatch->Clear();
+
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
   {
+    const TLorentzVector &candidateMomentum = candidate->Momentum;
+
+    fBatch->Add(candidate, 0.0, candidateMomentum.Eta(), 0.0, candidateMomentum.E());
+  }
+
+  // evaluate resolution formula for all candidates at once
+  fBatch->Evaluate(fResolutionFormula, kFALSE);
+  fBatch->DrawGaus(fBatch->GetSize());
+
+  size = fBatch->GetSize();
+  for(i = 0; i < size; ++i)
+  {
+    candidate = fBatch->Candidates[i];
 
     const TLorentzVector &candidateFinalPosition = candidate->Position;
-    const TLorentzVector &candidateMomentum = candidate->Momentum;
 
     tf = candidateFinalPosition.T() * 1.0E-3 / c_light;
 
-    eta = candidateMomentum.Eta();
-    energy = candidateMomentum.E();
-
     // apply smearing formula
-    timeResolution = fResolutionFormula->Eval(0.0, eta, 0.0, energy);
-    tf_smeared = gRandom->Gaus(tf, timeResolution);
+    timeResolution = fBatch->Values[i];
+    tf_smeared = tf + timeResolution * fBatch->Random[i];
 
     mother = candidate;
     candidate = static_cast<Candidate *>(candidate->Clone());
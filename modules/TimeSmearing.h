@@ -32,6 +32,7 @@
 class TIterator;
 class TObjArray;
 class DelphesFormula;
+class DelphesCandidateBatch;
 
 class TimeSmearing: public DelphesModule
 {
@@ -45,6 +46,8 @@ public:
 
 private:
   DelphesFormula *fResolutionFormula = nullptr;
+
+  DelphesCandidateBatch *fBatch = nullptr; //!
   Int_t fVertexTimeMode;
 
   TIterator *fItInputArray = nullptr; //!
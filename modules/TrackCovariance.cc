@@ -38,14 +38,18 @@
 #include "TrackCovariance/ObsTrk.h"
 #include "TrackCovariance/SolGeom.h"
 #include "TrackCovariance/SolGridCov.h"
+#include "classes/DelphesCacheFile.h"
 #include "classes/DelphesFormula.h"
 
 #include "TLorentzVector.h"
 #include "TMath.h"
 #include "TObjArray.h"
 
+#include <cstdio>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <vector>
 
 using namespace std;
 
@@ -55,6 +59,7 @@ TrackCovariance::TrackCovariance()
 {
   fGeometry = new SolGeom();
   fCovariance = new SolGridCov();
+  fCacheFile = new DelphesCacheFile;
   fElectronScaleFactor = new DelphesFormula;
   fMuonScaleFactor = new DelphesFormula;
   fChargedHadronScaleFactor = new DelphesFormula;
@@ -66,6 +71,7 @@ TrackCovariance::~TrackCovariance()
 {
   delete fGeometry;
   delete fCovariance;
+  delete fCacheFile;
   delete fElectronScaleFactor;
   delete fMuonScaleFactor;
   delete fChargedHadronScaleFactor;
@@ -75,6 +81,10 @@ TrackCovariance::~TrackCovariance()
 
 void TrackCovariance::Init()
 {
+  string cacheFileName, cacheKey;
+  vector<Double_t> buffer;
+  char header[64];
+
   fBz = GetDouble("Bz", 0.0);
   fGeometry->Read(GetString("DetectorGeometry", ""));
   fGeometry->SetBz(fBz);
@@ -85,8 +95,28 @@ void TrackCovariance::Init()
   fMuonScaleFactor->Compile(GetString("MuonScaleFactor", "1.0"));
   fChargedHadronScaleFactor->Compile(GetString("ChargedHadronScaleFactor", "1.0"));
 
-  // load geometry
-  fCovariance->Calc(fGeometry);
+  // load covariance grid and acceptance, from the cache file if it was
+  // computed by the same code for the same field and geometry; the file
+  // stays mapped, so that jobs on one node share the covariance grid
+  cacheFileName = GetString("CacheFile", "");
+  snprintf(header, sizeof(header), "TrackCovariance v%d Bz=%.17g", SolGridCov::GetPackVersion(), fBz);
+  cacheKey = string(header) + "\n" + GetString("DetectorGeometry", "");
+
+  if(cacheFileName.empty() || !fCacheFile->Open(cacheFileName.c_str(), cacheKey.c_str())
+    || !fCovariance->Unpack(fCacheFile->GetData(), fCacheFile->GetSize()))
+  {
+    fCacheFile->Close();
+    fCovariance->Calc(fGeometry);
+    if(!cacheFileName.empty())
+    {
+      fCovariance->Pack(buffer);
+      if(!DelphesCacheFile::Write(cacheFileName.c_str(), cacheKey.c_str(), buffer.data(), buffer.size()))
+      {
+        cout << "** WARNING: cannot write cache file '" << cacheFileName << "'" << endl;
+      }
+    }
+  }
+
   fCovariance->SetMinHits(fNMinHits);
   // load geometry
   fAcx = fCovariance->AccPnt();
@@ -133,12 +163,7 @@ void TrackCovariance::Process()
     const TLorentzVector &candidateMomentum = particle->Momentum;
 
     Bool_t inside = TrkUtil::IsInside(candidatePosition.Vect(), Rin, ZinNeg, ZinPos); // Check if in inner box
-    Bool_t Accept = kTRUE;
-    if(inside)
-      Accept = fCovariance->IsAccepted(candidateMomentum.Vect());
-    else
-      Accept = fCovariance->IsAccepted(candidatePosition.Vect(), candidateMomentum.Vect(), fGeometry);
-    if(!Accept) continue;
+    if(inside && !fCovariance->IsAccepted(candidateMomentum.Vect())) continue;
 
     mass = candidateMomentum.M();
 
@@ -154,6 +179,10 @@ void TrackCovariance::Process()
     // uncomment above to return to standard implementation
     //
     ObsTrk track(candidatePosition.Vect(), candidateMomentum.Vect(), candidate->Charge, mass, fGeometry);
+
+    // layer intersections are computed once and reused by the Kalman filter
+    if(!inside && !fCovariance->IsAccepted(track.GetTrack())) continue;
+
     Int_t MinMeasure = 6; // minimum number of measurements required
     if(track.GetUmeas() < MinMeasure) continue;
     //
@@ -172,48 +201,54 @@ void TrackCovariance::Process()
       track.SetScale(fChargedHadronScaleFactor->Eval(candidateMomentum.Pt(), candidateMomentum.Eta(), candidateMomentum.Phi(), candidateMomentum.E(), candidate));
     }
 
+    const TVector3 obsX = track.GetObsX();
+    const TVector3 obsP = track.GetObsP();
+    const TVectorD obsPar = track.GetObsPar();
+    const TMatrixDSym cov = track.GetCov();
+    const TVector3 firstHit = track.GetFirstHit();
+
     mother = candidate;
     candidate = static_cast<Candidate *>(candidate->Clone());
 
-    candidate->Momentum.SetVectM(track.GetObsP(), mass);
+    candidate->Momentum.SetVectM(obsP, mass);
 
     // converting back to mm
-    candidate->InitialPosition.SetXYZT(track.GetObsX().X() * 1e03, track.GetObsX().Y() * 1e03, track.GetObsX().Z() * 1e03, candidatePosition.T() * 1e03);
+    candidate->InitialPosition.SetXYZT(obsX.X() * 1e03, obsX.Y() * 1e03, obsX.Z() * 1e03, candidatePosition.T() * 1e03);
 
     // save full covariance 5x5 matrix internally (D0, phi, Curvature, dz, ctg(theta))
-    candidate->TrackCovariance = track.GetCov();
+    candidate->TrackCovariance = cov;
 
     pt = candidate->Momentum.Pt();
     p = candidate->Momentum.P();
     q = track.GetObsQ();
-    ct = track.GetObsPar()[4];
+    ct = obsPar[4];
 
-    candidate->Xd = track.GetObsX().X() * 1e03;
-    candidate->Yd = track.GetObsX().Y() * 1e03;
-    candidate->Zd = track.GetObsX().Z() * 1e03;
+    candidate->Xd = obsX.X() * 1e03;
+    candidate->Yd = obsX.Y() * 1e03;
+    candidate->Zd = obsX.Z() * 1e03;
 
-    candidate->XFirstHit = track.GetFirstHit().X() * 1e03;
-    candidate->YFirstHit = track.GetFirstHit().Y() * 1e03;
-    candidate->ZFirstHit = track.GetFirstHit().Z() * 1e03;
+    candidate->XFirstHit = firstHit.X() * 1e03;
+    candidate->YFirstHit = firstHit.Y() * 1e03;
+    candidate->ZFirstHit = firstHit.Z() * 1e03;
 
-    candidate->D0 = track.GetObsPar()[0] * 1e03;
-    candidate->Phi = track.GetObsPar()[1];
+    candidate->D0 = obsPar[0] * 1e03;
+    candidate->Phi = obsPar[1];
 
     // inverse of curvature
-    candidate->C = track.GetObsPar()[2] * 1e-03;
-    candidate->DZ = track.GetObsPar()[3] * 1e03;
-    candidate->CtgTheta = track.GetObsPar()[4];
-    candidate->P = track.GetObsP().Mag();
+    candidate->C = obsPar[2] * 1e-03;
+    candidate->DZ = obsPar[3] * 1e03;
+    candidate->CtgTheta = obsPar[4];
+    candidate->P = obsP.Mag();
     candidate->PT = pt;
     candidate->Charge = q;
 
-    dd0 = TMath::Sqrt(track.GetCov()(0, 0)) * 1e03;
-    ddz = TMath::Sqrt(track.GetCov()(3, 3)) * 1e03;
-    dphi = TMath::Sqrt(track.GetCov()(1, 1));
-    dct = TMath::Sqrt(track.GetCov()(4, 4));
-    dpt = 2 * TMath::Sqrt(track.GetCov()(2, 2)) * pt * pt / (0.2998 * fBz);
+    dd0 = TMath::Sqrt(cov(0, 0)) * 1e03;
+    ddz = TMath::Sqrt(cov(3, 3)) * 1e03;
+    dphi = TMath::Sqrt(cov(1, 1));
+    dct = TMath::Sqrt(cov(4, 4));
+    dpt = 2 * TMath::Sqrt(cov(2, 2)) * pt * pt / (0.2998 * fBz);
     dp = TMath::Sqrt((1. + ct * ct) * dpt * dpt + 4 * pt * pt * ct * ct * dct * dct / (1. + ct * ct) / (1. + ct * ct));
-    dC = TMath::Sqrt(track.GetCov()(2, 2)) * 1e-03;
+    dC = TMath::Sqrt(cov(2, 2)) * 1e-03;
 
     candidate->ErrorD0 = dd0;
     candidate->ErrorDZ = ddz;
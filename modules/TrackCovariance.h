@@ -37,6 +37,7 @@ class SolGeom;
 class SolGridCov;
 class AcceptanceClx;
 class DelphesFormula;
+class DelphesCacheFile;
 
 class TrackCovariance: public DelphesModule
 {
@@ -59,6 +60,9 @@ private:
   SolGeom *fGeometry = nullptr;
   SolGridCov *fCovariance = nullptr;
 
+  // mapping of the cache file, the covariance grid is read from it
+  DelphesCacheFile *fCacheFile = nullptr;
+
   AcceptanceClx *fAcx = nullptr;
 
   TIterator *fItInputArray = nullptr; //!
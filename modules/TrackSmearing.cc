@@ -8,9 +8,11 @@
 
 #include "modules/TrackSmearing.h"
 
+#include "classes/DelphesCandidateBatch.h"
 #include "classes/DelphesClasses.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
+#include "classes/DelphesResolutionMap.h"
 
 #include "ExRootAnalysis/ExRootClassifier.h"
 #include "ExRootAnalysis/ExRootFilter.h"
@@ -19,6 +21,7 @@
 #include "TDatabasePDG.h"
 #include "TFile.h"
 #include "TFormula.h"
+#include "TH2.h"
 #include "TLorentzVector.h"
 #include "TMath.h"
 #include "TObjArray.h"
@@ -38,10 +41,16 @@ using namespace std;
 TrackSmearing::TrackSmearing()
 {
   fD0Formula = new DelphesFormula;
+  fD0Map = new DelphesResolutionMap;
   fDZFormula = new DelphesFormula;
+  fDZMap = new DelphesResolutionMap;
   fPFormula = new DelphesFormula;
+  fPMap = new DelphesResolutionMap;
   fCtgThetaFormula = new DelphesFormula;
+  fCtgThetaMap = new DelphesResolutionMap;
   fPhiFormula = new DelphesFormula;
+  fPhiMap = new DelphesResolutionMap;
+  fBatch = new DelphesCandidateBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -49,10 +58,16 @@ TrackSmearing::TrackSmearing()
 TrackSmearing::~TrackSmearing()
 {
   delete fD0Formula;
+  delete fD0Map;
   delete fDZFormula;
+  delete fDZMap;
   delete fPFormula;
+  delete fPMap;
   delete fCtgThetaFormula;
+  delete fCtgThetaMap;
   delete fPhiFormula;
+  delete fPhiMap;
+  delete fBatch;
 }
 
 //------------------------------------------------------------------------------
@@ -67,6 +82,7 @@ void TrackSmearing::Init()
   if(string(GetString("D0ResolutionFormula", "0.0")) != "0.0")
   {
     fD0Formula->Compile(GetString("D0ResolutionFormula", "0.0"));
+    TabulateFormula(fD0Formula, "D0ResolutionMap");
     fUseD0Formula = true;
   }
   else
@@ -74,10 +90,12 @@ void TrackSmearing::Init()
     fD0ResolutionFile = GetString("D0ResolutionFile", "errors.root");
     fD0ResolutionHist = GetString("D0ResolutionHist", "d0");
     fUseD0Formula = false;
+    LoadResolutionMap(fD0Map, fD0ResolutionFile, fD0ResolutionHist);
   }
   if(string(GetString("DZResolutionFormula", "0.0")) != "0.0")
   {
     fDZFormula->Compile(GetString("DZResolutionFormula", "0.0"));
+    TabulateFormula(fDZFormula, "DZResolutionMap");
     fUseDZFormula = true;
   }
   else
@@ -85,10 +103,12 @@ void TrackSmearing::Init()
     fDZResolutionFile = GetString("DZResolutionFile", "errors.root");
     fDZResolutionHist = GetString("DZResolutionHist", "dz");
     fUseDZFormula = false;
+    LoadResolutionMap(fDZMap, fDZResolutionFile, fDZResolutionHist);
   }
   if(string(GetString("PResolutionFormula", "0.0")) != "0.0")
   {
     fPFormula->Compile(GetString("PResolutionFormula", "0.0"));
+    TabulateFormula(fPFormula, "PResolutionMap");
     fUsePFormula = true;
   }
   else
@@ -96,10 +116,12 @@ void TrackSmearing::Init()
     fPResolutionFile = GetString("PResolutionFile", "errors.root");
     fPResolutionHist = GetString("PResolutionHist", "p");
     fUsePFormula = false;
+    LoadResolutionMap(fPMap, fPResolutionFile, fPResolutionHist);
   }
   if(string(GetString("CtgThetaResolutionFormula", "0.0")) != "0.0")
   {
     fCtgThetaFormula->Compile(GetString("CtgThetaResolutionFormula", "0.0"));
+    TabulateFormula(fCtgThetaFormula, "CtgThetaResolutionMap");
     fUseCtgThetaFormula = true;
   }
   else
@@ -107,10 +129,12 @@ void TrackSmearing::Init()
     fCtgThetaResolutionFile = GetString("CtgThetaResolutionFile", "errors.root");
     fCtgThetaResolutionHist = GetString("CtgThetaResolutionHist", "ctgTheta");
     fUseCtgThetaFormula = false;
+    LoadResolutionMap(fCtgThetaMap, fCtgThetaResolutionFile, fCtgThetaResolutionHist);
   }
   if(string(GetString("PhiResolutionFormula", "0.0")) != "0.0")
   {
     fPhiFormula->Compile(GetString("PhiResolutionFormula", "0.0"));
+    TabulateFormula(fPhiFormula, "PhiResolutionMap");
     fUsePhiFormula = true;
   }
   else
@@ -118,6 +142,7 @@ void TrackSmearing::Init()
     fPhiResolutionFile = GetString("PhiResolutionFile", "errors.root");
     fPhiResolutionHist = GetString("PhiResolutionHist", "phi");
     fUsePhiFormula = false;
+    LoadResolutionMap(fPhiMap, fPhiResolutionFile, fPhiResolutionHist);
   }
 
   fApplyToPileUp = GetBool("ApplyToPileUp", true);
@@ -140,6 +165,8 @@ void TrackSmearing::Init()
   // create output array
 
   fOutputArray = ExportArray(GetString("OutputArray", "stableParticles"));
+
+  SetInputReadOnly(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -155,17 +182,13 @@ void TrackSmearing::Process()
 {
   TLorentzVector beamSpotPosition;
   Candidate *candidate, *mother;
-  Double_t pt, eta, e, m, d0, d0Error, trueD0, dz, dzError, trueDZ, p, pError, trueP, ctgTheta, ctgThetaError, trueCtgTheta, phi, phiError, truePhi;
+  Double_t pt, m, d0, d0Error, dz, dzError, p, pError, ctgTheta, ctgThetaError, phi, phiError;
   Double_t x, y, z, t, px, py, pz, theta;
   Double_t q, r;
   Double_t x_c, y_c, r_c, phi_0;
   Double_t rcu, rc2, xd, yd, zd;
   const Double_t c_light = 2.99792458E8;
-  TProfile2D *d0ErrorHist = NULL,
-             *dzErrorHist = NULL,
-             *pErrorHist = NULL,
-             *ctgThetaErrorHist = NULL,
-             *phiErrorHist = NULL;
+  Int_t i, j, size, count;
 
   if(!fBeamSpotInputArray || fBeamSpotInputArray->GetSize() == 0)
     beamSpotPosition.SetXYZT(0.0, 0.0, 0.0, 0.0);
@@ -175,143 +198,73 @@ void TrackSmearing::Process()
     beamSpotPosition = beamSpotCandidate.Position;
   }
 
-  if(!fUseD0Formula)
-  {
-    TFile *fin = TFile::Open(fD0ResolutionFile.c_str());
-    d0ErrorHist = (TProfile2D *)fin->Get(fD0ResolutionHist.c_str());
-    d0ErrorHist->SetDirectory(0);
-    fin->Close();
-  }
-  if(!fUseDZFormula)
-  {
-    TFile *fin = TFile::Open(fDZResolutionFile.c_str());
-    dzErrorHist = (TProfile2D *)fin->Get(fDZResolutionHist.c_str());
-    dzErrorHist->SetDirectory(0);
-    fin->Close();
-  }
-  if(!fUsePFormula)
-  {
-    TFile *fin = TFile::Open(fPResolutionFile.c_str());
-    pErrorHist = (TProfile2D *)fin->Get(fPResolutionHist.c_str());
-    pErrorHist->SetDirectory(0);
-    fin->Close();
-  }
-  if(!fUseCtgThetaFormula)
-  {
-    TFile *fin = TFile::Open(fCtgThetaResolutionFile.c_str());
-    ctgThetaErrorHist = (TProfile2D *)fin->Get(fCtgThetaResolutionHist.c_str());
-    ctgThetaErrorHist->SetDirectory(0);
-    fin->Close();
-  }
-  if(!fUsePhiFormula)
-  {
-    TFile *fin = TFile::Open(fPhiResolutionFile.c_str());
-    phiErrorHist = (TProfile2D *)fin->Get(fPhiResolutionHist.c_str());
-    phiErrorHist->SetDirectory(0);
-    fin->Close();
-  }
+
+  fBatch->Clear();
 
   fItInputArray->Reset();
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
   {
-
     const TLorentzVector &momentum = candidate->Momentum;
-    const TLorentzVector &position = candidate->InitialPosition;
 
-    pt = momentum.Pt();
-    eta = momentum.Eta();
-    e = momentum.E();
-    m = momentum.M();
+    // resolutions are parametrised with the track phi
+    fBatch->Add(candidate, momentum.Pt(), momentum.Eta(), candidate->Phi, momentum.E());
+  }
 
-    d0 = trueD0 = candidate->D0;
-    dz = trueDZ = candidate->DZ;
+  // evaluate all resolutions for the whole batch
+  EvaluateErrors(fUseD0Formula, fD0Formula, fD0Map, fD0Errors);
+  EvaluateErrors(fUseDZFormula, fDZFormula, fDZMap, fDZErrors);
+  EvaluateErrors(fUsePFormula, fPFormula, fPMap, fPErrors);
+  EvaluateErrors(fUseCtgThetaFormula, fCtgThetaFormula, fCtgThetaMap, fCtgThetaErrors);
+  EvaluateErrors(fUsePhiFormula, fPhiFormula, fPhiMap, fPhiErrors);
+
+  // five random numbers per smeared track, drawn in the order d0, dz, p, ctgTheta, phi
+  size = fBatch->GetSize();
+  count = 0;
+  for(i = 0; i < size; ++i)
+  {
+    candidate = fBatch->Candidates[i];
 
-    p = trueP = candidate->P;
-    ctgTheta = trueCtgTheta = candidate->CtgTheta;
-    phi = truePhi = candidate->Phi;
+    fPErrors[i] *= candidate->P;
+    if(!fUsePFormula && !fPErrors[i]) fPErrors[i] = -1.0;
 
-    if(fUseD0Formula)
-      d0Error = fD0Formula->Eval(pt, eta, phi, e, candidate);
-    else
-    {
-      Int_t xbin, ybin;
+    if(fD0Errors[i] < 0.0 || fDZErrors[i] < 0.0 || fPErrors[i] < 0.0 || fCtgThetaErrors[i] < 0.0 || fPhiErrors[i] < 0.0) continue;
 
-      xbin = pt < d0ErrorHist->GetXaxis()->GetXmax() ? d0ErrorHist->GetXaxis()->FindBin(pt) : d0ErrorHist->GetXaxis()->GetBinCenter(d0ErrorHist->GetXaxis()->GetNbins());
-      ybin = d0ErrorHist->GetYaxis()->FindBin(TMath::Abs(eta));
-      d0Error = d0ErrorHist->GetBinContent(xbin, ybin);
-      if(!d0Error)
-        d0Error = -1.0;
-    }
-    if(d0Error < 0.0)
-      continue;
-
-    if(fUseDZFormula)
-      dzError = fDZFormula->Eval(pt, eta, phi, e, candidate);
-    else
-    {
-      Int_t xbin, ybin;
+    if(fApplyToPileUp || !candidate->IsPU) ++count;
+  }
+  fBatch->DrawGaus(5 * count);
 
-      xbin = pt < dzErrorHist->GetXaxis()->GetXmax() ? dzErrorHist->GetXaxis()->FindBin(pt) : dzErrorHist->GetXaxis()->GetBinCenter(dzErrorHist->GetXaxis()->GetNbins());
-      ybin = dzErrorHist->GetYaxis()->FindBin(TMath::Abs(eta));
-      dzError = dzErrorHist->GetBinContent(xbin, ybin);
-      if(!dzError)
-        dzError = -1.0;
-    }
-    if(dzError < 0.0)
-      continue;
+  j = 0;
+  for(i = 0; i < size; ++i)
+  {
+    candidate = fBatch->Candidates[i];
 
-    if(fUsePFormula)
-      pError = fPFormula->Eval(pt, eta, phi, e, candidate) * p;
-    else
-    {
-      Int_t xbin, ybin;
+    d0Error = fD0Errors[i];
+    dzError = fDZErrors[i];
+    pError = fPErrors[i];
+    ctgThetaError = fCtgThetaErrors[i];
+    phiError = fPhiErrors[i];
 
-      xbin = pt < pErrorHist->GetXaxis()->GetXmax() ? pErrorHist->GetXaxis()->FindBin(pt) : pErrorHist->GetXaxis()->GetBinCenter(pErrorHist->GetXaxis()->GetNbins());
-      ybin = pErrorHist->GetYaxis()->FindBin(TMath::Abs(eta));
-      pError = pErrorHist->GetBinContent(xbin, ybin) * p;
-      if(!pError)
-        pError = -1.0;
-    }
-    if(pError < 0.0)
-      continue;
+    if(d0Error < 0.0 || dzError < 0.0 || pError < 0.0 || ctgThetaError < 0.0 || phiError < 0.0) continue;
 
-    if(fUseCtgThetaFormula)
-      ctgThetaError = fCtgThetaFormula->Eval(pt, eta, phi, e, candidate);
-    else
-    {
-      Int_t xbin, ybin;
+    const TLorentzVector &momentum = candidate->Momentum;
+    const TLorentzVector &position = candidate->InitialPosition;
 
-      xbin = pt < ctgThetaErrorHist->GetXaxis()->GetXmax() ? ctgThetaErrorHist->GetXaxis()->FindBin(pt) : ctgThetaErrorHist->GetXaxis()->GetBinCenter(ctgThetaErrorHist->GetXaxis()->GetNbins());
-      ybin = ctgThetaErrorHist->GetYaxis()->FindBin(TMath::Abs(eta));
-      ctgThetaError = ctgThetaErrorHist->GetBinContent(xbin, ybin);
-      if(!ctgThetaError)
-        ctgThetaError = -1.0;
-    }
-    if(ctgThetaError < 0.0)
-      continue;
+    m = momentum.M();
 
-    if(fUsePhiFormula)
-      phiError = fPhiFormula->Eval(pt, eta, phi, e, candidate);
-    else
-    {
-      Int_t xbin, ybin;
+    d0 = candidate->D0;
+    dz = candidate->DZ;
 
-      xbin = pt < phiErrorHist->GetXaxis()->GetXmax() ? phiErrorHist->GetXaxis()->FindBin(pt) : phiErrorHist->GetXaxis()->GetBinCenter(phiErrorHist->GetXaxis()->GetNbins());
-      ybin = phiErrorHist->GetYaxis()->FindBin(TMath::Abs(eta));
-      phiError = phiErrorHist->GetBinContent(xbin, ybin);
-      if(!phiError)
-        phiError = -1.0;
-    }
-    if(phiError < 0.0)
-      continue;
+    p = candidate->P;
+    ctgTheta = candidate->CtgTheta;
+    phi = candidate->Phi;
 
     if(fApplyToPileUp || !candidate->IsPU)
     {
-      d0 = gRandom->Gaus(d0, d0Error);
-      dz = gRandom->Gaus(dz, dzError);
-      p = gRandom->Gaus(p, pError);
-      ctgTheta = gRandom->Gaus(ctgTheta, ctgThetaError);
-      phi = gRandom->Gaus(phi, phiError);
+      d0 += d0Error * fBatch->Random[j++];
+      dz += dzError * fBatch->Random[j++];
+      p += pError * fBatch->Random[j++];
+      ctgTheta += ctgThetaError * fBatch->Random[j++];
+      phi += phiError * fBatch->Random[j++];
     }
 
     if(p < 0.0) continue;
@@ -398,6 +351,52 @@ void TrackSmearing::Process()
   }
 }
 
+void TrackSmearing::LoadResolutionMap(DelphesResolutionMap *map, const string &fileName, const string &histName)
+{
+  stringstream message;
+  TFile *file;
+  TH2 *hist = 0;
+
+  file = TFile::Open(fileName.c_str());
+  if(file) hist = dynamic_cast<TH2 *>(file->Get(histName.c_str()));
+
+  if(!hist)
+  {
+    message << "can't read resolution histogram '" << histName << "' from file '" << fileName;
+    message << "' in module '" << GetName() << "'";
+    throw runtime_error(message.str());
+  }
+
+  map->SetHistogram(hist);
+
+  file->Close();
+  delete file;
+}
+
+//------------------------------------------------------------------------------
+
+void TrackSmearing::EvaluateErrors(Bool_t useFormula, DelphesFormula *formula, DelphesResolutionMap *map, vector<Double_t> &errors)
+{
+  Int_t i, size;
+
+  if(useFormula)
+  {
+    fBatch->Evaluate(formula, errors);
+    return;
+  }
+
+  size = fBatch->GetSize();
+  errors.resize(size);
+  for(i = 0; i < size; ++i)
+  {
+    // empty bins of the resolution histograms reject the track
+    errors[i] = map->GetValue(fBatch->PT[i], TMath::Abs(fBatch->Eta[i]));
+    if(!errors[i]) errors[i] = -1.0;
+  }
+}
+
+//------------------------------------------------------------------------------
+
 Double_t TrackSmearing::ptError(const Double_t p, const Double_t ctgTheta, const Double_t dP, const Double_t dCtgTheta)
 {
   Double_t a, b;
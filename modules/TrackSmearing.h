@@ -13,9 +13,13 @@
 
 #include "classes/DelphesModule.h"
 
+#include <vector>
+
 class TIterator;
 class TObjArray;
 class DelphesFormula;
+class DelphesResolutionMap;
+class DelphesCandidateBatch;
 
 class TrackSmearing: public DelphesModule
 {
@@ -30,35 +34,48 @@ public:
 private:
   Double_t ptError(const Double_t, const Double_t, const Double_t, const Double_t);
 
+  void LoadResolutionMap(DelphesResolutionMap *map, const std::string &fileName, const std::string &histName);
+
+  void EvaluateErrors(Bool_t useFormula, DelphesFormula *formula, DelphesResolutionMap *map, std::vector<Double_t> &errors);
+
   Double_t fBz;
 
   DelphesFormula *fD0Formula = nullptr; //!
   std::string fD0ResolutionFile;
   std::string fD0ResolutionHist;
   Bool_t fUseD0Formula;
+  DelphesResolutionMap *fD0Map = nullptr; //!
 
   DelphesFormula *fDZFormula = nullptr; //!
   std::string fDZResolutionFile;
   std::string fDZResolutionHist;
   Bool_t fUseDZFormula;
+  DelphesResolutionMap *fDZMap = nullptr; //!
 
   DelphesFormula *fPFormula = nullptr; //!
   std::string fPResolutionFile;
   std::string fPResolutionHist;
   Bool_t fUsePFormula;
+  DelphesResolutionMap *fPMap = nullptr; //!
 
   DelphesFormula *fCtgThetaFormula = nullptr; //!
   std::string fCtgThetaResolutionFile;
   std::string fCtgThetaResolutionHist;
   Bool_t fUseCtgThetaFormula;
+  DelphesResolutionMap *fCtgThetaMap = nullptr; //!
 
   DelphesFormula *fPhiFormula = nullptr; //!
   std::string fPhiResolutionFile;
   std::string fPhiResolutionHist;
   Bool_t fUsePhiFormula;
+  DelphesResolutionMap *fPhiMap = nullptr; //!
 
   Bool_t fApplyToPileUp;
 
+  DelphesCandidateBatch *fBatch = nullptr; //!
+
+  std::vector<Double_t> fD0Errors, fDZErrors, fPErrors, fCtgThetaErrors, fPhiErrors; //!
+
   TIterator *fItInputArray = nullptr; //!
 
   const TObjArray *fInputArray = nullptr; //!
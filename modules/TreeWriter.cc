@@ -20,6 +20,10 @@
  *
  *  Fills ROOT tree branches.
  *
+ *  References between objects (Particle, Particles, Constituents) are
+ *  written as TRef and TRefArray, resolved through the unique IDs of the
+ *  candidates, so that existing analysis code can read the output.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -46,7 +50,6 @@
 
 #include <algorithm>
 #include <iostream>
-#include <set>
 #include <sstream>
 #include <stdexcept>
 
@@ -84,7 +87,6 @@ void TreeWriter::Init()
   fClassMap[Weight::Class()] = &TreeWriter::ProcessWeight;
   fClassMap[HectorHit::Class()] = &TreeWriter::ProcessHectorHit;
 
-  TBranchMap::iterator itBranchMap;
   map<TClass *, TProcessMethod>::iterator itClassMap;
 
   // read branch configuration and
@@ -122,7 +124,7 @@ void TreeWriter::Init()
     array = ImportArray(branchInputArray);
     branch = NewBranch(branchName, branchClass);
 
-    fBranchMap.insert(make_pair(branch, make_pair(itClassMap->second, array)));
+    fBranchList.push_back(make_pair(branch, make_pair(itClassMap->second, array)));
   }
 
   param = GetParam("Info");
@@ -149,47 +151,57 @@ void TreeWriter::Finish()
 
 void TreeWriter::FillParticles(Candidate *candidate, TRefArray *array)
 {
-  TIter it1(candidate->GetCandidates());
-  set<Candidate *> s;
-  set<Candidate *>::iterator it3;
-  it1.Reset();
-  s.clear();
+  Candidate *constituent, *particle;
+  TObjArray *constituents, *towerConstituents;
+  Int_t i, j, size, towerSize;
+  vector<Candidate *>::iterator itParticles, itParticlesEnd;
+
+  // the same buffer is reused for all objects of all events
+  fParticles.clear();
   array->Clear();
 
-  while((candidate = static_cast<Candidate *>(it1.Next())))
+  constituents = candidate->GetCandidates();
+  size = constituents->GetEntriesFast();
+  for(i = 0; i < size; ++i)
   {
-    TIter it2(candidate->GetCandidates());
+    constituent = static_cast<Candidate *>(constituents->UncheckedAt(i));
+    towerConstituents = constituent->GetCandidates();
 
     // particle
-    if(candidate->GetCandidates()->GetEntriesFast() == 0)
+    if(towerConstituents->GetEntriesFast() == 0)
     {
-      s.insert(candidate);
+      fParticles.push_back(constituent);
       continue;
     }
 
     // track
-    candidate = static_cast<Candidate *>(candidate->GetCandidates()->At(0));
-    if(candidate->GetCandidates()->GetEntriesFast() == 0)
+    particle = static_cast<Candidate *>(towerConstituents->At(0));
+    if(particle->GetCandidates()->GetEntriesFast() == 0)
     {
-      s.insert(candidate);
+      fParticles.push_back(particle);
       continue;
     }
 
     // tower
-    it2.Reset();
-    while((candidate = static_cast<Candidate *>(it2.Next())))
+    towerSize = towerConstituents->GetEntriesFast();
+    for(j = 0; j < towerSize; ++j)
     {
-      candidate = static_cast<Candidate *>(candidate->GetCandidates()->At(0));
-      if(candidate->GetCandidates()->GetEntriesFast() == 0)
+      particle = static_cast<Candidate *>(towerConstituents->UncheckedAt(j));
+      particle = static_cast<Candidate *>(particle->GetCandidates()->At(0));
+      if(particle->GetCandidates()->GetEntriesFast() == 0)
       {
-        s.insert(candidate);
+        fParticles.push_back(particle);
       }
     }
   }
 
-  for(it3 = s.begin(); it3 != s.end(); ++it3)
+  // remove duplicates keeping the same ordering as std::set<Candidate *>
+  sort(fParticles.begin(), fParticles.end());
+  itParticlesEnd = unique(fParticles.begin(), fParticles.end());
+
+  for(itParticles = fParticles.begin(); itParticles != itParticlesEnd; ++itParticles)
   {
-    array->Add(*it3);
+    array->Add(*itParticles);
   }
 }
 
@@ -197,7 +209,7 @@ void TreeWriter::FillParticles(Candidate *candidate, TRefArray *array)
 
 void TreeWriter::ProcessParticles(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   GenParticle *entry = 0;
   Double_t pt, signPz, cosTheta, eta, rapidity;
@@ -205,9 +217,10 @@ void TreeWriter::ProcessParticles(ExRootTreeBranch *branch, TObjArray *array)
   const Double_t c_light = 2.99792458E8;
 
   // loop over all particles
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
 
@@ -259,28 +272,34 @@ void TreeWriter::ProcessParticles(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessVertices(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
-  Candidate *candidate = 0, *constituent = 0;
+  Int_t iCandidate, nCandidates;
+  Candidate *candidate = 0;
+  const TObjArray *constituents;
+  Int_t iConstituent, nConstituents;
   Vertex *entry = 0;
 
   const Double_t c_light = 2.99792458E8;
 
-  Double_t x, y, z, t, xError, yError, zError, tError, sigma, sumPT2, btvSumPT2, genDeltaZ, genSumPT2;
+  Double_t x, y, z, t, xError, yError, zError, tError, sigma, chi2, sumPT2, btvSumPT2, genDeltaZ, genSumPT2;
   UInt_t index, ndf;
 
-  CompBase *compare = Candidate::fgCompare;
-  Candidate::fgCompare = CompSumPT2<Candidate>::Instance();
-  array->Sort();
-  Candidate::fgCompare = compare;
+  // sort by SumPT2 without replacing the comparison of all candidates,
+  // other modules may be sorting candidates at the same time
+  const CompBase *compare = CompSumPT2<Candidate>::Instance();
+  TObject **objects = array->GetObjectRef();
+  stable_sort(objects, objects + array->GetEntriesFast(),
+    [compare](const TObject *a, const TObject *b) { return compare->Compare(a, b) < 0; });
 
   // loop over all vertices
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
 
     index = candidate->ClusterIndex;
     ndf = candidate->ClusterNDF;
     sigma = candidate->ClusterSigma;
+    chi2 = candidate->ClusterChi2;
     sumPT2 = candidate->SumPT2;
     btvSumPT2 = candidate->BTVSumPT2;
     genDeltaZ = candidate->GenDeltaZ;
@@ -301,6 +320,7 @@ void TreeWriter::ProcessVertices(ExRootTreeBranch *branch, TObjArray *array)
     entry->Index = index;
     entry->NDF = ndf;
     entry->Sigma = sigma;
+    entry->Chi2 = chi2;
     entry->SumPT2 = sumPT2;
     entry->BTVSumPT2 = btvSumPT2;
     entry->GenDeltaZ = genDeltaZ;
@@ -316,12 +336,12 @@ void TreeWriter::ProcessVertices(ExRootTreeBranch *branch, TObjArray *array)
     entry->ErrorZ = zError;
     entry->ErrorT = tError;
 
-    TIter itConstituents(candidate->GetCandidates());
-    itConstituents.Reset();
+    constituents = candidate->GetCandidates();
+    nConstituents = constituents->GetEntriesFast();
     entry->Constituents.Clear();
-    while((constituent = static_cast<Candidate *>(itConstituents.Next())))
+    for(iConstituent = 0; iConstituent < nConstituents; ++iConstituent)
     {
-      entry->Constituents.Add(constituent);
+      entry->Constituents.Add(constituents->UncheckedAt(iConstituent));
     }
   }
 }
@@ -330,7 +350,7 @@ void TreeWriter::ProcessVertices(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessTracks(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   Candidate *particle = 0;
   Track *entry = 0;
@@ -338,9 +358,10 @@ void TreeWriter::ProcessTracks(ExRootTreeBranch *branch, TObjArray *array)
   const Double_t c_light = 2.99792458E8;
 
   // loop over all tracks
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &position = candidate->Position;
 
     cosTheta = TMath::Abs(position.CosTheta());
@@ -438,6 +459,8 @@ void TreeWriter::ProcessTracks(ExRootTreeBranch *branch, TObjArray *array)
     entry->IsPU = candidate->IsPU;
     entry->IsRecoPU = candidate->IsRecoPU;
     entry->HardEnergyFraction = candidate->IsPU ? 0.0 : 1.0;
+
+    entry->EfficiencyWeights = candidate->EfficiencyWeights;
   }
 }
 
@@ -445,16 +468,17 @@ void TreeWriter::ProcessTracks(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessTowers(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   Tower *entry = 0;
   Double_t pt, signPz, cosTheta, eta;
   const Double_t c_light = 2.99792458E8;
 
   // loop over all towers
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
 
@@ -501,16 +525,17 @@ void TreeWriter::ProcessTowers(ExRootTreeBranch *branch, TObjArray *array)
 void TreeWriter::ProcessParticleFlowCandidates(ExRootTreeBranch *branch, TObjArray *array)
 {
 
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   ParticleFlowCandidate *entry = 0;
   Double_t e, pt, signz, cosTheta, eta, p, ctgTheta, phi, m;
   const Double_t c_light = 2.99792458E8;
 
   // loop over all tracks
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &position = candidate->Position;
 
     cosTheta = TMath::Abs(position.CosTheta());
@@ -636,7 +661,7 @@ void TreeWriter::ProcessParticleFlowCandidates(ExRootTreeBranch *branch, TObjArr
 
 void TreeWriter::ProcessPhotons(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   Photon *entry = 0;
   Double_t pt, signPz, cosTheta, eta;
@@ -645,10 +670,10 @@ void TreeWriter::ProcessPhotons(ExRootTreeBranch *branch, TObjArray *array)
   array->Sort();
 
   // loop over all photons
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
-    TIter it1(candidate->GetCandidates());
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
 
@@ -679,6 +704,8 @@ void TreeWriter::ProcessPhotons(ExRootTreeBranch *branch, TObjArray *array)
     // 1: prompt -- 2: non prompt -- 3: fake
     entry->Status = candidate->Status;
 
+    entry->EfficiencyWeights = candidate->EfficiencyWeights;
+
     FillParticles(candidate, &entry->Particles);
   }
 }
@@ -687,7 +714,7 @@ void TreeWriter::ProcessPhotons(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessElectrons(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   Electron *entry = 0;
   Double_t pt, signPz, cosTheta, eta;
@@ -696,9 +723,10 @@ void TreeWriter::ProcessElectrons(ExRootTreeBranch *branch, TObjArray *array)
   array->Sort();
 
   // loop over all electrons
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
 
@@ -733,6 +761,8 @@ void TreeWriter::ProcessElectrons(ExRootTreeBranch *branch, TObjArray *array)
 
     entry->EhadOverEem = 0.0;
 
+    entry->EfficiencyWeights = candidate->EfficiencyWeights;
+
     entry->Particle = candidate->GetCandidates()->At(0);
   }
 }
@@ -741,7 +771,7 @@ void TreeWriter::ProcessElectrons(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessMuons(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   Muon *entry = 0;
   Double_t pt, signPz, cosTheta, eta;
@@ -751,9 +781,10 @@ void TreeWriter::ProcessMuons(ExRootTreeBranch *branch, TObjArray *array)
   array->Sort();
 
   // loop over all muons
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
 
@@ -790,6 +821,8 @@ void TreeWriter::ProcessMuons(ExRootTreeBranch *branch, TObjArray *array)
 
     entry->Charge = candidate->Charge;
 
+    entry->EfficiencyWeights = candidate->EfficiencyWeights;
+
     entry->Particle = candidate->GetCandidates()->At(0);
   }
 }
@@ -798,8 +831,10 @@ void TreeWriter::ProcessMuons(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessJets(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0, *constituent = 0;
+  const TObjArray *constituents;
+  Int_t iConstituent, nConstituents;
   Jet *entry = 0;
   Double_t pt, signPz, cosTheta, eta;
   Double_t ecalEnergy, hcalEnergy;
@@ -809,11 +844,10 @@ void TreeWriter::ProcessJets(ExRootTreeBranch *branch, TObjArray *array)
   array->Sort();
 
   // loop over all jets
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
-    TIter itConstituents(candidate->GetCandidates());
-
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->Position;
 
@@ -850,14 +884,19 @@ void TreeWriter::ProcessJets(ExRootTreeBranch *branch, TObjArray *array)
     entry->TauTag = candidate->TauTag;
     entry->TauWeight = candidate->TauWeight;
 
+    entry->BTagWeights = candidate->BTagWeights;
+    entry->TauWeights = candidate->TauWeights;
+
     entry->Charge = candidate->Charge;
 
-    itConstituents.Reset();
+    constituents = candidate->GetCandidates();
+    nConstituents = constituents->GetEntriesFast();
     entry->Constituents.Clear();
     ecalEnergy = 0.0;
     hcalEnergy = 0.0;
-    while((constituent = static_cast<Candidate *>(itConstituents.Next())))
+    for(iConstituent = 0; iConstituent < nConstituents; ++iConstituent)
     {
+      constituent = static_cast<Candidate *>(constituents->UncheckedAt(iConstituent));
       entry->Constituents.Add(constituent);
       ecalEnergy += constituent->Eem;
       hcalEnergy += constituent->Ehad;
@@ -930,7 +969,7 @@ void TreeWriter::ProcessMissingET(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessCscCluster(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   CscCluster *entry = 0;
   Double_t signPz, cosTheta, eta;
@@ -940,9 +979,10 @@ void TreeWriter::ProcessCscCluster(ExRootTreeBranch *branch, TObjArray *array)
   array->Sort();
 
   // loop over all clusters
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &momentum = candidate->Momentum;
     const TLorentzVector &position = candidate->DecayPosition;
 
@@ -1001,14 +1041,15 @@ void TreeWriter::ProcessScalarHT(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessRho(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   Rho *entry = 0;
 
   // loop over all rho
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &momentum = candidate->Momentum;
 
     entry = static_cast<Rho *>(branch->NewEntry());
@@ -1041,14 +1082,15 @@ void TreeWriter::ProcessWeight(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::ProcessHectorHit(ExRootTreeBranch *branch, TObjArray *array)
 {
-  TIter iterator(array);
+  Int_t iCandidate, nCandidates;
   Candidate *candidate = 0;
   HectorHit *entry = 0;
 
   // loop over all roman pot hits
-  iterator.Reset();
-  while((candidate = static_cast<Candidate *>(iterator.Next())))
+  nCandidates = array->GetEntriesFast();
+  for(iCandidate = 0; iCandidate < nCandidates; ++iCandidate)
   {
+    candidate = static_cast<Candidate *>(array->UncheckedAt(iCandidate));
     const TLorentzVector &position = candidate->Position;
     const TLorentzVector &momentum = candidate->Momentum;
 
@@ -1073,16 +1115,16 @@ void TreeWriter::ProcessHectorHit(ExRootTreeBranch *branch, TObjArray *array)
 
 void TreeWriter::Process()
 {
-  TBranchMap::iterator itBranchMap;
+  TBranchList::iterator itBranchList;
   ExRootTreeBranch *branch;
   TProcessMethod method;
   TObjArray *array;
 
-  for(itBranchMap = fBranchMap.begin(); itBranchMap != fBranchMap.end(); ++itBranchMap)
+  for(itBranchList = fBranchList.begin(); itBranchList != fBranchList.end(); ++itBranchList)
   {
-    branch = itBranchMap->first;
-    method = itBranchMap->second.first;
-    array = itBranchMap->second.second;
+    branch = itBranchList->first;
+    method = itBranchList->second.first;
+    array = itBranchList->second.second;
 
     (this->*method)(branch, array);
   }
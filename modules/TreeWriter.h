@@ -23,6 +23,10 @@
  *
  *  Fills ROOT tree branches.
  *
+ *  References between objects (Particle, Particles, Constituents) are
+ *  written as TRef and TRefArray, resolved through the unique IDs of the
+ *  candidates, so that existing analysis code can read the output.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -30,6 +34,7 @@
 #include "classes/DelphesModule.h"
 
 #include <map>
+#include <vector>
 
 class TClass;
 class TObjArray;
@@ -71,13 +76,15 @@ private:
 #if !defined(__CINT__) && !defined(__CLING__)
   typedef void (TreeWriter::*TProcessMethod)(ExRootTreeBranch *, TObjArray *); //!
 
-  typedef std::map<ExRootTreeBranch *, std::pair<TProcessMethod, TObjArray *> > TBranchMap; //!
+  typedef std::vector<std::pair<ExRootTreeBranch *, std::pair<TProcessMethod, TObjArray *> > > TBranchList; //!
 
-  TBranchMap fBranchMap; //!
+  TBranchList fBranchList; //!
 
   std::map<TClass *, TProcessMethod> fClassMap; //!
 #endif
 
+  std::vector<Candidate *> fParticles; //!
+
   ClassDef(TreeWriter, 2)
 };
 
@@ -47,6 +47,8 @@
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
@@ -66,15 +68,24 @@ TruthVertexFinder::~TruthVertexFinder()
 
 void TruthVertexFinder::Init()
 {
+  stringstream message;
 
   fResolution = GetDouble("Resolution", 1E-06); // resolution in meters
+  if(!(fResolution > 0.0))
+  {
+    message << "Resolution should be positive in module '" << GetName() << "'";
+    throw runtime_error(message.str());
+  }
+
+  // compare the binned lookup with a comparison against all vertices
+  fCheckLookup = GetBool("CheckLookup", false);
+
   // import input array
   fInputArray = ImportArray(GetString("InputArray", "Delphes/stableParticles"));
   fItInputArray = fInputArray->MakeIterator();
 
   // create output arrays
   fVertexOutputArray = ExportArray(GetString("VertexOutputArray", "vertices"));
-  //fItOutputArray = fVertexOutputArray->MakeIterator();
 }
 
 //------------------------------------------------------------------------------
@@ -82,7 +93,6 @@ void TruthVertexFinder::Init()
 void TruthVertexFinder::Finish()
 {
   delete fItInputArray;
-  delete fItOutputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -91,15 +101,21 @@ void TruthVertexFinder::Process()
 {
   Int_t nvtx = -1;
   Float_t pt;
+  Long64_t cell, neighbour;
+  Double_t tolerance, distance;
   Candidate *candidate, *vertex;
   DelphesFactory *factory;
-
-  fItInputArray->Reset();
+  unordered_map<Long64_t, vector<Candidate *> >::iterator itCell;
+  vector<Candidate *>::iterator itVertex;
 
   factory = GetFactory();
-  vertex = factory->NewCandidate();
 
-  TLorentzVector vertexPosition(0., 0., 0., 0.);
+  // vertices are binned in their distance from the origin,
+  // candidates only need to be compared with vertices in the neighbouring bins
+  tolerance = fResolution * 1.E3;
+  fVertexCells.clear();
+
+  fItInputArray->Reset();
 
   nvtx = 0;
   while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
@@ -109,29 +125,44 @@ void TruthVertexFinder::Process()
     const TLorentzVector &candidateMomentum = candidate->Momentum;
 
     pt = candidateMomentum.Pt();
+    distance = candidatePosition.P();
+    cell = Long64_t(TMath::Floor(distance / tolerance));
 
-    // check whether vertex already included, if so add particle
-    Bool_t old_vertex = false;
-    fItOutputArray = fVertexOutputArray->MakeIterator();
-    fItOutputArray->Reset();
-    while((vertex = static_cast<Candidate *>(fItOutputArray->Next())))
+    // check whether vertex already included
+    fMatches.clear();
+    for(neighbour = cell - 1; neighbour <= cell + 1; ++neighbour)
     {
-      const TLorentzVector &vertexPosition = vertex->Position;
-      // check whether spatial difference is < 1 um, in that case assume it is the same vertex
-      if(TMath::Abs((candidatePosition.P() - vertexPosition.P())) < fResolution * 1.E3)
+      itCell = fVertexCells.find(neighbour);
+      if(itCell == fVertexCells.end()) continue;
+
+      for(itVertex = itCell->second.begin(); itVertex != itCell->second.end(); ++itVertex)
       {
-        old_vertex = true;
-        vertex->AddCandidate(candidate);
-        if(TMath::Abs(candidate->Charge) > 0)
+        vertex = *itVertex;
+        const TLorentzVector &vertexPosition = vertex->Position;
+        // check whether spatial difference is < 1 um, in that case assume it is the same vertex
+        if(TMath::Abs((distance - vertexPosition.P())) < tolerance)
         {
-          vertex->ClusterNDF += 1;
-          vertex->GenSumPT2 += pt * pt;
+          fMatches.push_back(vertex);
         }
       }
     }
 
+    if(fCheckLookup) CheckMatches(candidate);
+
+    // if so add particle
+    for(itVertex = fMatches.begin(); itVertex != fMatches.end(); ++itVertex)
+    {
+      vertex = *itVertex;
+      vertex->AddCandidate(candidate);
+      if(TMath::Abs(candidate->Charge) > 0)
+      {
+        vertex->ClusterNDF += 1;
+        vertex->GenSumPT2 += pt * pt;
+      }
+    }
+
     // else fill new vertex
-    if(!old_vertex)
+    if(fMatches.empty())
     {
       vertex = factory->NewCandidate();
       vertex->Position = candidatePosition;
@@ -148,9 +179,44 @@ void TruthVertexFinder::Process()
         vertex->GenSumPT2 = 0.;
       }
       fVertexOutputArray->Add(vertex);
+      fVertexCells[cell].push_back(vertex);
       nvtx++;
     }
   }
 }
 
 //------------------------------------------------------------------------------
+
+void TruthVertexFinder::CheckMatches(Candidate *candidate)
+{
+  stringstream message;
+  Double_t tolerance, distance;
+  Candidate *vertex;
+  vector<Candidate *> matches;
+  Int_t i;
+
+  tolerance = fResolution * 1.E3;
+  distance = candidate->Position.P();
+
+  // same selection as before the binning
+  for(i = 0; i < fVertexOutputArray->GetEntriesFast(); ++i)
+  {
+    vertex = static_cast<Candidate *>(fVertexOutputArray->UncheckedAt(i));
+    if(TMath::Abs((distance - vertex->Position.P())) < tolerance) matches.push_back(vertex);
+  }
+
+  // only the selected vertices matter, not their order
+  vector<Candidate *> binned(fMatches);
+  sort(binned.begin(), binned.end());
+  sort(matches.begin(), matches.end());
+
+  if(binned != matches)
+  {
+    message << "binned vertex lookup found " << binned.size() << " instead of " << matches.size();
+    message << " vertices in module '" << GetName() << "'";
+    throw runtime_error(message.str());
+  }
+}
+
+//------------------------------------------------------------------------------
+
@@ -29,7 +29,11 @@
 
 #include "classes/DelphesModule.h"
 
+#include <unordered_map>
+#include <vector>
+
 class TObjArray;
+class Candidate;
 
 class TruthVertexFinder: public DelphesModule
 {
@@ -42,14 +46,24 @@ public:
   void Finish();
 
 private:
+  void CheckMatches(Candidate *candidate);
+
   Double_t fResolution; //!
 
+  Bool_t fCheckLookup; //!
+
   TIterator *fItInputArray = nullptr; //!
-  TIterator *fItOutputArray = nullptr; //!
 
   const TObjArray *fInputArray = nullptr; //!
 
   TObjArray *fVertexOutputArray = nullptr; //!
+
+  // vertices binned in distance from the origin, in units of the resolution
+  std::unordered_map<Long64_t, std::vector<Candidate *> > fVertexCells; //!
+
+  // vertices matched by the current candidate
+  std::vector<Candidate *> fMatches; //!
+
   ClassDef(TruthVertexFinder, 1)
 };
 
@@ -20,6 +20,10 @@
  *
  *  Finds uniquely identified photons, electrons and jets.
  *
+ *  The generator particles of the objects accepted from the previous
+ *  input arrays are flagged in a per-event mask indexed by unique ID,
+ *  so that each candidate is checked in a single pass over its leaves.
+ *
  *  \author P. Demin - UCL, Louvain-la-Neuve
  *
  */
@@ -85,6 +89,8 @@ void UniqueObjectFinder::Init()
 
     fInputMap.push_back(make_pair(iterator, ExportArray(param[i * 2 + 1].GetString())));
   }
+
+  SetInputReadOnly(kTRUE);
 }
 
 //------------------------------------------------------------------------------
@@ -108,8 +114,10 @@ void UniqueObjectFinder::Process()
 {
   Candidate *candidate;
   vector<pair<TIterator *, TObjArray *> >::iterator itInputMap;
+  vector<UInt_t>::iterator itReservedIDs;
   TIterator *iterator;
   TObjArray *array;
+  Int_t i, size;
 
   // loop over all input arrays
   for(itInputMap = fInputMap.begin(); itInputMap != fInputMap.end(); ++itInputMap)
@@ -121,50 +129,77 @@ void UniqueObjectFinder::Process()
     iterator->Reset();
     while((candidate = static_cast<Candidate *>(iterator->Next())))
     {
-      if(Unique(candidate, itInputMap))
+      if(Unique(candidate))
       {
         array->Add(candidate);
       }
     }
+
+    // objects of this array take precedence over objects of the next arrays
+    size = array->GetEntriesFast();
+    for(i = 0; i < size; ++i)
+    {
+      Reserve(static_cast<Candidate *>(array->UncheckedAt(i)));
+    }
+  }
+
+  // reset only the entries used in this event
+  for(itReservedIDs = fReservedIDs.begin(); itReservedIDs != fReservedIDs.end(); ++itReservedIDs)
+  {
+    fReserved[*itReservedIDs] = 0;
   }
+  fReservedIDs.clear();
 }
 
 //------------------------------------------------------------------------------
 
-Bool_t UniqueObjectFinder::Unique(Candidate *candidate, vector<pair<TIterator *, TObjArray *> >::iterator itInputMap)
+Bool_t UniqueObjectFinder::Unique(Candidate *candidate)
 {
-  Candidate *previousCandidate;
-  vector<pair<TIterator *, TObjArray *> >::iterator previousItInputMap;
-  TObjArray *array;
+  vector<UInt_t>::const_iterator itLeafIDs;
+  UInt_t id, size = fReserved.size();
 
-  // loop over previous arrays
-  for(previousItInputMap = fInputMap.begin(); previousItInputMap != itInputMap; ++previousItInputMap)
+  if(fUseUniqueID)
   {
-    array = previousItInputMap->second;
-    TIter iterator(array);
+    id = candidate->GetUniqueID();
+    return id >= size || !fReserved[id];
+  }
 
-    // loop over all candidates
-    iterator.Reset();
-    while((previousCandidate = static_cast<Candidate *>(iterator.Next())))
-    {
-      if(fUseUniqueID)
-      {
-        if(candidate->GetUniqueID() == previousCandidate->GetUniqueID())
-        {
-          return kFALSE;
-        }
-      }
-      else
-      {
-        if(candidate->Overlaps(previousCandidate))
-        {
-          return kFALSE;
-        }
-      }
-    }
+  // a candidate is not unique if it shares a generator particle
+  // with one of the objects accepted from the previous arrays
+  const vector<UInt_t> &ids = candidate->GetLeafIDs();
+  for(itLeafIDs = ids.begin(); itLeafIDs != ids.end(); ++itLeafIDs)
+  {
+    id = *itLeafIDs;
+    if(id < size && fReserved[id]) return kFALSE;
   }
 
   return kTRUE;
 }
 
 //------------------------------------------------------------------------------
+
+void UniqueObjectFinder::Reserve(Candidate *candidate)
+{
+  vector<UInt_t>::const_iterator itLeafIDs;
+  UInt_t id;
+
+  if(fUseUniqueID)
+  {
+    id = candidate->GetUniqueID();
+    if(id >= fReserved.size()) fReserved.resize(id + 1, 0);
+    if(!fReserved[id]) fReservedIDs.push_back(id);
+    fReserved[id] = 1;
+    return;
+  }
+
+  const vector<UInt_t> &ids = candidate->GetLeafIDs();
+  for(itLeafIDs = ids.begin(); itLeafIDs != ids.end(); ++itLeafIDs)
+  {
+    id = *itLeafIDs;
+    if(id >= fReserved.size()) fReserved.resize(id + 1, 0);
+    if(!fReserved[id]) fReservedIDs.push_back(id);
+    fReserved[id] = 1;
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -49,10 +49,15 @@ public:
 private:
   Bool_t fUseUniqueID;
 
-  Bool_t Unique(Candidate *candidate, std::vector<std::pair<TIterator *, TObjArray *> >::iterator itInputMap);
+  Bool_t Unique(Candidate *candidate);
+  void Reserve(Candidate *candidate);
 
   std::vector<std::pair<TIterator *, TObjArray *> > fInputMap; //!
 
+  // IDs of the objects accepted from the previous input arrays
+  std::vector<UChar_t> fReserved; //!
+  std::vector<UInt_t> fReservedIDs; //!
+
   ClassDef(UniqueObjectFinder, 1)
 };
 
@@ -28,6 +28,7 @@
 #include "modules/UnstablePropagator.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesDecayGraph.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesFormula.h"
 
@@ -89,14 +90,12 @@ void UnstablePropagator::Init()
   // import array with output from filter/classifier module
 
   fInputArray = ImportArray(GetString("InputArray", "Delphes/allParticles"));
-  fItInputArray = fInputArray->MakeIterator();
 }
 
 //------------------------------------------------------------------------------
 
 void UnstablePropagator::Finish()
 {
-  delete fItInputArray;
 }
 
 //------------------------------------------------------------------------------
@@ -107,13 +106,16 @@ void UnstablePropagator::Process()
   TLorentzVector particlePosition, particleMomentum;
   Double_t pt2, q;
   Double_t lof, x, y, z;
+  Int_t i;
 
-  fItInputArray->Reset();
+  fDecayGraph = GetFactory()->GetDecayGraph(fInputArray);
 
   if(fDebug) cout << "-------------   new event -----------------" << endl;
 
-  while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
+  for(i = 0; i < fInputArray->GetEntriesFast(); ++i)
   {
+    candidate = static_cast<Candidate *>(fInputArray->At(i));
+
     particlePosition = candidate->Position;
     particleMomentum = candidate->Momentum;
 
@@ -147,14 +149,12 @@ void UnstablePropagator::Process()
       continue;
     }
 
-    std::vector<Int_t> daughters_indices = DaughterIndices(candidate);
-
-    if(daughters_indices.size() == 0)
+    if(fDecayGraph->GetNDaughters(i) == 0)
     {
       continue;
     }
 
-    daughter = static_cast<Candidate *>(fInputArray->At(daughters_indices.at(0)));
+    daughter = static_cast<Candidate *>(fInputArray->At(fDecayGraph->GetDaughters(i)[0]));
     lof = FlightDistance(candidate, daughter) * 1.0E-3;
 
     //fLmin = 0.01;
@@ -165,49 +165,13 @@ void UnstablePropagator::Process()
 
     if(fDebug) std::cout << " -- lof: " << lof << ", Lmin: " << fLmin << std::scientific << std::endl;
     TString prefix = " -- ";
-    ComputeChainFlightDistances(prefix, candidate);
-    PropagateAndUpdateChain(prefix, candidate);
+    ComputeChainFlightDistances(prefix, i);
+    PropagateAndUpdateChain(prefix, i);
   }
 }
 
 //------------------------------------------------------------------------------
 
-std::vector<Int_t> UnstablePropagator::DaughterIndices(Candidate *candidate)
-{
-
-  std::vector<Int_t> indices;
-
-  Int_t d1 = candidate->D1;
-  Int_t d2 = candidate->D2;
-
-  Int_t maxd = max(d1, d2);
-  Int_t mind = min(d1, d2);
-
-  if(maxd < 0)
-  {
-    indices.clear();
-  }
-  else if(mind < 0)
-  {
-    indices.push_back(maxd);
-  }
-  else if(d1 > d2)
-  {
-    indices.push_back(d1);
-    indices.push_back(d2);
-  }
-  else
-  {
-    for(Int_t i = d1; i <= d2; ++i)
-    {
-      indices.push_back(i);
-    }
-  }
-  return indices;
-}
-
-//------------------------------------------------------------------------------
-
 // returns flight distance in mm
 Double_t UnstablePropagator::FlightDistance(Candidate *mother, Candidate *daughter)
 {
@@ -217,66 +181,67 @@ Double_t UnstablePropagator::FlightDistance(Candidate *mother, Candidate *daught
 
 //------------------------------------------------------------------------------
 
-void UnstablePropagator::ComputeChainFlightDistances(TString prefix, Candidate *candidate)
+void UnstablePropagator::ComputeChainFlightDistances(TString prefix, Int_t index)
 {
 
   Candidate *daughter, *mother;
-  mother = candidate;
-  std::vector<Int_t> drange = DaughterIndices(mother);
+  mother = static_cast<Candidate *>(fInputArray->At(index));
+  const Int_t *daughters = fDecayGraph->GetDaughters(index);
+  Int_t size = fDecayGraph->GetNDaughters(index);
 
   if(fDebug) cout << prefix << " computing chain flight distances" << endl;
   if(fDebug) PrintPart(prefix, mother);
   prefix += " -- ";
   // check if particle already processed or if stable
-  if(mother->L > 1.0E-9 || drange.size() == 0)
-  //if (drange.size() == 0)
+  if(mother->L > 1.0E-9 || size == 0)
+  //if (size == 0)
   {
     return;
   }
   else
   {
-    daughter = static_cast<Candidate *>(fInputArray->At(drange.at(0)));
+    daughter = static_cast<Candidate *>(fInputArray->At(daughters[0]));
     mother->L = FlightDistance(mother, daughter);
     if(fDebug) cout << prefix << " flight distance: " << mother->L << endl;
-    for(unsigned long i = 0; i < drange.size(); i++)
+    for(Int_t i = 0; i < size; i++)
     {
-      daughter = static_cast<Candidate *>(fInputArray->At(drange.at(i)));
-      ComputeChainFlightDistances(prefix, daughter);
+      ComputeChainFlightDistances(prefix, daughters[i]);
     }
   }
 }
 
 //------------------------------------------------------------------------------
 
-void UnstablePropagator::PropagateAndUpdateChain(TString prefix, Candidate *candidate)
+void UnstablePropagator::PropagateAndUpdateChain(TString prefix, Int_t index)
 {
   Candidate *daughter, *mother;
   TLorentzVector updatedPosition;
-  mother = candidate;
-  std::vector<Int_t> drange = DaughterIndices(mother);
+  mother = static_cast<Candidate *>(fInputArray->At(index));
+  const Int_t *daughters = fDecayGraph->GetDaughters(index);
+  Int_t size = fDecayGraph->GetNDaughters(index);
 
   //if (fDebug) cout<<prefix<<" propagating and updating chain, mother:"<<endl;
   if(fDebug) PrintPart(prefix, mother);
-  //if (fDebug) cout<<mother->L<<","<<drange.size()<<endl;
+  //if (fDebug) cout<<mother->L<<","<<size<<endl;
 
   prefix += " --";
 
   // check if particle stable
-  if(drange.size() == 0)
+  if(size == 0)
   {
     return;
   }
   else
   {
     updatedPosition = PropagatedPosition(mother);
-    for(unsigned long i = 0; i < drange.size(); i++)
+    for(Int_t i = 0; i < size; i++)
     {
-      daughter = static_cast<Candidate *>(fInputArray->At(drange.at(i)));
+      daughter = static_cast<Candidate *>(fInputArray->At(daughters[i]));
       //  if (fDebug) cout<<prefix<<" propagating and updating chain, daughter:"<<endl;
       if(fDebug) PrintPart(prefix, daughter);
       daughter->Position = updatedPosition;
       //if (fDebug) cout<<prefix<<" propagated position: "<<daughter->Position.X()<<", "<<daughter->Position.Y()<<", "<<daughter->Position.Z()<<endl;
-      PropagateAndUpdateChain(prefix, daughter);
+      PropagateAndUpdateChain(prefix, daughters[i]);
     }
   }
 }
@@ -409,25 +374,5 @@ void UnstablePropagator::PrintPart(TString prefix, Candidate *candidate)
 
 Int_t UnstablePropagator::Index(Candidate *particle)
 {
-  /*Int_t i=-1;
-  fItInputArray->Reset();
-  while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
-  {
-    i++;
-    if(candidate->GetUniqueID() == particle->GetUniqueID())
-    {
-      break;
-    }
-  }
-  */
-  Int_t j = -1;
-  for(Int_t i = 0; i < fInputArray->GetEntriesFast(); i++)
-  {
-    j = i;
-    if(fInputArray->At(i)->GetUniqueID() == particle->GetUniqueID())
-    {
-      break;
-    }
-  }
-  return j;
+  return fDecayGraph->GetIndex(particle);
 }
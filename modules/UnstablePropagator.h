@@ -34,6 +34,7 @@ class TClonesArray;
 class TIterator;
 class TLorentzVector;
 class Candidate;
+class DelphesDecayGraph;
 
 class UnstablePropagator: public DelphesModule
 {
@@ -51,16 +52,15 @@ private:
   Double_t fLmin; // minimum
 
   Bool_t fDebug;
-  TIterator *fItInputArray = nullptr; //!
-
   const TObjArray *fInputArray = nullptr; //!
 
-  std::vector<Int_t> DaughterIndices(Candidate *candidate);
+  const DelphesDecayGraph *fDecayGraph = nullptr; //!
+
   void PrintPart(TString prefix, Candidate *candidate);
   Double_t FlightDistance(Candidate *mother, Candidate *daughter);
   Int_t Index(Candidate *candidate);
-  void ComputeChainFlightDistances(TString prefix, Candidate *candidate);
-  void PropagateAndUpdateChain(TString prefix, Candidate *candidate);
+  void ComputeChainFlightDistances(TString prefix, Int_t index);
+  void PropagateAndUpdateChain(TString prefix, Int_t index);
   TLorentzVector PropagatedPosition(Candidate *candidate);
 
   ClassDef(UnstablePropagator, 1)
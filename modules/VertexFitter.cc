@@ -0,0 +1,289 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** \class VertexFitter
+ *
+ *  Fits the primary vertex and two-track secondary vertices
+ *  from tracks with full covariance matrix (see TrackCovariance).
+ *
+ *  The primary vertex is fitted from tracks compatible with the beam line,
+ *  removing the worst track until all tracks have a chi2 contribution below
+ *  PrimaryMaxTrackChi2.  Secondary vertices are fitted from all pairs of
+ *  displaced tracks with opposite charges (K0s, Lambda, conversions).
+ *
+ */
+
+#include "modules/VertexFitter.h"
+
+#include "classes/DelphesClasses.h"
+#include "classes/DelphesFactory.h"
+#include "classes/DelphesVertexFit.h"
+
+#include "TLorentzVector.h"
+#include "TMath.h"
+#include "TObjArray.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+
+VertexFitter::VertexFitter()
+{
+  fFit = new DelphesVertexFit;
+}
+
+//------------------------------------------------------------------------------
+
+VertexFitter::~VertexFitter()
+{
+  delete fFit;
+}
+
+//------------------------------------------------------------------------------
+
+void VertexFitter::Init()
+{
+  fMinPT = GetDouble("MinPT", 0.0);
+
+  // tracks used for the primary vertex
+  fPrimaryMaxD0Significance = GetDouble("PrimaryMaxD0Significance", 3.0);
+  fPrimaryMaxTrackChi2 = GetDouble("PrimaryMaxTrackChi2", 9.0);
+  fPrimaryMinTracks = GetInt("PrimaryMinTracks", 2);
+
+  // beam spot size in mm
+  fBeamSpotConstraint = GetBool("BeamSpotConstraint", false);
+  fBeamSpotSigmaX = GetDouble("BeamSpotSigmaX", 0.01);
+  fBeamSpotSigmaY = GetDouble("BeamSpotSigmaY", 0.01);
+  fBeamSpotSigmaZ = GetDouble("BeamSpotSigmaZ", 50.0);
+
+  // two-track secondary vertices
+  fSecondaryMinD0Significance = GetDouble("SecondaryMinD0Significance", 3.0);
+  fSecondaryMaxChi2 = GetDouble("SecondaryMaxChi2", 10.0);
+  fSecondaryMinDistanceSignificance = GetDouble("SecondaryMinDistanceSignificance", 3.0);
+
+  if(fPrimaryMinTracks < 1 || (fPrimaryMinTracks < 2 && !fBeamSpotConstraint))
+  {
+    throw runtime_error("PrimaryMinTracks must be at least 2 without beam spot constraint");
+  }
+
+  if(fBeamSpotConstraint)
+  {
+    Double_t x[3] = {0.0, 0.0, 0.0};
+    Double_t cov[9] = {0.0};
+    cov[0] = fBeamSpotSigmaX * fBeamSpotSigmaX;
+    cov[4] = fBeamSpotSigmaY * fBeamSpotSigmaY;
+    cov[8] = fBeamSpotSigmaZ * fBeamSpotSigmaZ;
+    fFit->SetConstraint(x, cov);
+  }
+
+  // import input array
+  fInputArray = ImportArray(GetString("InputArray", "TrackCovariance/tracks"));
+  fItInputArray = fInputArray->MakeIterator();
+
+  // create output arrays
+  fVertexOutputArray = ExportArray(GetString("VertexOutputArray", "vertices"));
+  fSecondaryVertexOutputArray = ExportArray(GetString("SecondaryVertexOutputArray", "secondaryVertices"));
+}
+
+//------------------------------------------------------------------------------
+
+void VertexFitter::Finish()
+{
+  if(fItInputArray) delete fItInputArray;
+}
+
+//------------------------------------------------------------------------------
+
+void VertexFitter::Process()
+{
+  Candidate *candidate;
+  Double_t d0Significance;
+
+  fPrimaryTracks.clear();
+  fDisplacedTracks.clear();
+
+  fItInputArray->Reset();
+  while((candidate = static_cast<Candidate *>(fItInputArray->Next())))
+  {
+    if(candidate->Charge == 0 || candidate->Momentum.Pt() < fMinPT || candidate->ErrorD0 <= 0.0) continue;
+
+    d0Significance = TMath::Abs(candidate->D0) / candidate->ErrorD0;
+
+    if(d0Significance < fPrimaryMaxD0Significance) fPrimaryTracks.push_back(candidate);
+    if(d0Significance > fSecondaryMinD0Significance) fDisplacedTracks.push_back(candidate);
+  }
+
+  FitPrimary();
+  FitSecondary();
+}
+
+//------------------------------------------------------------------------------
+
+Candidate *VertexFitter::NewVertex(Int_t index)
+{
+  Candidate *vertex = GetFactory()->NewCandidate();
+
+  vertex->Position.SetXYZT(fFit->GetX(0), fFit->GetX(1), fFit->GetX(2), 0.0);
+  vertex->PositionError.SetXYZT(TMath::Sqrt(fFit->GetCov(0, 0)), TMath::Sqrt(fFit->GetCov(1, 1)), TMath::Sqrt(fFit->GetCov(2, 2)), 0.0);
+
+  vertex->ClusterIndex = index;
+  vertex->ClusterNDF = fFit->GetNDF();
+  vertex->ClusterChi2 = fFit->GetChi2();
+
+  return vertex;
+}
+
+//------------------------------------------------------------------------------
+
+void VertexFitter::FitPrimary()
+{
+  Int_t i, worst, nTracks;
+  Double_t chi2, worstChi2, pt;
+  Candidate *vertex;
+  vector<Candidate *>::iterator itTrack;
+
+  // without primary vertex, secondary vertices are compared to the beam line
+  fPrimaryX = fPrimaryY = 0.0;
+  fPrimaryCov[0][0] = fBeamSpotConstraint ? fBeamSpotSigmaX * fBeamSpotSigmaX : 0.0;
+  fPrimaryCov[1][1] = fBeamSpotConstraint ? fBeamSpotSigmaY * fBeamSpotSigmaY : 0.0;
+  fPrimaryCov[0][1] = fPrimaryCov[1][0] = 0.0;
+
+  if(Int_t(fPrimaryTracks.size()) < fPrimaryMinTracks) return;
+
+  fFit->Clear();
+  fFit->EnableConstraint(fBeamSpotConstraint);
+  for(itTrack = fPrimaryTracks.begin(); itTrack != fPrimaryTracks.end(); ++itTrack)
+  {
+    fFit->AddTrack(*itTrack);
+  }
+
+  while(fFit->Fit())
+  {
+    // remove the track with the largest chi2 contribution and refit
+    nTracks = fFit->GetNTracks();
+    worst = -1;
+    worstChi2 = fPrimaryMaxTrackChi2;
+    for(i = 0; i < nTracks; ++i)
+    {
+      chi2 = fFit->GetTrackChi2(i);
+      if(chi2 > worstChi2)
+      {
+        worst = i;
+        worstChi2 = chi2;
+      }
+    }
+
+    if(worst < 0)
+    {
+      vertex = NewVertex(0);
+
+      for(itTrack = fPrimaryTracks.begin(); itTrack != fPrimaryTracks.end(); ++itTrack)
+      {
+        pt = (*itTrack)->Momentum.Pt();
+        vertex->SumPT2 += pt * pt;
+        vertex->AddCandidate(*itTrack);
+      }
+
+      fVertexOutputArray->Add(vertex);
+
+      fPrimaryX = fFit->GetX(0);
+      fPrimaryY = fFit->GetX(1);
+      fPrimaryCov[0][0] = fFit->GetCov(0, 0);
+      fPrimaryCov[0][1] = fPrimaryCov[1][0] = fFit->GetCov(0, 1);
+      fPrimaryCov[1][1] = fFit->GetCov(1, 1);
+      return;
+    }
+
+    if(nTracks <= fPrimaryMinTracks) return;
+
+    fFit->RemoveTrack(worst);
+    fPrimaryTracks.erase(fPrimaryTracks.begin() + worst);
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void VertexFitter::FitSecondary()
+{
+  Int_t i, j, k, l, nTracks, index;
+  Double_t dx[2], distance2, variance, pt, phi;
+  Candidate *track, *vertex;
+  Candidate *pair[2];
+  TLorentzVector momentum;
+
+  fFit->EnableConstraint(kFALSE);
+
+  index = 0;
+  nTracks = fDisplacedTracks.size();
+  for(i = 0; i < nTracks; ++i)
+  {
+    pair[0] = fDisplacedTracks[i];
+    for(j = i + 1; j < nTracks; ++j)
+    {
+      pair[1] = fDisplacedTracks[j];
+      if(pair[0]->Charge * pair[1]->Charge >= 0) continue;
+
+      fFit->Clear();
+      fFit->AddTrack(pair[0]);
+      fFit->AddTrack(pair[1]);
+
+      if(!fFit->Fit() || fFit->GetChi2() > fSecondaryMaxChi2) continue;
+
+      // transverse distance from the primary vertex
+      dx[0] = fFit->GetX(0) - fPrimaryX;
+      dx[1] = fFit->GetX(1) - fPrimaryY;
+      distance2 = dx[0] * dx[0] + dx[1] * dx[1];
+      if(distance2 <= 0.0) continue;
+
+      variance = 0.0;
+      for(k = 0; k < 2; ++k)
+      {
+        for(l = 0; l < 2; ++l)
+        {
+          variance += dx[k] * (fFit->GetCov(k, l) + fPrimaryCov[k][l]) * dx[l];
+        }
+      }
+      variance /= distance2;
+
+      if(distance2 < fSecondaryMinDistanceSignificance * fSecondaryMinDistanceSignificance * variance) continue;
+
+      vertex = NewVertex(++index);
+
+      for(k = 0; k < 2; ++k)
+      {
+        track = pair[k];
+
+        // momentum at the vertex, rotated by the helix phase
+        pt = track->Momentum.Pt();
+        phi = track->Phi + fFit->GetTrackPhase(k);
+        momentum.SetXYZM(pt * TMath::Cos(phi), pt * TMath::Sin(phi), pt * track->CtgTheta, track->Momentum.M());
+
+        vertex->Momentum += momentum;
+        vertex->SumPT2 += pt * pt;
+        vertex->AddCandidate(track);
+      }
+
+      fSecondaryVertexOutputArray->Add(vertex);
+    }
+  }
+}
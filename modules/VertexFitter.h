@@ -0,0 +1,84 @@
+/*
+ *  Delphes: a framework for fast simulation of a generic collider experiment
+ *  Copyright (C) 2012-2014  Universite catholique de Louvain (UCL), Belgium
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VertexFitter_h
+#define VertexFitter_h
+
+/** \class VertexFitter
+ *
+ *  Fits the primary vertex and two-track secondary vertices
+ *  from tracks with full covariance matrix (see TrackCovariance).
+ *
+ */
+
+#include "classes/DelphesModule.h"
+
+#include <vector>
+
+class TObjArray;
+class Candidate;
+class DelphesVertexFit;
+
+class VertexFitter: public DelphesModule
+{
+public:
+  VertexFitter();
+  ~VertexFitter();
+
+  void Init();
+  void Process();
+  void Finish();
+
+private:
+  Candidate *NewVertex(Int_t index);
+
+  void FitPrimary();
+  void FitSecondary();
+
+  Double_t fMinPT;
+
+  Double_t fPrimaryMaxD0Significance;
+  Double_t fPrimaryMaxTrackChi2;
+  Int_t fPrimaryMinTracks;
+
+  Bool_t fBeamSpotConstraint;
+  Double_t fBeamSpotSigmaX, fBeamSpotSigmaY, fBeamSpotSigmaZ;
+
+  Double_t fSecondaryMinD0Significance;
+  Double_t fSecondaryMaxChi2;
+  Double_t fSecondaryMinDistanceSignificance;
+
+  DelphesVertexFit *fFit; //!
+
+  // primary vertex position in the transverse plane and its covariance
+  Double_t fPrimaryX, fPrimaryY, fPrimaryCov[2][2]; //!
+
+  std::vector<Candidate *> fPrimaryTracks; //!
+  std::vector<Candidate *> fDisplacedTracks; //!
+
+  TIterator *fItInputArray = nullptr; //!
+
+  const TObjArray *fInputArray = nullptr; //!
+
+  TObjArray *fVertexOutputArray = nullptr; //!
+  TObjArray *fSecondaryVertexOutputArray = nullptr; //!
+
+  ClassDef(VertexFitter, 1)
+};
+
+#endif
@@ -188,12 +188,10 @@ void VertexSorter::Process()
     {
       if(candidate->IsPU)
         continue;
-      for(itClusterIDToIndex = clusterIDToIndex.begin(); itClusterIDToIndex != clusterIDToIndex.end(); ++itClusterIDToIndex)
-      {
-        if(candidate->ClusterIndex != itClusterIDToIndex->first)
-          continue;
-        clusterIDToSumPT2.at(itClusterIDToIndex->first) += candidate->Momentum.Pt() * candidate->Momentum.Pt();
-      }
+      itClusterIDToIndex = clusterIDToIndex.find(candidate->ClusterIndex);
+      if(itClusterIDToIndex == clusterIDToIndex.end())
+        continue;
+      clusterIDToSumPT2.at(itClusterIDToIndex->first) += candidate->Momentum.Pt() * candidate->Momentum.Pt();
     }
 
     for(itClusterIDToSumPT2 = clusterIDToSumPT2.begin(); itClusterIDToSumPT2 != clusterIDToSumPT2.end(); ++itClusterIDToSumPT2)
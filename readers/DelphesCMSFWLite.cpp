@@ -126,6 +126,7 @@ void ConvertInput(fwlite::Event &event, Long64_t eventCounter,
   element = static_cast<HepMCEvent *>(branchEvent->NewEntry());
 
   element->Number = eventCounter;
+  element->Stream = 0;
 
   element->ProcessID = handleGenEventInfo->signalProcessID();
   element->MPI = 1;
@@ -413,7 +414,7 @@ int main(int argc, char *argv[])
 
           firstEvent = kFALSE;
 
-          treeWriter->Fill();
+          if(modularDelphes->IsEventAccepted()) treeWriter->Fill();
 
           modularDelphes->Clear();
           treeWriter->Clear();
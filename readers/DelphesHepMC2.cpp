@@ -19,6 +19,8 @@
 #include <iostream>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <signal.h>
 
@@ -33,6 +35,7 @@
 #include "TStopwatch.h"
 
 #include "classes/DelphesClasses.h"
+#include "classes/DelphesEventQueue.h"
 #include "classes/DelphesFactory.h"
 #include "classes/DelphesHepMC2Reader.h"
 #include "modules/Delphes.h"
@@ -68,8 +71,12 @@ int main(int argc, char *argv[])
   DelphesFactory *factory = 0;
   TObjArray *stableParticleOutputArray = 0, *allParticleOutputArray = 0, *partonOutputArray = 0;
   DelphesHepMC2Reader *reader = 0;
-  Int_t i, maxEvents, skipEvents;
-  Long64_t length, eventCounter;
+  DelphesEventQueue *queue = 0;
+  vector<DelphesHepMC2Reader *> streamReaders;
+  string record;
+  Int_t i, stream, maxEvents, skipEvents;
+  Bool_t interleaveInputs;
+  Long64_t length, bytesRead, eventCounter;
 
   if(argc < 3)
   {
@@ -80,6 +87,7 @@ int main(int argc, char *argv[])
     cout << " output_file - output file in ROOT format," << endl;
     cout << " input_file(s) - input file(s) in HepMC format," << endl;
     cout << " with no input_file, or when input_file is -, read standard input." << endl;
+    cout << " with InterleaveInputs set in config_file, all inputs are read concurrently." << endl;
     return 1;
   }
 
@@ -111,6 +119,7 @@ int main(int argc, char *argv[])
 
     maxEvents = confReader->GetInt("::MaxEvents", 0);
     skipEvents = confReader->GetInt("::SkipEvents", 0);
+    interleaveInputs = confReader->GetBool("::InterleaveInputs", false);
 
     if(maxEvents < 0)
     {
@@ -131,56 +140,75 @@ int main(int argc, char *argv[])
     stableParticleOutputArray = modularDelphes->ExportArray("stableParticles");
     partonOutputArray = modularDelphes->ExportArray("partons");
 
-    reader = new DelphesHepMC2Reader;
-
     modularDelphes->InitTask();
 
-    i = 3;
-    do
+    if(interleaveInputs)
     {
-      if(interrupted) break;
+      // open all inputs, each input is read on its own thread
+      queue = new DelphesEventQueue("E ");
 
-      if(i == argc || strncmp(argv[i], "-", 2) == 0)
-      {
-        cout << "** Reading standard input" << endl;
-        inputFile = stdin;
-        length = -1;
-      }
-      else
-      {
-        cout << "** Reading " << argv[i] << endl;
-        inputFile = fopen(argv[i], "r");
+      // total size of the inputs, unknown when reading standard input
+      length = 0;
 
-        if(inputFile == NULL)
+      i = 3;
+      do
+      {
+        if(i == argc || strncmp(argv[i], "-", 2) == 0)
         {
-          message << "can't open " << argv[i];
-          throw runtime_error(message.str());
+          cout << "** Reading standard input" << endl;
+          stream = queue->AddInput(stdin, "-");
+          length = -1;
         }
+        else
+        {
+          cout << "** Reading " << argv[i] << endl;
+          inputFile = fopen(argv[i], "r");
 
-        fseek(inputFile, 0L, SEEK_END);
-        length = ftello(inputFile);
-        fseek(inputFile, 0L, SEEK_SET);
+          if(inputFile == NULL)
+          {
+            message << "can't open " << argv[i];
+            throw runtime_error(message.str());
+          }
 
-        if(length <= 0)
-        {
-          fclose(inputFile);
-          ++i;
-          continue;
+          if(length >= 0)
+          {
+            fseek(inputFile, 0L, SEEK_END);
+            length += ftello(inputFile);
+            fseek(inputFile, 0L, SEEK_SET);
+          }
+
+          stream = queue->AddInput(inputFile, argv[i]);
         }
-      }
 
-      reader->SetInputFile(inputFile);
+        // one reader per input keeps the cross section and units of each input
+        streamReaders.push_back(new DelphesHepMC2Reader);
+        streamReaders.back()->SetStream(stream);
+
+        ++i;
+      } while(i < argc);
 
       ExRootProgressBar progressBar(length);
 
-      // Loop over all objects
+      // Loop over events in the order in which they become available,
+      // progress is measured by the size of the records read so far
       eventCounter = 0;
+      bytesRead = 0;
       treeWriter->Clear();
       modularDelphes->Clear();
-      reader->Clear();
+      queue->Start();
       readStopWatch.Start();
-      while((maxEvents <= 0 || eventCounter - skipEvents < maxEvents) && reader->ReadBlock(factory, allParticleOutputArray, stableParticleOutputArray, partonOutputArray) && !interrupted)
+      while((maxEvents <= 0 || eventCounter - skipEvents < maxEvents) && !interrupted && queue->Pop(stream, record))
       {
+        reader = streamReaders[stream];
+        reader->Clear();
+
+        bytesRead += record.size();
+
+        inputFile = fmemopen(&record[0], record.size(), "r");
+        reader->SetInputFile(inputFile);
+        while(!reader->EventReady() && reader->ReadBlock(factory, allParticleOutputArray, stableParticleOutputArray, partonOutputArray)) continue;
+        fclose(inputFile);
+
         if(reader->EventReady())
         {
           ++eventCounter;
@@ -196,27 +224,122 @@ int main(int argc, char *argv[])
             reader->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
             reader->AnalyzeWeight(branchWeight);
 
-            treeWriter->Fill();
-
-            treeWriter->Clear();
+            if(modularDelphes->IsEventAccepted()) treeWriter->Fill();
           }
+        }
+        else
+        {
+          cerr << "** WARNING: incomplete event in " << queue->GetInputName(stream) << endl;
+        }
 
-          modularDelphes->Clear();
-          reader->Clear();
+        treeWriter->Clear();
+        modularDelphes->Clear();
+        reader->Clear();
 
-          readStopWatch.Start();
-        }
-        progressBar.Update(ftello(inputFile), eventCounter);
+        readStopWatch.Start();
+
+        progressBar.Update(bytesRead, eventCounter);
       }
 
-      fseek(inputFile, 0L, SEEK_END);
-      progressBar.Update(ftello(inputFile), eventCounter, kTRUE);
+      progressBar.Update(length >= 0 ? length : bytesRead, eventCounter, kTRUE);
       progressBar.Finish();
 
-      if(inputFile != stdin) fclose(inputFile);
+      // stop reading threads and close inputs
+      delete queue;
+      queue = 0;
+
+      for(i = 0; i < Int_t(streamReaders.size()); ++i) delete streamReaders[i];
+      streamReaders.clear();
+      reader = 0;
+    }
+    else
+    {
+      reader = new DelphesHepMC2Reader;
 
-      ++i;
-    } while(i < argc);
+      i = 3;
+      do
+      {
+        if(interrupted) break;
+
+        if(i == argc || strncmp(argv[i], "-", 2) == 0)
+        {
+          cout << "** Reading standard input" << endl;
+          inputFile = stdin;
+          length = -1;
+        }
+        else
+        {
+          cout << "** Reading " << argv[i] << endl;
+          inputFile = fopen(argv[i], "r");
+
+          if(inputFile == NULL)
+          {
+            message << "can't open " << argv[i];
+            throw runtime_error(message.str());
+          }
+
+          fseek(inputFile, 0L, SEEK_END);
+          length = ftello(inputFile);
+          fseek(inputFile, 0L, SEEK_SET);
+
+          if(length <= 0)
+          {
+            fclose(inputFile);
+            ++i;
+            continue;
+          }
+        }
+
+        reader->SetInputFile(inputFile);
+        reader->SetStream(i - 3);
+
+        ExRootProgressBar progressBar(length);
+
+        // Loop over all objects
+        eventCounter = 0;
+        treeWriter->Clear();
+        modularDelphes->Clear();
+        reader->Clear();
+        readStopWatch.Start();
+        while((maxEvents <= 0 || eventCounter - skipEvents < maxEvents) && reader->ReadBlock(factory, allParticleOutputArray, stableParticleOutputArray, partonOutputArray) && !interrupted)
+        {
+          if(reader->EventReady())
+          {
+            ++eventCounter;
+
+            readStopWatch.Stop();
+
+            if(eventCounter > skipEvents)
+            {
+              procStopWatch.Start();
+              modularDelphes->ProcessTask();
+              procStopWatch.Stop();
+
+              reader->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
+              reader->AnalyzeWeight(branchWeight);
+
+              if(modularDelphes->IsEventAccepted()) treeWriter->Fill();
+
+              treeWriter->Clear();
+            }
+
+            modularDelphes->Clear();
+            reader->Clear();
+
+            readStopWatch.Start();
+          }
+          progressBar.Update(ftello(inputFile), eventCounter);
+        }
+
+        fseek(inputFile, 0L, SEEK_END);
+        progressBar.Update(ftello(inputFile), eventCounter, kTRUE);
+        progressBar.Finish();
+
+        if(inputFile != stdin) fclose(inputFile);
+
+        ++i;
+      } while(i < argc);
+    }
 
     modularDelphes->FinishTask();
     treeWriter->Write();
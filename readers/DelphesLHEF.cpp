@@ -197,7 +197,7 @@ int main(int argc, char *argv[])
             reader->AnalyzeEvent(branchEvent, eventCounter, &readStopWatch, &procStopWatch);
             reader->AnalyzeWeight(branchWeight);
 
-            treeWriter->Fill();
+            if(modularDelphes->IsEventAccepted()) treeWriter->Fill();
 
             treeWriter->Clear();
           }
@@ -92,6 +92,7 @@ void ConvertInput(proio::Event *event, double momentumUnit, double positionUnit,
   };
 
   element->Number = nID;
+  element->Stream = 0;
   element->ProcessID = process_id;
   element->Weight = weight;
 
@@ -402,7 +403,7 @@ int main(int argc, char *argv[])
         modularDelphes->ProcessTask();
         procStopWatch.Stop();
 
-        treeWriter->Fill();
+        if(modularDelphes->IsEventAccepted()) treeWriter->Fill();
 
         modularDelphes->Clear();
         treeWriter->Clear();
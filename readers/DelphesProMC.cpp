@@ -82,6 +82,7 @@ void ConvertInput(ProMCEvent &event, double momentumUnit, double positionUnit,
   element = static_cast<HepMCEvent *>(branch->NewEntry());
 
   element->Number = mutableEvent->number();
+  element->Stream = 0;
 
   element->ProcessID = mutableEvent->process_id();
   element->MPI = mutableEvent->mpi();
@@ -277,7 +278,7 @@ int main(int argc, char *argv[])
         modularDelphes->ProcessTask();
         procStopWatch.Stop();
 
-        treeWriter->Fill();
+        if(modularDelphes->IsEventAccepted()) treeWriter->Fill();
 
         modularDelphes->Clear();
         treeWriter->Clear();
@@ -204,7 +204,8 @@ for fileName in sys.argv[3:]:
 
             modularDelphes.ProcessTask()
 
-            treeWriter.Fill()
+            if modularDelphes.IsEventAccepted():
+                treeWriter.Fill()
 
             modularDelphes.Clear()
             treeWriter.Clear()
@@ -71,6 +71,7 @@ void ConvertInput(Long64_t eventCounter, Pythia8::Pythia *pythia,
   element = static_cast<HepMCEvent *>(branch->NewEntry());
 
   element->Number = eventCounter;
+  element->Stream = 0;
 
   element->ProcessID = pythia->info.code();
   element->MPI = 1;
@@ -428,7 +429,7 @@ int main(int argc, char *argv[])
       }
 #endif
 
-      treeWriter->Fill();
+      if(modularDelphes->IsEventAccepted()) treeWriter->Fill();
 
       treeWriter->Clear();
       modularDelphes->Clear();
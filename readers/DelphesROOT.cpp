@@ -176,6 +176,7 @@ int main(int argc, char *argv[])
         element = static_cast<HepMCEvent *>(branchEvent->NewEntry());
 
         element->Number = eventCounter;
+        element->Stream = eve->Stream;
 
         element->ProcessID = eve->ProcessID;
         element->MPI = eve->MPI;
@@ -232,7 +233,7 @@ int main(int argc, char *argv[])
 
         modularDelphes->ProcessTask();
 
-        treeWriter->Fill();
+        if(modularDelphes->IsEventAccepted()) treeWriter->Fill();
 
         modularDelphes->Clear();
         treeWriter->Clear();